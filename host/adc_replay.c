@@ -0,0 +1,168 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Reproduccion de muestras al ritmo del ADC con un hilo (ver adc_replay.h).
+ */
+
+#define _GNU_SOURCE
+#include "adc_replay.h"
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+/* Espera del consumidor entre consultas cuando hay frecuencia de muestreo */
+#define ADC_REPLAY_POLL_NS (20000U)
+
+static inline bool ADC_REPLAY_Load(volatile bool *flag)
+{
+	return __atomic_load_n(flag, __ATOMIC_ACQUIRE);
+}
+
+static inline void ADC_REPLAY_Store(volatile bool *flag, bool value)
+{
+	__atomic_store_n(flag, value, __ATOMIC_RELEASE);
+}
+
+/* Lee hasta ADC_REPLAY_CHUNK muestras de cada canal, intercaladas. Devuelve cuantas */
+static uint32_t ADC_REPLAY_Read(adc_replay_t *replay, q15_t *samples)
+{
+	uint32_t numChannels = replay->stream->numChannels;
+
+	if(replay->file == NULL)
+	{
+		PRNG_FillQ15(&replay->prng, samples, 11U, replay->signalPower, ADC_REPLAY_CHUNK);
+		return ADC_REPLAY_CHUNK;
+	}
+
+	uint8_t raw[ADC_REPLAY_CHUNK * ADC_STREAM_MAX_CHANNELS * 2U];
+	uint32_t count = (uint32_t)fread(raw, 2U * numChannels, ADC_REPLAY_CHUNK, replay->file);
+	for(uint32_t i = 0; i < count * numChannels; i++)
+	{
+		samples[i] = (q15_t)(raw[2U * i] | ((uint16_t)raw[2U * i + 1U] << 8));
+	}
+	return count;
+}
+
+static void *ADC_REPLAY_Thread(void *param)
+{
+	adc_replay_t *replay = (adc_replay_t *)param;
+	adc_stream_handle_t *stream = replay->stream;
+	q15_t chunk[ADC_REPLAY_CHUNK * ADC_STREAM_MAX_CHANNELS];
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while(!ADC_REPLAY_Load(&replay->stop))
+	{
+		uint32_t count = ADC_REPLAY_Read(replay, chunk);
+		if(count == 0U)
+		{
+			break;
+		}
+
+		for(uint32_t i = 0; i < count; i++)
+		{
+			const q15_t *samples = &chunk[i * stream->numChannels];
+			if(replay->rate != 0U)
+			{
+				ADC_STREAM_PutSample(stream, samples);
+				continue;
+			}
+			while(!ADC_STREAM_TryPutSample(stream, samples))
+			{
+				if(ADC_REPLAY_Load(&replay->stop))
+				{
+					ADC_REPLAY_Store(&replay->done, true);
+					return NULL;
+				}
+				sched_yield();
+			}
+		}
+		replay->samples += count;
+
+		/* Instante absoluto de la proxima muestra, contado desde el principio */
+		if(replay->rate != 0U)
+		{
+			uint64_t ns = replay->samples * 1000000000U / replay->rate + (uint64_t)start.tv_nsec;
+			struct timespec next = {start.tv_sec + (time_t)(ns / 1000000000U), (long)(ns % 1000000000U)};
+			while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+			{
+			}
+		}
+	}
+
+	ADC_REPLAY_Store(&replay->done, true);
+	return NULL;
+}
+
+int ADC_REPLAY_Open(adc_replay_t *replay, adc_stream_handle_t *stream, const char *source, uint32_t rate,
+					q15_t signalPower, uint32_t seed)
+{
+	memset(replay, 0, sizeof(*replay));
+	replay->stream = stream;
+	replay->rate = rate;
+	replay->signalPower = signalPower;
+	PRNG_Init(&replay->prng, seed);
+
+	if(strcmp(source, "gen") == 0)
+	{
+		if(stream->numChannels != 1U)
+		{
+			return -1;
+		}
+	}
+	else
+	{
+		replay->file = (strcmp(source, "-") == 0) ? stdin : fopen(source, "rb");
+		if(replay->file == NULL)
+		{
+			return -1;
+		}
+	}
+
+	if(pthread_create(&replay->thread, NULL, ADC_REPLAY_Thread, replay) != 0)
+	{
+		if((replay->file != NULL) && (replay->file != stdin))
+		{
+			fclose(replay->file);
+		}
+		return -1;
+	}
+	return 0;
+}
+
+const q15_t *ADC_REPLAY_WaitBlock(adc_replay_t *replay)
+{
+	for(;;)
+	{
+		const q15_t *block = ADC_STREAM_GetBlock(replay->stream, 0U);
+		if(block != NULL)
+		{
+			return block;
+		}
+		if(ADC_REPLAY_Load(&replay->done))
+		{
+			/* El ultimo bloque pudo completarse entre las dos consultas */
+			return ADC_STREAM_GetBlock(replay->stream, 0U);
+		}
+
+		if(replay->rate == 0U)
+		{
+			sched_yield();
+		}
+		else
+		{
+			struct timespec wait = {0, ADC_REPLAY_POLL_NS};
+			nanosleep(&wait, NULL);
+		}
+	}
+}
+
+void ADC_REPLAY_Close(adc_replay_t *replay)
+{
+	ADC_REPLAY_Store(&replay->stop, true);
+	pthread_join(replay->thread, NULL);
+	if((replay->file != NULL) && (replay->file != stdin))
+	{
+		fclose(replay->file);
+	}
+}
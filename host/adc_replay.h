@@ -0,0 +1,65 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Reemplazo en el host del ADC16 disparado por el PIT. Un hilo entrega muestras a
+	adc_stream.h con ADC_STREAM_PutSample(), como lo haria la interrupcion de fin de
+	conversion, al ritmo de la frecuencia de muestreo indicada (en grupos de
+	ADC_REPLAY_CHUNK muestras, con tiempos absolutos para que el error no se acumule).
+	Sirve para probar en Linux la adquisicion por bloques, los overruns y la latencia sin
+	la placa. Si el planificador atrasa el hilo, las muestras atrasadas se entregan de una
+	vez y pueden contarse overruns que con el PIT no ocurririan.
+
+	La fuente puede ser:
+	 - "gen": la señal del generador del motor (prng.h, 11 bits por signal_power), sin fin.
+	   Solo un canal.
+	 - "-" (stdin) o un archivo: muestras int16 little-endian, con los canales intercalados
+	   (entrada de la planta y, con dos canales, su salida medida). Termina con el archivo.
+	Con frecuencia 0 no se espera entre muestras y el hilo no completa un bloque mientras
+	el anterior este en proceso (ADC_STREAM_TryPutSample), por lo que no hay perdidas.
+ */
+
+#ifndef ADC_REPLAY_H_
+#define ADC_REPLAY_H_
+
+#include "adc_stream.h"
+#include "prng.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Muestras por canal que se entregan entre pausa y pausa (multiplo de PRNG_LANES) */
+#define ADC_REPLAY_CHUNK (16U)
+
+typedef struct _adc_replay
+{
+	adc_stream_handle_t *stream;
+	FILE *file;					/* NULL con el generador */
+	prng_instance_t prng;
+	q15_t signalPower;
+	uint32_t rate;				/* Muestras por segundo por canal, 0 = sin pausas ni perdidas */
+	pthread_t thread;
+	volatile bool stop;
+	volatile bool done;			/* Se entrego la ultima muestra */
+	uint64_t samples;			/* Muestras entregadas por canal */
+} adc_replay_t;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Inicia el hilo. stream ya debe estar inicializado. Devuelve 0, o -1 si no se pudo abrir
+ * la fuente o si se pide el generador con mas de un canal */
+int ADC_REPLAY_Open(adc_replay_t *replay, adc_stream_handle_t *stream, const char *source, uint32_t rate,
+					q15_t signalPower, uint32_t seed);
+
+/* Espera el proximo bloque, como el lazo principal del firmware, y devuelve el canal 0.
+ * Devuelve NULL si la fuente termino y no quedan bloques completos */
+const q15_t *ADC_REPLAY_WaitBlock(adc_replay_t *replay);
+
+/* Detiene el hilo y cierra la fuente */
+void ADC_REPLAY_Close(adc_replay_t *replay);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* ADC_REPLAY_H_ */
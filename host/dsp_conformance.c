@@ -0,0 +1,595 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Conformidad bit a bit de los kernels q15 con la numerica de la biblioteca del
+	Cortex-M4 (ver dsp_ref.h). Cada prueba arma una configuracion aleatoria (numTaps,
+	blockSize, mu, postShift, cantidad de tramas) con coeficientes y señales aleatorias,
+	en las que se fuerzan con frecuencia los extremos -32768 y 32767 para pasar por las
+	saturaciones y por alpha = -32768, y compara el kernel con su patron:
+	 - fir, lms: DSP_REF_FirQ15/DSP_REF_LmsQ15 contra un modelo escrito aca a partir de
+	   la definicion (convolucion sobre toda la secuencia, sin linea de retardo).
+	 - lms_simd: DSP_SIMD_LmsQ15 (AVX2, o el kernel de referencia sin -mavx2) contra
+	   DSP_REF_LmsQ15, con numTaps a ambos lados de los casos 16 < numTaps <= 32.
+	 - ident, ident_simd: planta y LMS fusionados (DSP_REF_IdentQ15 contra el modelo de
+	   la planta seguido del LMS y DSP_SIMD_IdentQ15 contra DSP_REF_IdentQ15), incluida
+	   la energia del error que devuelven.
+	 - power: DSP_SIMD_PowerQ15 (la arm_power_q15 del host) contra la suma de cuadrados
+	   en 64 bits, con tramas enteras de -32768 para el desborde de los pares.
+	 - lms_multi: LMS_MULTI_Process contra un DSP_REF_LmsQ15 por canal, con 1 a
+	   CONF_MAX_CHANNELS canales (grupos completos, incompletos y sin AVX2).
+	 - prng: PRNG_FillU32/PRNG_FillQ15 (AVX2 o escalar) contra un xoshiro128+ escalar
+	   por lane escrito aca, con cantidades que no son multiplo de PRNG_LANES.
+	Se compara todo lo que el kernel escribe: salidas, error, coeficientes y linea de
+	retardo al final de cada trama.
+
+	Uso:
+		dsp_conformance [-t pruebas] [-s semilla]
+	Imprime una linea por comparacion y termina con codigo 1 si alguna no coincide,
+	indicando la prueba y la configuracion del primer caso distinto.
+ */
+
+#include "arm_math.h"
+#include "dsp_ref.h"
+#include "dsp_simd.h"
+#include "prng.h"
+#include "lms_multi.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+#define CONF_MAX_TAPS (72U)
+#define CONF_MAX_BLOCKSIZE (128U)
+#define CONF_MAX_FRAMES (4U)
+#define CONF_MAX_SAMPLES (CONF_MAX_FRAMES * CONF_MAX_BLOCKSIZE)
+#define CONF_MAX_CHANNELS (40U)
+#define CONF_MULTI_SAMPLES (CONF_MAX_CHANNELS * CONF_MAX_SAMPLES)
+
+/* Configuracion de una prueba */
+typedef struct _conf_case
+{
+	uint16_t numTaps;
+	uint32_t blockSize;
+	uint32_t frames;
+	q15_t mu;
+	uint32_t postShift;
+	uint16_t channels;
+} conf_case_t;
+
+/* En prng se usan blockSize (valores por llamada), frames (llamadas), mu (escala) y
+ * postShift (bits) */
+
+/* Una comparacion: devuelve true si el kernel coincide con su patron */
+typedef bool (*conf_check_fn_t)(conf_case_t *c);
+
+/* Kernels con la interfaz de arm_lms_q15 */
+typedef void (*conf_lms_fn_t)(const arm_lms_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+							  q15_t *pErr, uint32_t blockSize);
+
+/* Kernels con la interfaz de DSP_REF_IdentQ15 */
+typedef q63_t (*conf_ident_fn_t)(const arm_lms_instance_q15 *S, const q15_t *pPlant, const q15_t *pSrc, q15_t *pRef,
+								 q15_t *pOut, q15_t *pErr, uint32_t blockSize);
+
+typedef struct _conf_check
+{
+	const char *name;
+	conf_check_fn_t check;
+} conf_check_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static uint64_t s_rand;
+
+/* Señales de toda la prueba y salidas del kernel y del patron */
+static q15_t s_src[CONF_MAX_SAMPLES];
+static q15_t s_ref[CONF_MAX_SAMPLES];
+static q15_t s_out[CONF_MAX_SAMPLES];
+static q15_t s_err[CONF_MAX_SAMPLES];
+static q15_t s_modelOut[CONF_MAX_SAMPLES];
+static q15_t s_modelErr[CONF_MAX_SAMPLES];
+static q15_t s_plantOut[CONF_MAX_SAMPLES];
+static q15_t s_modelPlantOut[CONF_MAX_SAMPLES];
+static q15_t s_plant[CONF_MAX_TAPS];
+static q15_t s_coeffs[CONF_MAX_TAPS];
+static q15_t s_modelCoeffs[CONF_MAX_TAPS];
+static q15_t s_state[CONF_MAX_TAPS + CONF_MAX_BLOCKSIZE - 1U];
+static q15_t s_modelLine[CONF_MAX_TAPS + CONF_MAX_BLOCKSIZE - 1U];
+static q15_t s_modelState[CONF_MAX_TAPS - 1U + CONF_MAX_SAMPLES];
+static uint32_t s_u32[CONF_MAX_SAMPLES];
+static uint32_t s_modelU32[CONF_MAX_SAMPLES];
+
+/* LMS multicanal: tramas intercaladas y un LMS de referencia por canal */
+static q15_t s_multiSrc[CONF_MULTI_SAMPLES];
+static q15_t s_multiRef[CONF_MULTI_SAMPLES];
+static q15_t s_multiOut[CONF_MULTI_SAMPLES];
+static q15_t s_multiErr[CONF_MULTI_SAMPLES];
+static q15_t s_multiCoeffs[LMS_MULTI_COEFFS_LEN(CONF_MAX_TAPS, CONF_MAX_CHANNELS)];
+static q15_t s_multiState[LMS_MULTI_STATE_LEN(CONF_MAX_TAPS, CONF_MAX_BLOCKSIZE, CONF_MAX_CHANNELS)];
+static q15_t s_multiScratch[LMS_MULTI_SCRATCH_LEN(CONF_MAX_BLOCKSIZE)];
+static q15_t s_channelCoeffs[CONF_MAX_CHANNELS][CONF_MAX_TAPS];
+static q15_t s_channelState[CONF_MAX_CHANNELS][CONF_MAX_TAPS + CONF_MAX_BLOCKSIZE - 1U];
+
+/*******************************************************************************
+ * Datos aleatorios
+ ******************************************************************************/
+
+/* xorshift64*, independiente de prng.h (que tambien se prueba) */
+static uint32_t conf_rand(void)
+{
+	s_rand ^= s_rand >> 12;
+	s_rand ^= s_rand << 25;
+	s_rand ^= s_rand >> 27;
+	return (uint32_t)((s_rand * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static uint32_t conf_range(uint32_t lo, uint32_t hi)
+{
+	return lo + conf_rand() % (hi - lo + 1U);
+}
+
+/* Valor q15 con los extremos frecuentes */
+static q15_t conf_q15(void)
+{
+	switch(conf_rand() % 8U)
+	{
+		case 0: return -32768;
+		case 1: return 32767;
+		default: return (q15_t)conf_rand();
+	}
+}
+
+static void conf_fill(q15_t *p, uint32_t n)
+{
+	/* A veces señales chicas, para que el LMS no sature todo el tiempo */
+	uint32_t shift = (conf_rand() % 2U) ? conf_range(0, 12) : 0U;
+
+	for(uint32_t i = 0; i < n; i++)
+	{
+		p[i] = (q15_t)(conf_q15() >> shift);
+	}
+}
+
+/* Señales y coeficientes de la configuracion c */
+static void conf_fill_case(const conf_case_t *c)
+{
+	conf_fill(s_src, c->frames * c->blockSize);
+	conf_fill(s_ref, c->frames * c->blockSize);
+	conf_fill(s_plant, c->numTaps);
+	conf_fill(s_coeffs, c->numTaps);
+	memcpy(s_modelCoeffs, s_coeffs, c->numTaps * sizeof(q15_t));
+}
+
+static void conf_random_case(conf_case_t *c, uint16_t minTaps, uint16_t maxTaps, bool evenTaps)
+{
+	c->numTaps = (uint16_t)conf_range(minTaps, maxTaps);
+	if(evenTaps)
+	{
+		c->numTaps &= (uint16_t)~1U;
+	}
+	c->blockSize = conf_range(1, CONF_MAX_BLOCKSIZE);
+	c->frames = conf_range(1, CONF_MAX_FRAMES);
+	c->mu = conf_q15();
+	c->postShift = (conf_rand() % 4U) ? 0U : conf_range(1, 15);
+	c->channels = 1U;
+	conf_fill_case(c);
+}
+
+/*******************************************************************************
+ * Modelo
+ ******************************************************************************/
+
+static q15_t conf_sat16(int64_t v)
+{
+	return (q15_t)((v > 32767) ? 32767 : ((v < -32768) ? -32768 : v));
+}
+
+/* Secuencia completa precedida por numTaps - 1 ceros: la muestra n de la secuencia esta
+ * en s_modelState[numTaps - 1 + n] y su producto con el coeficiente k se toma de
+ * s_modelState[n + k], como en CMSIS */
+static const q15_t *conf_model_history(const conf_case_t *c)
+{
+	memset(s_modelState, 0, (c->numTaps - 1U) * sizeof(q15_t));
+	memcpy(&s_modelState[c->numTaps - 1U], s_src, c->frames * c->blockSize * sizeof(q15_t));
+	return s_modelState;
+}
+
+static void conf_model_fir(const conf_case_t *c, const q15_t *pCoeffs, q15_t *pDst)
+{
+	const q15_t *x = conf_model_history(c);
+
+	for(uint32_t n = 0; n < c->frames * c->blockSize; n++)
+	{
+		int64_t acc = 0;
+		for(uint32_t k = 0; k < c->numTaps; k++)
+		{
+			acc += (int64_t)x[n + k] * pCoeffs[k];
+		}
+		pDst[n] = conf_sat16((int32_t)(acc >> 15));
+	}
+}
+
+static void conf_model_lms(const conf_case_t *c, const q15_t *pRef)
+{
+	const q15_t *x = conf_model_history(c);
+
+	for(uint32_t n = 0; n < c->frames * c->blockSize; n++)
+	{
+		int64_t acc = 0;
+		for(uint32_t k = 0; k < c->numTaps; k++)
+		{
+			acc += (int64_t)x[n + k] * s_modelCoeffs[k];
+		}
+		q15_t y = conf_sat16((int32_t)(acc >> (15U - c->postShift)));
+		int32_t e = (int32_t)pRef[n] - y;
+		int16_t alpha = (int16_t)(((int64_t)e * c->mu) >> 15);
+
+		s_modelOut[n] = y;
+		s_modelErr[n] = (int16_t)e;
+		for(uint32_t k = 0; k < c->numTaps; k++)
+		{
+			s_modelCoeffs[k] = conf_sat16((int64_t)s_modelCoeffs[k] + (((int32_t)alpha * x[n + k]) >> 15));
+		}
+	}
+}
+
+/* Un grupo de PRNG_LANES valores de xoshiro128+, lane por lane */
+static void conf_model_prng(prng_instance_t *S, uint32_t *pDst)
+{
+	for(uint32_t lane = 0; lane < PRNG_LANES; lane++)
+	{
+		uint32_t *s0 = &S->s[0][lane], *s1 = &S->s[1][lane], *s2 = &S->s[2][lane], *s3 = &S->s[3][lane];
+		uint32_t t = *s1 << 9;
+
+		pDst[lane] = *s0 + *s3;
+		*s2 ^= *s0;
+		*s3 ^= *s1;
+		*s1 ^= *s2;
+		*s0 ^= *s3;
+		*s2 ^= t;
+		*s3 = (*s3 << 11) | (*s3 >> 21);
+	}
+}
+
+/* count valores; el resto del ultimo grupo se descarta */
+static void conf_model_prng_fill(prng_instance_t *S, uint32_t *pDst, uint32_t count)
+{
+	uint32_t group[PRNG_LANES];
+
+	for(uint32_t j = 0; j < count; j += PRNG_LANES)
+	{
+		conf_model_prng(S, group);
+		for(uint32_t k = 0; (k < PRNG_LANES) && (j + k < count); k++)
+		{
+			pDst[j + k] = group[k];
+		}
+	}
+}
+
+/*******************************************************************************
+ * Comparaciones
+ ******************************************************************************/
+
+static bool conf_equal(const q15_t *a, const q15_t *b, uint32_t n)
+{
+	return memcmp(a, b, n * sizeof(q15_t)) == 0;
+}
+
+/* La linea de retardo guarda las ultimas numTaps - 1 muestras de la secuencia */
+static bool conf_state_equal(const conf_case_t *c, const q15_t *pState)
+{
+	return conf_equal(pState, &s_modelState[c->frames * c->blockSize], c->numTaps - 1U);
+}
+
+static bool conf_check_fir(conf_case_t *c)
+{
+	conf_random_case(c, 4, CONF_MAX_TAPS, true);
+
+	arm_fir_instance_q15 fir;
+	if(arm_fir_init_q15(&fir, c->numTaps, s_plant, s_state, c->blockSize) != ARM_MATH_SUCCESS)
+	{
+		return false;
+	}
+	for(uint32_t f = 0; f < c->frames; f++)
+	{
+		DSP_REF_FirQ15(&fir, &s_src[f * c->blockSize], &s_out[f * c->blockSize], c->blockSize);
+	}
+
+	conf_model_fir(c, s_plant, s_modelOut);
+	return conf_equal(s_out, s_modelOut, c->frames * c->blockSize) && conf_state_equal(c, s_state);
+}
+
+static void conf_run_lms(const conf_case_t *c, conf_lms_fn_t lmsFn, q15_t *pCoeffs, q15_t *pState, q15_t *pOut,
+						 q15_t *pErr)
+{
+	arm_lms_instance_q15 lms;
+	arm_lms_init_q15(&lms, c->numTaps, pCoeffs, pState, c->mu, c->blockSize, c->postShift);
+	for(uint32_t f = 0; f < c->frames; f++)
+	{
+		uint32_t p = f * c->blockSize;
+		lmsFn(&lms, &s_src[p], &s_ref[p], &pOut[p], &pErr[p], c->blockSize);
+	}
+}
+
+/* Salidas, error, coeficientes y linea de retardo del kernel y del patron */
+static bool conf_lms_equal(const conf_case_t *c)
+{
+	uint32_t len = c->frames * c->blockSize;
+	return conf_equal(s_out, s_modelOut, len) && conf_equal(s_err, s_modelErr, len) &&
+		   conf_equal(s_coeffs, s_modelCoeffs, c->numTaps);
+}
+
+static bool conf_check_lms(conf_case_t *c)
+{
+	conf_random_case(c, 1, CONF_MAX_TAPS, false);
+
+	conf_run_lms(c, DSP_REF_LmsQ15, s_coeffs, s_state, s_out, s_err);
+	conf_model_lms(c, s_ref);
+	return conf_lms_equal(c) && conf_state_equal(c, s_state);
+}
+
+static bool conf_check_lms_simd(conf_case_t *c)
+{
+	conf_random_case(c, 1, CONF_MAX_TAPS, false);
+
+	conf_run_lms(c, DSP_SIMD_LmsQ15, s_coeffs, s_state, s_out, s_err);
+	conf_run_lms(c, DSP_REF_LmsQ15, s_modelCoeffs, s_modelLine, s_modelOut, s_modelErr);
+	return conf_lms_equal(c) && conf_equal(s_state, s_modelLine, c->numTaps - 1U);
+}
+
+/* Devuelve la suma de las energias de todas las tramas */
+static q63_t conf_run_ident(const conf_case_t *c, conf_ident_fn_t identFn, q15_t *pCoeffs, q15_t *pState,
+							q15_t *pRef, q15_t *pOut, q15_t *pErr)
+{
+	arm_lms_instance_q15 lms;
+	q63_t energy = 0;
+
+	arm_lms_init_q15(&lms, c->numTaps, pCoeffs, pState, c->mu, c->blockSize, c->postShift);
+	for(uint32_t f = 0; f < c->frames; f++)
+	{
+		uint32_t p = f * c->blockSize;
+		energy += identFn(&lms, s_plant, &s_src[p], &pRef[p], &pOut[p], &pErr[p], c->blockSize);
+	}
+	return energy;
+}
+
+static q63_t conf_model_energy(const q15_t *pErr, uint32_t len)
+{
+	int64_t energy = 0;
+
+	for(uint32_t n = 0; n < len; n++)
+	{
+		energy += (int64_t)pErr[n] * pErr[n];
+	}
+	return energy;
+}
+
+static bool conf_ident_equal(const conf_case_t *c)
+{
+	return conf_lms_equal(c) && conf_equal(s_plantOut, s_modelPlantOut, c->frames * c->blockSize);
+}
+
+/* Kernel fusionado contra DSP_REF_IdentQ15 */
+static bool conf_compare_ident(conf_case_t *c, conf_ident_fn_t identFn)
+{
+	q63_t energy = conf_run_ident(c, identFn, s_coeffs, s_state, s_plantOut, s_out, s_err);
+	q63_t modelEnergy =
+		conf_run_ident(c, DSP_REF_IdentQ15, s_modelCoeffs, s_modelLine, s_modelPlantOut, s_modelOut, s_modelErr);
+	return conf_ident_equal(c) && conf_equal(s_state, s_modelLine, c->numTaps - 1U) && (energy == modelEnergy);
+}
+
+static bool conf_check_ident(conf_case_t *c)
+{
+	conf_random_case(c, 1, CONF_MAX_TAPS, false);
+
+	q63_t energy = conf_run_ident(c, DSP_REF_IdentQ15, s_coeffs, s_state, s_plantOut, s_out, s_err);
+	conf_model_fir(c, s_plant, s_modelPlantOut);
+	conf_model_lms(c, s_modelPlantOut);
+	return conf_ident_equal(c) && conf_state_equal(c, s_state) &&
+		   (energy == conf_model_energy(s_modelErr, c->frames * c->blockSize));
+}
+
+static bool conf_check_ident_simd(conf_case_t *c)
+{
+	conf_random_case(c, 1, CONF_MAX_TAPS, false);
+	return conf_compare_ident(c, DSP_SIMD_IdentQ15);
+}
+
+static bool conf_check_lms_multi(conf_case_t *c)
+{
+	conf_random_case(c, 1, CONF_MAX_TAPS, false);
+	c->channels = (uint16_t)conf_range(1, CONF_MAX_CHANNELS);
+
+	uint32_t frameLen = c->blockSize * c->channels;
+	conf_fill(s_multiSrc, c->frames * frameLen);
+	conf_fill(s_multiRef, c->frames * frameLen);
+
+	lms_multi_instance_q15 multi;
+	arm_lms_instance_q15 lms[CONF_MAX_CHANNELS];
+	LMS_MULTI_Init(&multi, c->numTaps, c->channels, s_multiCoeffs, s_multiState, s_multiScratch, c->mu, c->blockSize,
+				   c->postShift);
+	for(uint16_t ch = 0; ch < c->channels; ch++)
+	{
+		conf_fill(s_channelCoeffs[ch], c->numTaps);
+		LMS_MULTI_SetCoeffs(&multi, ch, s_channelCoeffs[ch]);
+		arm_lms_init_q15(&lms[ch], c->numTaps, s_channelCoeffs[ch], s_channelState[ch], c->mu, c->blockSize,
+						 c->postShift);
+	}
+
+	bool match = true;
+	for(uint32_t f = 0; f < c->frames; f++)
+	{
+		uint32_t p = f * frameLen;
+		LMS_MULTI_Process(&multi, &s_multiSrc[p], &s_multiRef[p], &s_multiOut[p], &s_multiErr[p], c->blockSize);
+
+		for(uint16_t ch = 0; ch < c->channels; ch++)
+		{
+			for(uint32_t n = 0; n < c->blockSize; n++)
+			{
+				s_src[n] = s_multiSrc[p + n * c->channels + ch];
+				s_ref[n] = s_multiRef[p + n * c->channels + ch];
+			}
+			DSP_REF_LmsQ15(&lms[ch], s_src, s_ref, s_modelOut, s_modelErr, c->blockSize);
+			for(uint32_t n = 0; n < c->blockSize; n++)
+			{
+				match = match && (s_multiOut[p + n * c->channels + ch] == s_modelOut[n]) &&
+						(s_multiErr[p + n * c->channels + ch] == s_modelErr[n]);
+			}
+		}
+	}
+
+	for(uint16_t ch = 0; ch < c->channels; ch++)
+	{
+		LMS_MULTI_GetCoeffs(&multi, ch, s_coeffs);
+		match = match && conf_equal(s_coeffs, s_channelCoeffs[ch], c->numTaps);
+	}
+	return match;
+}
+
+/* En power, blockSize es el largo de la señal */
+static bool conf_check_power(conf_case_t *c)
+{
+	c->numTaps = 0U;
+	c->blockSize = conf_range(0, CONF_MAX_SAMPLES);
+	c->frames = 1U;
+	c->mu = 0;
+	c->postShift = 0U;
+	c->channels = 1U;
+
+	if((conf_rand() % 8U) == 0U)
+	{
+		for(uint32_t n = 0; n < c->blockSize; n++)
+		{
+			s_src[n] = -32768;
+		}
+	}
+	else
+	{
+		conf_fill(s_src, c->blockSize);
+	}
+
+	q63_t model = conf_model_energy(s_src, c->blockSize);
+	q63_t power;
+	arm_power_q15(s_src, c->blockSize, &power);
+	return (DSP_SIMD_PowerQ15(s_src, c->blockSize) == model) && (DSP_REF_PowerQ15(s_src, c->blockSize) == model) &&
+		   (power == model);
+}
+
+static bool conf_check_prng(conf_case_t *c)
+{
+	prng_instance_t prng, model;
+	uint64_t seed = ((uint64_t)conf_rand() << 32) | conf_rand();
+
+	c->numTaps = 0U;
+	c->blockSize = conf_range(1, CONF_MAX_BLOCKSIZE);
+	c->frames = conf_range(1, CONF_MAX_FRAMES);
+	c->mu = conf_q15();
+	c->postShift = conf_range(1, 15);
+	c->channels = 1U;
+
+	PRNG_Init(&prng, seed);
+	model = prng;
+
+	/* Llamadas alternadas de FillU32 y FillQ15 que continuan la misma secuencia */
+	bool match = true;
+	for(uint32_t f = 0; f < c->frames; f++)
+	{
+		uint32_t count = c->blockSize;
+		if((f % 2U) == 0U)
+		{
+			PRNG_FillU32(&prng, s_u32, count);
+			conf_model_prng_fill(&model, s_modelU32, count);
+			match = match && (memcmp(s_u32, s_modelU32, count * sizeof(uint32_t)) == 0);
+		}
+		else
+		{
+			PRNG_FillQ15(&prng, s_out, c->postShift, c->mu, count);
+			conf_model_prng_fill(&model, s_modelU32, count);
+			for(uint32_t j = 0; j < count; j++)
+			{
+				s_modelOut[j] = (q15_t)((int32_t)(s_modelU32[j] >> (32U - c->postShift)) * c->mu);
+			}
+			match = match && conf_equal(s_out, s_modelOut, count);
+		}
+	}
+	return match && (memcmp(&prng, &model, sizeof(model)) == 0);
+}
+
+static const conf_check_t s_checks[] = {
+	{"fir", conf_check_fir},
+	{"lms", conf_check_lms},
+	{"lms_simd", conf_check_lms_simd},
+	{"prng", conf_check_prng},
+	{"ident", conf_check_ident},
+	{"ident_simd", conf_check_ident_simd},
+	{"power", conf_check_power},
+	{"lms_multi", conf_check_lms_multi},
+};
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	uint32_t trials = 2000U;
+	uint64_t seed = 1U;
+
+	for(int i = 1; i + 1 < argc; i += 2)
+	{
+		if(argv[i][0] != '-')
+		{
+			fprintf(stderr, "Opcion desconocida: %s\n", argv[i]);
+			return 1;
+		}
+		switch(argv[i][1])
+		{
+			case 't': trials = (uint32_t)strtoul(argv[i + 1], NULL, 0); break;
+			case 's': seed = strtoull(argv[i + 1], NULL, 0); break;
+			default:
+				fprintf(stderr, "Opcion desconocida: %s\n", argv[i]);
+				return 1;
+		}
+	}
+
+	int status = 0;
+	printf("# %u pruebas por comparacion, semilla %llu, SIMD %s, PRNG %s\n", trials, (unsigned long long)seed, DSP_SIMD_ISA,
+		   PRNG_ISA);
+	for(uint32_t i = 0; i < sizeof(s_checks) / sizeof(s_checks[0]); i++)
+	{
+		uint32_t failures = 0;
+		conf_case_t first = {0};
+		uint32_t firstTrial = 0;
+
+		/* Cada comparacion arranca de la misma semilla para poder repetirla sola */
+		s_rand = seed * 0x9E3779B97F4A7C15ULL + i + 1U;
+		for(uint32_t t = 0; t < trials; t++)
+		{
+			conf_case_t c;
+			if(!s_checks[i].check(&c))
+			{
+				if(failures == 0U)
+				{
+					first = c;
+					firstTrial = t;
+				}
+				failures++;
+			}
+		}
+
+		printf("%-12s %8u %8u %s\n", s_checks[i].name, trials, failures, (failures == 0U) ? "ok" : "ERROR");
+		if(failures != 0U)
+		{
+			printf("# primera diferencia: prueba %u, numTaps %u, blockSize %u, tramas %u, mu %d, postShift %u, "
+				   "canales %u\n",
+				   firstTrial, first.numTaps, first.blockSize, first.frames, first.mu, first.postShift, first.channels);
+			status = 1;
+		}
+	}
+
+	return status;
+}
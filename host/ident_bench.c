@@ -0,0 +1,246 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Comparacion de algoritmos de identificacion sobre la planta de 30 coeficientes del
+	firmware. Para cada algoritmo se corre la misma secuencia aleatoria (misma semilla)
+	y se informa:
+	 - costo por muestra (ns y ciclos de TSC en x86-64) del lazo completo de la trama,
+	 - trama de convergencia: primera trama en la que el promedio movil de MSE sobre
+	   CONV_WINDOW tramas queda por debajo del umbral (-t),
+	 - MSE promedio de las ultimas CONV_WINDOW tramas.
+
+	Uso:
+		ident_bench [-m mu] [-p signal_power] [-f numframes] [-t umbral] [-s semilla] [algoritmo ...]
+
+	El APA se indica como apa<K> (por ejemplo apa4) para elegir el orden de la proyeccion.
+	El LMS tiene variantes segun los kernels, bit a bit iguales (la trama de
+	convergencia y el MSE coinciden y solo cambia el costo):
+	 - lms: arm_fir_q15 y arm_lms_q15, cada uno con su linea de retardo,
+	 - lmsfused: planta y LMS en una pasada sobre una linea de retardo (DSP_SIMD_IdentQ15).
+	Las reglas de actualizacion de lms_rule.h se indican por su nombre: leaky, signerr,
+	signdata y signsign. Como el mismo mu da pasos distintos en cada regla, cualquier
+	algoritmo acepta un mu propio con :mu (por ejemplo signsign:2 o lms:10000).
+	Sin algoritmos se comparan lms, lmsfused, blms, apa2, apa4, apa8, rls y rlsq31.
+ */
+
+#include "ident.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#define CONV_WINDOW (20U)
+#define MAX_RUNS (16U)
+
+/* Algoritmo a comparar y orden del APA */
+typedef struct _bench_entry
+{
+	ident_algorithm_t algorithm;
+	uint16_t apaOrder;
+	bool fusedKernel;
+	lms_rule_t rule;
+	q15_t mu;				/* 0 = el de -m */
+} bench_entry_t;
+
+static ident_handle_t s_ident;
+static ident_io_t s_identIo;
+static float32_t s_fdafBuffer[FDAF_BUFFER_LEN(IDENT_MAX_TAPS)];
+static uint64_t s_rlsBuffer[RLS_BUFFER_SIZE(IDENT_MAX_TAPS) / sizeof(uint64_t)];
+static uint32_t s_apaBuffer[(APA_BUFFER_SIZE(IDENT_MAX_TAPS, IDENT_MAX_BLOCKSIZE) + 3U) / sizeof(uint32_t)];
+
+/* En el orden de ident_algorithm_t */
+static const char *const s_algorithmNames[] = {"lms", "blms", "fdaf", "rls", "rlsq31", "apa", "auto"};
+
+static uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__)
+	return __rdtsc();
+#else
+	return 0U;
+#endif
+}
+
+static int bench_run(const bench_entry_t *entry, q15_t mu, q15_t signal_power, uint32_t numframes,
+					 double threshold, unsigned int seed)
+{
+	ident_config_t config;
+	IDENT_GetDefaultConfig(&config);
+	config.algorithm = entry->algorithm;
+	config.apaOrder = entry->apaOrder;
+	config.fusedKernel = entry->fusedKernel;
+	config.lmsRule = entry->rule;
+	config.io = &s_identIo;
+	config.fdafBuffer = s_fdafBuffer;
+	config.rlsBuffer = s_rlsBuffer;
+	config.apaBuffer = s_apaBuffer;
+
+	char name[16];
+	if(entry->algorithm == kIDENT_AlgApa)
+	{
+		snprintf(name, sizeof(name), "apa%u", entry->apaOrder);
+	}
+	else if(entry->rule != kLMS_RULE_Standard)
+	{
+		snprintf(name, sizeof(name), "%s", LMS_RULE_GetName(entry->rule));
+	}
+	else
+	{
+		snprintf(name, sizeof(name), "%s%s", s_algorithmNames[entry->algorithm], entry->fusedKernel ? "fused" : "");
+	}
+	if(entry->mu != 0)
+	{
+		mu = entry->mu;
+		snprintf(&name[strlen(name)], sizeof(name) - strlen(name), ":%d", mu);
+	}
+
+	if(IDENT_Init(&s_ident, &config) != ARM_MATH_SUCCESS)
+	{
+		printf("%-11s configuracion invalida\n", name);
+		return -1;
+	}
+
+	IDENT_Seed(&s_ident, seed);
+	IDENT_Restart(&s_ident, mu);
+
+	double window[CONV_WINDOW] = {0};
+	double windowSum = 0.0;
+	int64_t convFrame = -1;
+
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	uint64_t c0 = bench_cycles();
+
+	for(uint32_t i = 0; i < numframes; i++)
+	{
+		double mse = (double)IDENT_ProcessFrame(&s_ident, signal_power);
+
+		windowSum += mse - window[i % CONV_WINDOW];
+		window[i % CONV_WINDOW] = mse;
+		if((convFrame < 0) && (i + 1U >= CONV_WINDOW) && (windowSum / CONV_WINDOW <= threshold))
+		{
+			convFrame = (int64_t)i + 1 - CONV_WINDOW;
+		}
+	}
+
+	uint64_t c1 = bench_cycles();
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	double samples = (double)numframes * s_ident.blockSize;
+	double seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+	printf("%-11s %10.1f %12.1f %10lld %14.1f\n", name, seconds * 1e9 / samples,
+		   (double)(c1 - c0) / samples, (long long)convFrame, windowSum / CONV_WINDOW);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	q15_t mu = 10000;
+	q15_t signal_power = 1;
+	uint32_t numframes = 2000U;
+	double threshold = 2000.0;
+	unsigned int seed = 1U;
+	bench_entry_t list[MAX_RUNS];
+	uint32_t count = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if((argv[i][0] == '-') && (i + 1 < argc))
+		{
+			switch(argv[i][1])
+			{
+				case 'm': mu = (q15_t)strtol(argv[i + 1], NULL, 0); break;
+				case 'p': signal_power = (q15_t)strtol(argv[i + 1], NULL, 0); break;
+				case 'f': numframes = (uint32_t)strtoul(argv[i + 1], NULL, 0); break;
+				case 't': threshold = strtod(argv[i + 1], NULL); break;
+				case 's': seed = (unsigned int)strtoul(argv[i + 1], NULL, 0); break;
+				default:
+					fprintf(stderr, "Opcion desconocida: %s\n", argv[i]);
+					return 1;
+			}
+			i++;
+			continue;
+		}
+
+		bench_entry_t entry = {kIDENT_AlgApa, 0U, false, kLMS_RULE_Standard, 0};
+		char *muSuffix = strchr(argv[i], ':');
+		if(muSuffix != NULL)
+		{
+			*muSuffix = '\0';
+			entry.mu = (q15_t)strtol(&muSuffix[1], NULL, 0);
+		}
+
+		uint32_t rule;
+		for(rule = kLMS_RULE_Leaky; rule < kLMS_RULE_NumRules; rule++)
+		{
+			if(strcmp(argv[i], LMS_RULE_GetName((lms_rule_t)rule)) == 0)
+			{
+				break;
+			}
+		}
+
+		if(rule < kLMS_RULE_NumRules)
+		{
+			entry.algorithm = kIDENT_AlgLms;
+			entry.rule = (lms_rule_t)rule;
+		}
+		else if(strncmp(argv[i], "apa", 3) == 0)
+		{
+			entry.apaOrder = (uint16_t)strtoul(&argv[i][3], NULL, 10);
+		}
+		else if(strcmp(argv[i], "lmsfused") == 0)
+		{
+			entry.algorithm = kIDENT_AlgLms;
+			entry.fusedKernel = true;
+		}
+		else
+		{
+			uint32_t k;
+			for(k = 0; k < sizeof(s_algorithmNames) / sizeof(s_algorithmNames[0]); k++)
+			{
+				if(strcmp(argv[i], s_algorithmNames[k]) == 0)
+				{
+					break;
+				}
+			}
+			if(k == sizeof(s_algorithmNames) / sizeof(s_algorithmNames[0]))
+			{
+				fprintf(stderr, "Algoritmo desconocido: %s\n", argv[i]);
+				return 1;
+			}
+			entry.algorithm = (ident_algorithm_t)k;
+		}
+		if(count < MAX_RUNS)
+		{
+			list[count++] = entry;
+		}
+	}
+
+	if(count == 0U)
+	{
+		static const bench_entry_t s_defaultList[] = {
+			{kIDENT_AlgLms, 0U, false, kLMS_RULE_Standard, 0},
+			{kIDENT_AlgLms, 0U, true, kLMS_RULE_Standard, 0},
+			{kIDENT_AlgBlockLms, 0U, false, kLMS_RULE_Standard, 0},
+			{kIDENT_AlgApa, 2U, false, kLMS_RULE_Standard, 0},
+			{kIDENT_AlgApa, 4U, false, kLMS_RULE_Standard, 0},
+			{kIDENT_AlgApa, 8U, false, kLMS_RULE_Standard, 0},
+			{kIDENT_AlgRls, 0U, false, kLMS_RULE_Standard, 0},
+			{kIDENT_AlgRlsQ31, 0U, false, kLMS_RULE_Standard, 0}};
+		for(; count < sizeof(s_defaultList) / sizeof(s_defaultList[0]); count++)
+		{
+			list[count] = s_defaultList[count];
+		}
+	}
+
+	printf("# mu %d, signal_power %d, %u tramas, umbral %.1f\n", mu, signal_power, numframes, threshold);
+	printf("# %-9s %10s %12s %10s %14s\n", "alg", "ns/muestra", "ciclos/mues", "conv.trama", "MSE final");
+	for(uint32_t i = 0; i < count; i++)
+	{
+		bench_run(&list[i], mu, signal_power, numframes, threshold, seed);
+	}
+
+	return 0;
+}
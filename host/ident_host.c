@@ -0,0 +1,507 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Programa para host Linux que corre el mismo lazo de identificacion de planta
+	que el firmware (source/ident.c), sin placa. Sirve para perfilar y optimizar el
+	lazo con perf en lugar de grabar la placa en cada experimento.
+
+	Uso:
+		ident_host [-a algoritmo] [-u regla] [-l fuga] [-L subbloque] [-n numtaps] [-b blocksize] [-m mu]
+				   [-p signal_power] [-f numframes] [-s semilla] [-k orden] [-T archivo]
+				   [-C tramas] [-E codificacion] [-U baudios] [-R archivo] [-W archivo] [-A fuente] [-r frecuencia]
+				   [-S] [-P] [-c] [-y] [-v] [-q]
+
+	Algoritmos: lms (arm_lms_q15), blms (LMS por bloques, una actualizacion cada -L
+	muestras; 0 = una por trama), fdaf (LMS por bloques en frecuencia), rls y rlsq31
+	(RLS en punto flotante y fijo), apa (proyeccion afin de orden -k) y auto (por defecto: FDAF a partir de
+	IDENT_FDAF_MIN_TAPS taps si no es 0, si no LMS; en el host es siempre el LMS).
+	Con -u el LMS usa otra regla de actualizacion (lms_rule.h): lms (por defecto), leaky
+	(con fuga -l en q15 por trama, de 0 a 32767), signerr, signdata o signsign.
+	Con -v mu se adapta en cada trama (vss.h) partiendo del mu de -m, y al final se informa
+	el ultimo mu.
+	Con -S la planta y el LMS se calculan por separado, cada uno con su linea de retardo,
+	en lugar del kernel fusionado.
+	Con -n distinto de 30 se usa una planta sintetica (coseno amortiguado). Para
+	plantas largas compilar con -DIDENT_MAX_TAPS=... -DIDENT_MAX_BLOCKSIZE=...
+
+	Por stdout se imprime, por cada trama, "<trama> <mse>" y al final la diferencia
+	entre los coeficientes de la planta y los del filtro adaptativo. Con -q solo se
+	imprime el resumen final.
+	Con -T se escribe ademas en el archivo la telemetria por trama del firmware
+	(telemetry.h), con una copia de los coeficientes cada -C tramas (0 = nunca) y el MSE
+	codificado segun -E: log (por defecto, logaritmo cuantizado) o delta (sin perdidas).
+	Se lee con telemetry_dump.
+	Con -U la telemetria se envia sin bloquear (uart_pipe.h) a la velocidad indicada, como
+	en la placa, y -T puede ser ademas "pty" para leerla desde un pseudo terminal. Al final
+	se informa cuanto tiempo se espero a la UART.
+	Los ciclos de cada etapa (prof.h, con rdtsc) se envian en la telemetria y con -P se
+	imprimen al final: mediciones, minimo, media y maximo en ticks y ns, e histograma.
+	Con -W se guarda al final un checkpoint (ident_ckpt.h) con los coeficientes, la linea de
+	retardo y el generador, y con -R se arranca en caliente desde uno: la corrida sigue
+	con el mu de -m desde los coeficientes y la secuencia de entrada guardados (-s no se
+	usa). Solo LMS y LMS por bloques.
+	Al final se informa la trama en la que conv_detect.h detecto la convergencia (con -R sin
+	exigir que el MSE baje) y con -c la corrida termina en esa trama.
+	Con -A la entrada de la planta no se genera en cada trama sino que se adquiere por
+	bloques como en la placa con el ADC (adc_stream.h): un hilo (adc_replay.h) entrega las
+	muestras de la fuente ("gen" para el generador, "-" para stdin o un archivo de int16
+	little-endian) a -r muestras por segundo (por defecto 10000; 0 = sin pausas ni
+	perdidas). Con -y el archivo tiene dos canales intercalados, entrada y salida medida
+	de la planta, y se identifica esa planta en lugar de la de plantCoeffs. Al final se
+	informan los bloques, los overruns y la latencia maxima de la adquisicion.
+ */
+
+#include "ident.h"
+#include "ident_ckpt.h"
+#include "conv_detect.h"
+#include "telemetry.h"
+#include "uart_pipe.h"
+#include "adc_replay.h"
+#include "prof.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+static ident_handle_t s_ident;
+static ident_io_t s_identIo;
+static telemetry_handle_t s_telemetry;
+static uart_pipe_t s_uart;
+static adc_stream_handle_t s_stream;
+static adc_replay_t s_replay;
+static q15_t s_plant[IDENT_MAX_TAPS];
+static float32_t s_fdafBuffer[FDAF_BUFFER_LEN(IDENT_MAX_TAPS)];
+static uint64_t s_rlsBuffer[RLS_BUFFER_SIZE(IDENT_MAX_TAPS) / sizeof(uint64_t)];
+static uint32_t s_apaBuffer[(APA_BUFFER_SIZE(IDENT_MAX_TAPS, IDENT_MAX_BLOCKSIZE) + 3U) / sizeof(uint32_t)];
+static uint8_t s_checkpoint[IDENT_CKPT_MAX_SIZE];
+
+/* En el orden de ident_algorithm_t */
+static const char *const s_algorithmNames[] = {"lms", "blms", "fdaf", "rls", "rlsq31", "apa", "auto"};
+
+static void print_profile(void)
+{
+	double nsPerTick = 1e9 / PROF_TicksPerSecond();
+
+	printf("# etapa    mediciones      min    media      max ticks (media ns), histograma <2^b:cantidad\n");
+	for(uint32_t i = 0; i < kPROF_NumScopes; i++)
+	{
+		const prof_stats_t *stats = &g_profStats[i];
+		if(stats->count == 0U)
+		{
+			continue;
+		}
+		double mean = (double)stats->sum / stats->count;
+		printf("# %-8s %10u %8u %8.0f %8u (%.1f ns),", PROF_GetName((prof_scope_t)i), stats->count, stats->min,
+			   mean, stats->max, mean * nsPerTick);
+		for(uint32_t b = 0; b < PROF_HIST_BINS; b++)
+		{
+			if(stats->hist[b] > 0U)
+			{
+				printf(" <2^%u:%u", b, stats->hist[b]);
+			}
+		}
+		printf("\n");
+	}
+}
+
+/* Transporte de la telemetria a un archivo (bloqueante) */
+static void telemetry_send(void *userData, const uint8_t *data, uint32_t size)
+{
+	fwrite(data, 1, size, (FILE *)userData);
+	TELEMETRY_TxDone(&s_telemetry);
+}
+
+/* Transporte no bloqueante: el hilo de uart_pipe libera el buffer al terminar */
+static void telemetry_send_uart(void *userData, const uint8_t *data, uint32_t size)
+{
+	UART_PIPE_SendNonBlocking((uart_pipe_t *)userData, data, size);
+}
+
+static void uart_tx_done(void *userData)
+{
+	TELEMETRY_TxDone((telemetry_handle_t *)userData);
+}
+
+static int parse_algorithm(const char *name, ident_algorithm_t *algorithm)
+{
+	for(uint32_t i = 0; i < sizeof(s_algorithmNames) / sizeof(s_algorithmNames[0]); i++)
+	{
+		if(strcmp(name, s_algorithmNames[i]) == 0)
+		{
+			*algorithm = (ident_algorithm_t)i;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+static int parse_rule(const char *name, lms_rule_t *rule)
+{
+	for(uint32_t i = 0; i < kLMS_RULE_NumRules; i++)
+	{
+		if(strcmp(name, LMS_RULE_GetName((lms_rule_t)i)) == 0)
+		{
+			*rule = (lms_rule_t)i;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+int main(int argc, char *argv[])
+{
+	q15_t mu = 1;
+	q15_t signal_power = 1;
+	uint32_t numframes = 5000U;
+	unsigned int seed = 1U;
+	int quiet = 0;
+	int profile = 0;
+	int earlyStop = 0;
+	const char *adcSource = NULL;
+	uint32_t sampleRate = 10000U;
+	uint32_t adcChannels = 1U;
+	const char *telemetryPath = NULL;
+	uint32_t snapshotFrames = 100U;
+	FILE *telemetryFile = NULL;
+	uint32_t baudRate = 0U;
+	telemetry_mse_encoding_t mseEncoding = kTELEMETRY_MseLog;
+	const char *resumePath = NULL;
+	const char *checkpointPath = NULL;
+	ident_ckpt_info_t checkpointInfo = {0, 0, 0U, 0};
+	ident_config_t config;
+
+	IDENT_GetDefaultConfig(&config);
+	config.algorithm = kIDENT_AlgAuto;
+	config.io = &s_identIo;
+	config.fdafBuffer = s_fdafBuffer;
+	config.rlsBuffer = s_rlsBuffer;
+	config.apaBuffer = s_apaBuffer;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if((argv[i][0] == '-') && (argv[i][1] == 'q'))
+		{
+			quiet = 1;
+		}
+		else if((argv[i][0] == '-') && (argv[i][1] == 'S'))
+		{
+			config.fusedKernel = false;
+		}
+		else if((argv[i][0] == '-') && (argv[i][1] == 'P'))
+		{
+			profile = 1;
+		}
+		else if((argv[i][0] == '-') && (argv[i][1] == 'c'))
+		{
+			earlyStop = 1;
+		}
+		else if((argv[i][0] == '-') && (argv[i][1] == 'y'))
+		{
+			adcChannels = 2U;
+		}
+		else if((argv[i][0] == '-') && (argv[i][1] == 'v'))
+		{
+			config.variableMu = true;
+		}
+		else if((argv[i][0] == '-') && (i + 1 < argc))
+		{
+			long value = strtol(argv[i + 1], NULL, 0);
+			switch(argv[i][1])
+			{
+				case 'm': mu = (q15_t)value; break;
+				case 'p': signal_power = (q15_t)value; break;
+				case 'f': numframes = (uint32_t)value; break;
+				case 's': seed = (unsigned int)value; break;
+				case 'L': config.subBlockSize = (uint32_t)value; break;
+				case 'n': config.numTaps = (uint16_t)value; break;
+				case 'b': config.blockSize = (uint32_t)value; break;
+				case 'k': config.apaOrder = (uint16_t)value; break;
+				case 'l': config.lmsLeak = (q15_t)value; break;
+				case 'T': telemetryPath = argv[i + 1]; break;
+				case 'C': snapshotFrames = (uint32_t)value; break;
+				case 'U': baudRate = (uint32_t)value; break;
+				case 'R': resumePath = argv[i + 1]; break;
+				case 'W': checkpointPath = argv[i + 1]; break;
+				case 'A': adcSource = argv[i + 1]; break;
+				case 'r': sampleRate = (uint32_t)value; break;
+				case 'E':
+					if(strcmp(argv[i + 1], "log") == 0)
+					{
+						mseEncoding = kTELEMETRY_MseLog;
+					}
+					else if(strcmp(argv[i + 1], "delta") == 0)
+					{
+						mseEncoding = kTELEMETRY_MseDelta;
+					}
+					else
+					{
+						fprintf(stderr, "Codificacion desconocida: %s\n", argv[i + 1]);
+						return 1;
+					}
+					break;
+				case 'u':
+					if(parse_rule(argv[i + 1], &config.lmsRule) != 0)
+					{
+						fprintf(stderr, "Regla desconocida: %s\n", argv[i + 1]);
+						return 1;
+					}
+					break;
+				case 'a':
+					if(parse_algorithm(argv[i + 1], &config.algorithm) != 0)
+					{
+						fprintf(stderr, "Algoritmo desconocido: %s\n", argv[i + 1]);
+						return 1;
+					}
+					break;
+				default:
+					fprintf(stderr, "Opcion desconocida: %s\n", argv[i]);
+					return 1;
+			}
+			i++;
+		}
+		else
+		{
+			fprintf(stderr, "Uso: %s [-a algoritmo] [-u regla] [-l fuga] [-L subbloque] [-n numtaps] [-b blocksize] [-m mu] "
+					"[-p signal_power] [-f numframes] [-s semilla] [-k orden] [-T archivo] [-C tramas] "
+					"[-E codificacion] [-U baudios] [-R archivo] [-W archivo] [-A fuente] [-r frecuencia] [-S] [-P] [-c] [-y] [-v] [-q]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	/* Planta sintetica para largos distintos del de la planta del firmware */
+	if((config.numTaps != IDENT_DEFAULT_NUMTAPS) && (config.numTaps <= IDENT_MAX_TAPS))
+	{
+		for(uint32_t k = 0; k < config.numTaps; k++)
+		{
+			s_plant[k] = (q15_t)(16000.0 * exp(-4.0 * k / config.numTaps) * cos(0.3 * k));
+		}
+		config.plantCoeffs = s_plant;
+	}
+
+	if(IDENT_Init(&s_ident, &config) != ARM_MATH_SUCCESS)
+	{
+		fprintf(stderr, "Configuracion invalida\n");
+		return 1;
+	}
+
+	IDENT_Seed(&s_ident, seed);
+	IDENT_Restart(&s_ident, mu);
+	if(resumePath != NULL)
+	{
+		FILE *file = fopen(resumePath, "rb");
+		uint32_t size = (file != NULL) ? (uint32_t)fread(s_checkpoint, 1, sizeof(s_checkpoint), file) : 0U;
+		if(file != NULL)
+		{
+			fclose(file);
+		}
+		arm_status status = IDENT_CKPT_Load(&s_ident, s_checkpoint, size, &checkpointInfo);
+		if(status != ARM_MATH_SUCCESS)
+		{
+			fprintf(stderr, "Checkpoint invalido: %s (%d)\n", resumePath, status);
+			return 1;
+		}
+		IDENT_Resume(&s_ident, mu);
+	}
+	PROF_Init();
+
+	conv_detect_config_t convConfig;
+	conv_detect_instance_t conv;
+	CONV_DETECT_GetDefaultConfig(&convConfig);
+	if(resumePath != NULL)
+	{
+		convConfig.minDrop = 0U;
+	}
+	CONV_DETECT_Init(&conv, &convConfig);
+
+	if((telemetryPath != NULL) && (baudRate != 0U))
+	{
+		if(UART_PIPE_Open(&s_uart, telemetryPath, baudRate, uart_tx_done, &s_telemetry) != 0)
+		{
+			fprintf(stderr, "No se pudo abrir %s\n", telemetryPath);
+			return 1;
+		}
+		TELEMETRY_Init(&s_telemetry, telemetry_send_uart, &s_uart, mseEncoding);
+	}
+	else if(telemetryPath != NULL)
+	{
+		telemetryFile = fopen(telemetryPath, "wb");
+		if(telemetryFile == NULL)
+		{
+			fprintf(stderr, "No se pudo abrir %s\n", telemetryPath);
+			return 1;
+		}
+		TELEMETRY_Init(&s_telemetry, telemetry_send, telemetryFile, mseEncoding);
+	}
+	if(telemetryPath != NULL)
+	{
+		TELEMETRY_SendStart(&s_telemetry, s_ident.plantCoeffs, s_ident.numTaps, mu, signal_power, numframes,
+							(uint16_t)s_ident.blockSize);
+	}
+
+	if(adcSource != NULL)
+	{
+		if(ADC_STREAM_Init(&s_stream, s_ident.blockSize, adcChannels) != ARM_MATH_SUCCESS)
+		{
+			fprintf(stderr, "Tramas de mas de %u muestras\n", ADC_STREAM_MAX_BLOCKSIZE);
+			return 1;
+		}
+		if(ADC_REPLAY_Open(&s_replay, &s_stream, adcSource, sampleRate, signal_power, seed) != 0)
+		{
+			fprintf(stderr, "No se pudo abrir %s\n", adcSource);
+			return 1;
+		}
+	}
+
+	struct timespec t0, t1;
+	q31_t lastMse = 0;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+
+	uint32_t frames = numframes;
+	for(uint32_t i = 0; i < numframes; i++)
+	{
+		/* Con el ADC se espera el proximo bloque, como el lazo del firmware */
+		const q15_t *block = NULL;
+		if(adcSource != NULL)
+		{
+			block = ADC_REPLAY_WaitBlock(&s_replay);
+			if(block == NULL)
+			{
+				frames = i;
+				break;
+			}
+		}
+
+		PROF_BEGIN(kPROF_Frame);
+		q31_t mse;
+		if(block != NULL)
+		{
+			mse = IDENT_ProcessBlock(&s_ident, block, ADC_STREAM_GetBlock(&s_stream, 1U));
+			ADC_STREAM_ReleaseBlock(&s_stream);
+		}
+		else
+		{
+			mse = IDENT_ProcessFrame(&s_ident, signal_power);
+		}
+		bool stop = CONV_DETECT_Update(&conv, mse) && earlyStop;
+		lastMse = mse;
+		if(!quiet)
+		{
+			printf("%u %d\n", i, mse);
+		}
+		if(telemetryPath != NULL)
+		{
+			PROF_BEGIN(kPROF_Output);
+			TELEMETRY_SendMse(&s_telemetry, i, mse);
+			if(((snapshotFrames != 0U) && (((i + 1U) % snapshotFrames) == 0U)) || stop)
+			{
+				TELEMETRY_SendCoeffs(&s_telemetry, i, s_ident.lmsCoeffs, s_ident.numTaps);
+			}
+			PROF_END(kPROF_Output);
+		}
+		PROF_END(kPROF_Frame);
+		if(stop)
+		{
+			frames = i + 1U;
+			break;
+		}
+	}
+
+	struct timespec t2;
+	clock_gettime(CLOCK_MONOTONIC, &t2);
+	if(adcSource != NULL)
+	{
+		ADC_REPLAY_Close(&s_replay);
+	}
+	if(telemetryPath != NULL)
+	{
+#if PROF_ENABLE
+		TELEMETRY_SendProfile(&s_telemetry);
+#endif
+		TELEMETRY_SendEnd(&s_telemetry, frames);
+		TELEMETRY_Drain(&s_telemetry);
+	}
+	if(telemetryFile != NULL)
+	{
+		fclose(telemetryFile);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+	/* Diferencia entre planta y filtro adaptativo */
+	printf("# algoritmo %s%s%s%s, %u taps, tramas de %u muestras\n", s_algorithmNames[s_ident.algorithm],
+		   (s_ident.lmsRule != kLMS_RULE_Standard) ? " " : "",
+		   (s_ident.lmsRule != kLMS_RULE_Standard) ? LMS_RULE_GetName(s_ident.lmsRule) : "",
+		   s_ident.fusedKernel ? ", planta fusionada" : "",
+		   s_ident.numTaps, s_ident.blockSize);
+	printf("# coef planta lms diferencia\n");
+	for(uint16_t k = 0; k < s_ident.numTaps; k++)
+	{
+		printf("# %2u %6d %6d %6d\n", k, s_ident.plantCoeffs[k], s_ident.lmsCoeffs[k],
+			   s_ident.plantCoeffs[k] - s_ident.lmsCoeffs[k]);
+	}
+	printf("# %u tramas en %.6f s (%.1f ns/muestra)\n", frames, seconds,
+		   seconds * 1e9 / ((double)frames * s_ident.blockSize));
+	printf("# convergencia en la trama %d\n", conv.convFrame);
+	if(s_ident.variableMu)
+	{
+		printf("# mu final %d\n", VSS_GetMu(&s_ident.vss));
+	}
+	if(adcSource != NULL)
+	{
+		double usPerTick = 1e6 / PROF_TicksPerSecond();
+		printf("# adquisicion %s: %u bloques, %u overruns (%u muestras descartadas), latencia maxima %.1f us",
+			   adcSource, s_stream.stats.blocks, s_stream.stats.overruns, s_stream.stats.droppedSamples,
+			   s_stream.stats.maxLatency * usPerTick);
+		if(sampleRate != 0U)
+		{
+			printf(" (bloque de %.1f us)", 1e6 * s_ident.blockSize / sampleRate);
+		}
+		printf("\n");
+	}
+	if(resumePath != NULL)
+	{
+		printf("# arranque en caliente desde %s (%u tramas con mu %d)\n", resumePath, checkpointInfo.frames,
+			   checkpointInfo.mu);
+	}
+	if(checkpointPath != NULL)
+	{
+		checkpointInfo.mu = mu;
+		checkpointInfo.signalPower = signal_power;
+		checkpointInfo.frames += frames;
+		checkpointInfo.mse = lastMse;
+		uint32_t size = IDENT_CKPT_Save(&s_ident, &checkpointInfo, s_checkpoint, sizeof(s_checkpoint));
+		FILE *file = (size != 0U) ? fopen(checkpointPath, "wb") : NULL;
+		if((file == NULL) || (fwrite(s_checkpoint, 1, size, file) != size))
+		{
+			fprintf(stderr, "No se pudo guardar el checkpoint en %s\n", checkpointPath);
+		}
+		else
+		{
+			printf("# checkpoint de %u bytes en %s\n", size, checkpointPath);
+		}
+		if(file != NULL)
+		{
+			fclose(file);
+		}
+	}
+	if(profile)
+	{
+		print_profile();
+	}
+
+	if((telemetryPath != NULL) && (baudRate != 0U))
+	{
+		/* Sin superposicion, el total seria el calculo mas la transmision */
+		struct timespec t3;
+		clock_gettime(CLOCK_MONOTONIC, &t3);
+		double total = (double)(t3.tv_sec - t0.tv_sec) + (double)(t3.tv_nsec - t0.tv_nsec) * 1e-9;
+		double drain = (double)(t3.tv_sec - t2.tv_sec) + (double)(t3.tv_nsec - t2.tv_nsec) * 1e-9;
+		UART_PIPE_Close(&s_uart);
+		printf("# UART %u baudios: %llu bytes (%.3f s de transmision), total %.3f s, espera final %.3f s\n",
+			   baudRate, (unsigned long long)s_uart.bytesSent, (double)s_uart.bytesSent * 10.0 / baudRate, total,
+			   drain);
+	}
+
+	return 0;
+}
@@ -0,0 +1,374 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Barrido de parametros de identificacion en el host. En lugar de cambiar mu y la
+	potencia de la señal con los pulsadores SW3/SW2 y esperar una corrida completa por
+	cada punto, se corre toda la grilla mu x signal_power x numTaps x blockSize como
+	trabajos independientes en un pool de hilos con robo de trabajo (work_pool.h).
+
+	Uso:
+		ident_sweep [-m mu,...] [-p signal_power,...] [-n numtaps,...] [-b blocksize,...]
+					[-f numframes] [-a algoritmo] [-L subbloque] [-k orden] [-j hilos]
+					[-s semilla] [-c ventana] [-o archivo]
+
+	Cada lista es de valores separados por coma. Para numTaps distinto de 30 se usa la
+	planta sintetica de ident_host. Para plantas o tramas mas grandes que las del
+	firmware, compilar con -DIDENT_MAX_TAPS=... -DIDENT_MAX_BLOCKSIZE=...
+
+	Cada trabajo usa su propio generador de entrada con la semilla -s mas el indice
+	del trabajo, por lo que el archivo de salida no depende de la cantidad de hilos.
+
+	Con -c cada trabajo termina al detectar la convergencia (conv_detect.h, con ventanas
+	de la cantidad de tramas indicada y el resto de la configuracion por defecto); las
+	tramas que no se procesaron quedan con MSE -1. Sin -c (o con -c 0) se corren siempre
+	numframes tramas, pero igual se informa la trama de convergencia.
+
+	Formato del archivo de salida (columnar, little endian):
+		char     magic[4] = "IDSW"
+		uint32   version = 1
+		uint32   numJobs
+		uint32   numColumns
+		numColumns descriptores de 24 bytes:
+			char     name[16]       (terminado en 0)
+			char     type           (codigo de numpy/struct: 'b', 'h', 'H', 'i', 'I', 'd')
+			uint8    reserved[3]
+			uint32   width          (valores por trabajo)
+		las columnas, una detras de otra, con numJobs * width valores cada una.
+	Con numpy: np.frombuffer(data, dtype='<' + type, count=numJobs * width, offset=...).
+	Las columnas son: mu, signal_power, num_taps, block_size, status (0 = ok,
+	-1 = configuracion invalida), coef_sse (suma de los errores de coeficientes al
+	cuadrado), coef_maxerr (maximo error absoluto de coeficiente), conv_frame (trama de
+	convergencia, -1 si no se detecto) y mse (la curva de MSE por trama, numframes
+	valores por trabajo).
+ */
+
+#include "ident.h"
+#include "work_pool.h"
+#include "conv_detect.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#define MAX_VALUES (64U)
+
+/* Lista de valores de un eje de la grilla */
+typedef struct _sweep_axis
+{
+	uint32_t count;
+	int32_t values[MAX_VALUES];
+} sweep_axis_t;
+
+/* Buffers propios de cada hilo */
+typedef struct _sweep_worker
+{
+	ident_handle_t ident;
+	ident_io_t io;
+	q15_t plant[IDENT_MAX_TAPS];
+	float32_t fdafBuffer[FDAF_BUFFER_LEN(IDENT_MAX_TAPS)];
+	uint64_t rlsBuffer[RLS_BUFFER_SIZE(IDENT_MAX_TAPS) / sizeof(uint64_t)];
+	uint32_t apaBuffer[(APA_BUFFER_SIZE(IDENT_MAX_TAPS, IDENT_MAX_BLOCKSIZE) + 3U) / sizeof(uint32_t)];
+} sweep_worker_t;
+
+/* Barrido completo: grilla, configuracion comun y resultados por columnas */
+typedef struct _sweep
+{
+	sweep_axis_t mu;
+	sweep_axis_t power;
+	sweep_axis_t numTaps;
+	sweep_axis_t blockSize;
+	uint32_t numFrames;
+	uint32_t numJobs;
+	ident_algorithm_t algorithm;
+	uint32_t subBlockSize;
+	uint16_t apaOrder;
+	uint32_t seed;
+	uint32_t convWindow;		/* Tramas por ventana del detector, 0 = sin corte */
+	sweep_worker_t *workers;
+
+	int16_t *colMu;
+	int16_t *colPower;
+	uint16_t *colNumTaps;
+	uint32_t *colBlockSize;
+	int8_t *colStatus;
+	double *colCoefSse;
+	int32_t *colCoefMaxErr;
+	int32_t *colConvFrame;
+	int32_t *colMse;
+} sweep_t;
+
+/* En el orden de ident_algorithm_t */
+static const char *const s_algorithmNames[] = {"lms", "blms", "fdaf", "rls", "rlsq31", "apa", "auto"};
+
+static int parse_axis(const char *text, sweep_axis_t *axis)
+{
+	axis->count = 0;
+	while(*text != '\0')
+	{
+		char *end;
+		long value = strtol(text, &end, 0);
+		if((end == text) || (axis->count == MAX_VALUES))
+		{
+			return -1;
+		}
+		axis->values[axis->count++] = (int32_t)value;
+		text = (*end == ',') ? end + 1 : end;
+		if((*end != ',') && (*end != '\0'))
+		{
+			return -1;
+		}
+	}
+	return (axis->count > 0U) ? 0 : -1;
+}
+
+static void sweep_job(uint32_t index, uint32_t worker, void *arg)
+{
+	sweep_t *sweep = (sweep_t *)arg;
+	sweep_worker_t *w = &sweep->workers[worker];
+	ident_config_t config;
+	conv_detect_config_t convConfig;
+	conv_detect_instance_t conv;
+
+	/* Indices de la grilla: mu varia mas rapido */
+	uint32_t k = index;
+	q15_t mu = (q15_t)sweep->mu.values[k % sweep->mu.count];
+	k /= sweep->mu.count;
+	q15_t power = (q15_t)sweep->power.values[k % sweep->power.count];
+	k /= sweep->power.count;
+	uint16_t numTaps = (uint16_t)sweep->numTaps.values[k % sweep->numTaps.count];
+	k /= sweep->numTaps.count;
+	uint32_t blockSize = (uint32_t)sweep->blockSize.values[k];
+
+	sweep->colMu[index] = mu;
+	sweep->colPower[index] = power;
+	sweep->colNumTaps[index] = numTaps;
+	sweep->colBlockSize[index] = blockSize;
+
+	IDENT_GetDefaultConfig(&config);
+	config.numTaps = numTaps;
+	config.blockSize = blockSize;
+	config.algorithm = sweep->algorithm;
+	config.subBlockSize = sweep->subBlockSize;
+	config.apaOrder = sweep->apaOrder;
+	config.io = &w->io;
+	config.fdafBuffer = w->fdafBuffer;
+	config.rlsBuffer = w->rlsBuffer;
+	config.apaBuffer = w->apaBuffer;
+
+	/* Planta sintetica para largos distintos del de la planta del firmware */
+	if((numTaps != IDENT_DEFAULT_NUMTAPS) && (numTaps <= IDENT_MAX_TAPS))
+	{
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			w->plant[i] = (q15_t)(16000.0 * exp(-4.0 * i / numTaps) * cos(0.3 * i));
+		}
+		config.plantCoeffs = w->plant;
+	}
+
+	int32_t *mse = &sweep->colMse[(size_t)index * sweep->numFrames];
+	if((numTaps == 0U) || (blockSize == 0U) || (IDENT_Init(&w->ident, &config) != ARM_MATH_SUCCESS))
+	{
+		sweep->colStatus[index] = -1;
+		sweep->colCoefSse[index] = 0.0;
+		sweep->colCoefMaxErr[index] = 0;
+		sweep->colConvFrame[index] = -1;
+		memset(mse, 0, sweep->numFrames * sizeof(int32_t));
+		return;
+	}
+
+	CONV_DETECT_GetDefaultConfig(&convConfig);
+	convConfig.window = (sweep->convWindow != 0U) ? sweep->convWindow : convConfig.window;
+	CONV_DETECT_Init(&conv, &convConfig);
+
+	IDENT_Seed(&w->ident, sweep->seed + index);
+	IDENT_Restart(&w->ident, mu);
+	uint32_t frames = 0;
+	while(frames < sweep->numFrames)
+	{
+		mse[frames] = IDENT_ProcessFrame(&w->ident, power);
+		frames++;
+		if(CONV_DETECT_Update(&conv, mse[frames - 1U]) && (sweep->convWindow != 0U))
+		{
+			break;
+		}
+	}
+	for(uint32_t i = frames; i < sweep->numFrames; i++)
+	{
+		mse[i] = -1;
+	}
+
+	double sse = 0.0;
+	int32_t maxErr = 0;
+	for(uint32_t i = 0; i < numTaps; i++)
+	{
+		int32_t diff = (int32_t)w->ident.plantCoeffs[i] - w->ident.lmsCoeffs[i];
+		sse += (double)diff * diff;
+		maxErr = (abs(diff) > maxErr) ? abs(diff) : maxErr;
+	}
+	sweep->colStatus[index] = 0;
+	sweep->colCoefSse[index] = sse;
+	sweep->colCoefMaxErr[index] = maxErr;
+	sweep->colConvFrame[index] = conv.convFrame;
+}
+
+static void write_column(FILE *file, const char *name, char type, uint32_t width)
+{
+	char desc[24] = {0};
+	strncpy(desc, name, 15);
+	desc[16] = type;
+	memcpy(&desc[20], &width, sizeof(width));
+	fwrite(desc, 1, sizeof(desc), file);
+}
+
+static int write_output(const sweep_t *sweep, const char *path)
+{
+	FILE *file = fopen(path, "wb");
+	if(file == NULL)
+	{
+		return -1;
+	}
+
+	uint32_t header[3] = {1U, sweep->numJobs, 9U};
+	fwrite("IDSW", 1, 4, file);
+	fwrite(header, sizeof(uint32_t), 3, file);
+
+	write_column(file, "mu", 'h', 1U);
+	write_column(file, "signal_power", 'h', 1U);
+	write_column(file, "num_taps", 'H', 1U);
+	write_column(file, "block_size", 'I', 1U);
+	write_column(file, "status", 'b', 1U);
+	write_column(file, "coef_sse", 'd', 1U);
+	write_column(file, "coef_maxerr", 'i', 1U);
+	write_column(file, "conv_frame", 'i', 1U);
+	write_column(file, "mse", 'i', sweep->numFrames);
+
+	size_t n = sweep->numJobs;
+	fwrite(sweep->colMu, sizeof(int16_t), n, file);
+	fwrite(sweep->colPower, sizeof(int16_t), n, file);
+	fwrite(sweep->colNumTaps, sizeof(uint16_t), n, file);
+	fwrite(sweep->colBlockSize, sizeof(uint32_t), n, file);
+	fwrite(sweep->colStatus, sizeof(int8_t), n, file);
+	fwrite(sweep->colCoefSse, sizeof(double), n, file);
+	fwrite(sweep->colCoefMaxErr, sizeof(int32_t), n, file);
+	fwrite(sweep->colConvFrame, sizeof(int32_t), n, file);
+	fwrite(sweep->colMse, sizeof(int32_t), n * sweep->numFrames, file);
+
+	return (fclose(file) == 0) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+	static sweep_t sweep;
+	uint32_t numWorkers = POOL_GetNumCpus();
+	const char *path = "sweep.idsw";
+
+	sweep.numFrames = 5000U;
+	sweep.seed = 1U;
+	sweep.algorithm = kIDENT_AlgLms;
+	sweep.apaOrder = 4U;
+	parse_axis("1,10,100,1000,10000", &sweep.mu);
+	parse_axis("1,10,100", &sweep.power);
+	parse_axis("30", &sweep.numTaps);
+	parse_axis("100", &sweep.blockSize);
+
+	for(int i = 1; i + 1 < argc; i += 2)
+	{
+		int error = 0;
+		const char *value = argv[i + 1];
+		switch((argv[i][0] == '-') ? argv[i][1] : '\0')
+		{
+			case 'm': error = parse_axis(value, &sweep.mu); break;
+			case 'p': error = parse_axis(value, &sweep.power); break;
+			case 'n': error = parse_axis(value, &sweep.numTaps); break;
+			case 'b': error = parse_axis(value, &sweep.blockSize); break;
+			case 'f': sweep.numFrames = (uint32_t)strtoul(value, NULL, 0); break;
+			case 'L': sweep.subBlockSize = (uint32_t)strtoul(value, NULL, 0); break;
+			case 'k': sweep.apaOrder = (uint16_t)strtoul(value, NULL, 0); break;
+			case 'j': numWorkers = (uint32_t)strtoul(value, NULL, 0); break;
+			case 's': sweep.seed = (uint32_t)strtoul(value, NULL, 0); break;
+			case 'c': sweep.convWindow = (uint32_t)strtoul(value, NULL, 0); break;
+			case 'o': path = value; break;
+			case 'a':
+				error = -1;
+				for(uint32_t k = 0; k < sizeof(s_algorithmNames) / sizeof(s_algorithmNames[0]); k++)
+				{
+					if(strcmp(value, s_algorithmNames[k]) == 0)
+					{
+						sweep.algorithm = (ident_algorithm_t)k;
+						error = 0;
+					}
+				}
+				break;
+			default:
+				error = -1;
+				break;
+		}
+		if(error != 0)
+		{
+			fprintf(stderr, "Opcion invalida: %s %s\n", argv[i], value);
+			return 1;
+		}
+	}
+	if((argc % 2) == 0)
+	{
+		fprintf(stderr, "Uso: %s [-m mu,...] [-p signal_power,...] [-n numtaps,...] [-b blocksize,...] "
+				"[-f numframes] [-a algoritmo] [-L subbloque] [-k orden] [-j hilos] [-s semilla] [-c ventana] [-o archivo]\n",
+				argv[0]);
+		return 1;
+	}
+	if(numWorkers == 0U)
+	{
+		numWorkers = 1U;
+	}
+
+	sweep.numJobs = sweep.mu.count * sweep.power.count * sweep.numTaps.count * sweep.blockSize.count;
+	size_t n = sweep.numJobs;
+	sweep.workers = (sweep_worker_t *)malloc(numWorkers * sizeof(sweep_worker_t));
+	sweep.colMu = (int16_t *)malloc(n * sizeof(int16_t));
+	sweep.colPower = (int16_t *)malloc(n * sizeof(int16_t));
+	sweep.colNumTaps = (uint16_t *)malloc(n * sizeof(uint16_t));
+	sweep.colBlockSize = (uint32_t *)malloc(n * sizeof(uint32_t));
+	sweep.colStatus = (int8_t *)malloc(n * sizeof(int8_t));
+	sweep.colCoefSse = (double *)malloc(n * sizeof(double));
+	sweep.colCoefMaxErr = (int32_t *)malloc(n * sizeof(int32_t));
+	sweep.colConvFrame = (int32_t *)malloc(n * sizeof(int32_t));
+	sweep.colMse = (int32_t *)malloc(n * sweep.numFrames * sizeof(int32_t));
+	if((sweep.workers == NULL) || (sweep.colMu == NULL) || (sweep.colPower == NULL) || (sweep.colNumTaps == NULL) ||
+	   (sweep.colBlockSize == NULL) || (sweep.colStatus == NULL) || (sweep.colCoefSse == NULL) ||
+	   (sweep.colCoefMaxErr == NULL) || (sweep.colConvFrame == NULL) || (sweep.colMse == NULL))
+	{
+		fprintf(stderr, "Sin memoria para %u trabajos\n", sweep.numJobs);
+		return 1;
+	}
+
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	if(POOL_Run(sweep.numJobs, numWorkers, sweep_job, &sweep) != 0)
+	{
+		fprintf(stderr, "No se pudo iniciar el pool de hilos\n");
+		return 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+	if(write_output(&sweep, path) != 0)
+	{
+		fprintf(stderr, "No se pudo escribir %s\n", path);
+		return 1;
+	}
+
+	printf("%u trabajos de %u tramas en %.2f s con %u hilos -> %s\n", sweep.numJobs, sweep.numFrames, seconds,
+		   numWorkers, path);
+
+	uint32_t converged = 0;
+	uint64_t processed = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		converged += (sweep.colConvFrame[i] >= 0) ? 1U : 0U;
+		processed += ((sweep.convWindow != 0U) && (sweep.colConvFrame[i] >= 0)) ? (uint64_t)sweep.colConvFrame[i] + 1U
+																				   : sweep.numFrames;
+	}
+	printf("%u trabajos convergieron; %.1f %% de las tramas procesadas\n", converged,
+		   100.0 * (double)processed / ((double)n * sweep.numFrames));
+	return 0;
+}
@@ -0,0 +1,209 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Tramas que se ahorran por reinicio arrancando en caliente desde un checkpoint
+	(ident_ckpt.h) en lugar de poner los coeficientes en cero. Se simula la secuencia de
+	reinicios del firmware al apretar SW3: mu arranca en -m y se multiplica por 10 hasta
+	10000 y despues sube de a 3000 hasta 28000 (o la lista de mu indicada). Cada reinicio
+	parte del mismo checkpoint (misma historia y misma secuencia de entrada) y se corre:
+	 - en frio: IDENT_Restart(), coeficientes en cero, como hasta ahora,
+	 - en caliente: IDENT_Resume() con los coeficientes del checkpoint.
+	Para cada uno se informa la trama de convergencia (primera trama en la que el promedio
+	movil de MSE sobre CONV_WINDOW tramas queda por debajo del umbral -t, -1 si no llega)
+	y el MSE promedio de las ultimas CONV_WINDOW tramas. Las tramas ahorradas son la
+	diferencia, contando numframes si la corrida en frio no converge.
+	Al terminar cada corrida en caliente el checkpoint se reemplaza con el mismo criterio
+	que el firmware: si conv_detect.h detecto la convergencia (sin exigir que el MSE baje
+	cuando se arranco desde un checkpoint).
+
+	Uso:
+		ident_warm [-a lms|blms] [-m mu] [-p signal_power] [-f numframes] [-t umbral] [-s semilla] [mu ...]
+ */
+
+#include "ident.h"
+#include "ident_ckpt.h"
+#include "conv_detect.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CONV_WINDOW (20U)
+#define MAX_RESTARTS (32U)
+
+static ident_handle_t s_ident;
+static ident_io_t s_identIo;
+
+/* Resultado de una corrida */
+typedef struct _warm_run
+{
+	int64_t convFrame;
+	double finalMse;
+	bool converged;		/* Segun conv_detect.h */
+	q31_t lastMse;
+} warm_run_t;
+
+static void warm_run(q15_t signal_power, uint32_t numframes, double threshold, bool resumed, warm_run_t *run)
+{
+	double window[CONV_WINDOW] = {0};
+	double windowSum = 0.0;
+	conv_detect_config_t convConfig;
+	conv_detect_instance_t conv;
+
+	CONV_DETECT_GetDefaultConfig(&convConfig);
+	convConfig.minDrop = resumed ? 0U : convConfig.minDrop;
+	CONV_DETECT_Init(&conv, &convConfig);
+
+	run->convFrame = -1;
+	for(uint32_t i = 0; i < numframes; i++)
+	{
+		q31_t mse = IDENT_ProcessFrame(&s_ident, signal_power);
+
+		run->converged = CONV_DETECT_Update(&conv, mse);
+		run->lastMse = mse;
+		windowSum += (double)mse - window[i % CONV_WINDOW];
+		window[i % CONV_WINDOW] = (double)mse;
+		if((run->convFrame < 0) && (i + 1U >= CONV_WINDOW) && (windowSum / CONV_WINDOW <= threshold))
+		{
+			run->convFrame = (int64_t)i + 1 - CONV_WINDOW;
+		}
+	}
+	run->finalMse = windowSum / CONV_WINDOW;
+}
+
+int main(int argc, char *argv[])
+{
+	q15_t mu = 100;
+	q15_t signal_power = 1;
+	uint32_t numframes = 5000U;
+	double threshold = 2000.0;
+	unsigned int seed = 1U;
+	q15_t muList[MAX_RESTARTS];
+	uint32_t count = 0;
+	ident_config_t config;
+
+	IDENT_GetDefaultConfig(&config);
+	config.io = &s_identIo;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if((argv[i][0] == '-') && (i + 1 < argc))
+		{
+			switch(argv[i][1])
+			{
+				case 'm': mu = (q15_t)strtol(argv[i + 1], NULL, 0); break;
+				case 'p': signal_power = (q15_t)strtol(argv[i + 1], NULL, 0); break;
+				case 'f': numframes = (uint32_t)strtoul(argv[i + 1], NULL, 0); break;
+				case 't': threshold = strtod(argv[i + 1], NULL); break;
+				case 's': seed = (unsigned int)strtoul(argv[i + 1], NULL, 0); break;
+				case 'a':
+					if(strcmp(argv[i + 1], "lms") == 0)
+					{
+						config.algorithm = kIDENT_AlgLms;
+					}
+					else if(strcmp(argv[i + 1], "blms") == 0)
+					{
+						config.algorithm = kIDENT_AlgBlockLms;
+					}
+					else
+					{
+						fprintf(stderr, "Algoritmo sin checkpoint: %s\n", argv[i + 1]);
+						return 1;
+					}
+					break;
+				default:
+					fprintf(stderr, "Opcion desconocida: %s\n", argv[i]);
+					return 1;
+			}
+			i++;
+		}
+		else if(count < MAX_RESTARTS)
+		{
+			muList[count++] = (q15_t)strtol(argv[i], NULL, 0);
+		}
+	}
+
+	/* Secuencia de SW3 (GPIOA_IRQHANDLER) */
+	if(count == 0U)
+	{
+		int32_t next = mu;
+		while(count < MAX_RESTARTS)
+		{
+			muList[count++] = (q15_t)next;
+			if(next >= 28000)
+			{
+				break;
+			}
+			next = (next >= 10000) ? (next + 3000) : (next * 10);
+			next = (next >= 28000) ? 28000 : next;
+		}
+	}
+
+	if(IDENT_Init(&s_ident, &config) != ARM_MATH_SUCCESS)
+	{
+		fprintf(stderr, "Configuracion invalida\n");
+		return 1;
+	}
+	IDENT_Seed(&s_ident, seed);
+
+	/* Sin checkpoint, el primer reinicio es en frio en ambos casos */
+	static uint8_t checkpoint[IDENT_CKPT_MAX_SIZE];
+	static uint8_t start[IDENT_CKPT_MAX_SIZE];
+	uint32_t checkpointSize = 0U;
+	int64_t saved = 0;
+	uint32_t restarts = 0U;
+
+	printf("# %s, signal_power %d, %u tramas por corrida, umbral %.1f\n",
+		   (config.algorithm == kIDENT_AlgBlockLms) ? "blms" : "lms", signal_power, numframes, threshold);
+	printf("# %6s %10s %12s %10s %12s %10s\n", "mu", "conv.frio", "MSE frio", "conv.cal", "MSE cal", "ahorradas");
+	for(uint32_t r = 0; r < count; r++)
+	{
+		warm_run_t cold, warm;
+		ident_ckpt_info_t info = {muList[r], signal_power, 0U, 0};
+
+		/* Punto de partida comun: el estado actual, con la historia y el generador */
+		uint32_t startSize = IDENT_CKPT_Save(&s_ident, &info, start, sizeof(start));
+
+		IDENT_Restart(&s_ident, muList[r]);
+		warm_run(signal_power, numframes, threshold, false, &cold);
+
+		IDENT_CKPT_Load(&s_ident, start, startSize, NULL);
+		bool resumed = false;
+		if((checkpointSize != 0U) &&
+		   (IDENT_CKPT_Load(&s_ident, checkpoint, checkpointSize, &info) == ARM_MATH_SUCCESS))
+		{
+			/* Coeficientes del checkpoint con la historia y el generador del punto de partida */
+			q15_t coeffs[IDENT_MAX_TAPS];
+			memcpy(coeffs, s_ident.lmsCoeffs, sizeof(coeffs));
+			IDENT_CKPT_Load(&s_ident, start, startSize, NULL);
+			memcpy(s_ident.lmsCoeffs, coeffs, sizeof(coeffs));
+			IDENT_Resume(&s_ident, muList[r]);
+			resumed = true;
+		}
+		else
+		{
+			IDENT_Restart(&s_ident, muList[r]);
+		}
+		warm_run(signal_power, numframes, threshold, resumed, &warm);
+
+		if(warm.converged)
+		{
+			info.mu = muList[r];
+			info.frames = numframes;
+			info.mse = warm.lastMse;
+			checkpointSize = IDENT_CKPT_Save(&s_ident, &info, checkpoint, sizeof(checkpoint));
+		}
+
+		int64_t coldFrames = (cold.convFrame < 0) ? (int64_t)numframes : cold.convFrame;
+		int64_t warmFrames = (warm.convFrame < 0) ? (int64_t)numframes : warm.convFrame;
+		printf("%8d %10lld %12.1f %10lld %12.1f %10lld\n", muList[r], (long long)cold.convFrame, cold.finalMse,
+			   (long long)warm.convFrame, warm.finalMse, (long long)(coldFrames - warmFrames));
+		if(r > 0U)
+		{
+			saved += coldFrames - warmFrames;
+			restarts++;
+		}
+	}
+
+	printf("# checkpoint de %u bytes; %lld tramas ahorradas en %u reinicios (%.1f por reinicio)\n",
+		   checkpointSize, (long long)saved, restarts, restarts ? (double)saved / restarts : 0.0);
+	return 0;
+}
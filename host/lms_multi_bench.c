@@ -0,0 +1,196 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Rendimiento del LMS multicanal (lms_multi.h) de 1 a maxCanales canales (en potencias
+	de 2), en un solo hilo. Para cada cantidad de canales se procesa la misma secuencia
+	con LMS_MULTI_Process y con un arm_lms_q15 por canal sobre los datos separados, y se
+	informa:
+	 - ns por trama del LMS multicanal,
+	 - muestras por segundo por nucleo (muestras de todos los canales) de ambos,
+	 - si los coeficientes y el error de cada canal coinciden bit a bit.
+	La entrada de cada canal es ruido uniforme y la referencia la misma entrada retrasada
+	(c % numTaps) muestras y dividida por 2. Se generan PREGEN_FRAMES tramas que se
+	repiten, para medir solo el filtro.
+
+	Uso:
+		lms_multi_bench [-n numtaps] [-b blocksize] [-m mu] [-c maxCanales] [-f tramas] [-s semilla]
+	con -f la cantidad de tramas por canal a procesar en total (se reparte entre los
+	canales, con un minimo de 4 tramas).
+ */
+
+#include "lms_multi.h"
+#include "prng.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PREGEN_FRAMES (4U)
+#define MIN_FRAMES (4U)
+
+static double bench_seconds(const struct timespec *t0, const struct timespec *t1)
+{
+	return (double)(t1->tv_sec - t0->tv_sec) + (double)(t1->tv_nsec - t0->tv_nsec) * 1e-9;
+}
+
+static int bench_run(uint16_t numTaps, uint32_t blockSize, q15_t mu, uint16_t numChannels, uint32_t numframes,
+					 uint64_t seed)
+{
+	uint32_t frameLen = blockSize * numChannels;
+	q15_t *src = malloc(PREGEN_FRAMES * frameLen * sizeof(q15_t));
+	q15_t *ref = malloc(PREGEN_FRAMES * frameLen * sizeof(q15_t));
+	q15_t *srcSplit = malloc(PREGEN_FRAMES * frameLen * sizeof(q15_t));
+	q15_t *refSplit = malloc(PREGEN_FRAMES * frameLen * sizeof(q15_t));
+	q15_t *out = malloc(frameLen * sizeof(q15_t));
+	q15_t *err = malloc(frameLen * sizeof(q15_t));
+	q15_t *errSplit = malloc(frameLen * sizeof(q15_t));
+	q15_t *coeffs = malloc(LMS_MULTI_COEFFS_LEN(numTaps, numChannels) * sizeof(q15_t));
+	q15_t *state = malloc(LMS_MULTI_STATE_LEN(numTaps, blockSize, numChannels) * sizeof(q15_t));
+	q15_t *scratch = malloc(LMS_MULTI_SCRATCH_LEN(blockSize) * sizeof(q15_t));
+	q15_t *coeffsSplit = calloc(LMS_MULTI_COEFFS_LEN(numTaps, numChannels), sizeof(q15_t));
+	q15_t *stateSplit = malloc(LMS_MULTI_STATE_LEN(numTaps, blockSize, numChannels) * sizeof(q15_t));
+	arm_lms_instance_q15 *lms = malloc(numChannels * sizeof(arm_lms_instance_q15));
+	q15_t tap[numTaps];
+	bool match = true;
+
+	if((src == NULL) || (ref == NULL) || (srcSplit == NULL) || (refSplit == NULL) || (out == NULL) ||
+	   (err == NULL) || (errSplit == NULL) || (coeffs == NULL) || (state == NULL) || (scratch == NULL) ||
+	   (coeffsSplit == NULL) || (stateSplit == NULL) || (lms == NULL))
+	{
+		fprintf(stderr, "Sin memoria para %u canales\n", numChannels);
+		return -1;
+	}
+
+	/* Tramas intercaladas por canal y su copia separada (canal c en [c * blockSize]) */
+	prng_instance_t prng;
+	PRNG_Init(&prng, seed);
+	PRNG_FillQ15(&prng, src, 15, 2, PREGEN_FRAMES * frameLen);
+	for(uint32_t f = 0; f < PREGEN_FRAMES; f++)
+	{
+		for(uint32_t n = 0; n < blockSize; n++)
+		{
+			for(uint32_t c = 0; c < numChannels; c++)
+			{
+				uint32_t delay = c % numTaps;
+				uint32_t i = f * frameLen + n * numChannels + c;
+				ref[i] = (n >= delay) ? (q15_t)(src[i - delay * numChannels] >> 1) : 0;
+				srcSplit[f * frameLen + c * blockSize + n] = src[i];
+				refSplit[f * frameLen + c * blockSize + n] = ref[i];
+			}
+		}
+	}
+
+	lms_multi_instance_q15 multi;
+	LMS_MULTI_Init(&multi, numTaps, numChannels, coeffs, state, scratch, mu, blockSize, 0U);
+	for(uint32_t c = 0; c < numChannels; c++)
+	{
+		arm_lms_init_q15(&lms[c], numTaps, &coeffsSplit[c * numTaps], &stateSplit[c * (numTaps + blockSize - 1U)],
+						 mu, blockSize, 0U);
+	}
+
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(uint32_t f = 0; f < numframes; f++)
+	{
+		uint32_t p = (f % PREGEN_FRAMES) * frameLen;
+		LMS_MULTI_Process(&multi, &src[p], &ref[p], out, err, blockSize);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double multiSeconds = bench_seconds(&t0, &t1);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(uint32_t f = 0; f < numframes; f++)
+	{
+		uint32_t p = (f % PREGEN_FRAMES) * frameLen;
+		for(uint32_t c = 0; c < numChannels; c++)
+		{
+			arm_lms_q15(&lms[c], &srcSplit[p + c * blockSize], &refSplit[p + c * blockSize], out,
+						&errSplit[c * blockSize], blockSize);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double splitSeconds = bench_seconds(&t0, &t1);
+
+	/* Coeficientes y error de la ultima trama de cada canal */
+	for(uint32_t c = 0; (c < numChannels) && match; c++)
+	{
+		LMS_MULTI_GetCoeffs(&multi, (uint16_t)c, tap);
+		match = (memcmp(tap, &coeffsSplit[c * numTaps], sizeof(tap)) == 0);
+		for(uint32_t n = 0; (n < blockSize) && match; n++)
+		{
+			match = (err[n * numChannels + c] == errSplit[c * blockSize + n]);
+		}
+	}
+
+	double samples = (double)numframes * frameLen;
+	printf("%8u %8u %12.1f %12.2f %12.2f %8.2f %6s\n", numChannels, numframes, multiSeconds * 1e9 / numframes,
+		   samples / multiSeconds * 1e-6, samples / splitSeconds * 1e-6, splitSeconds / multiSeconds,
+		   match ? "ok" : "ERROR");
+
+	free(src);
+	free(ref);
+	free(srcSplit);
+	free(refSplit);
+	free(out);
+	free(err);
+	free(errSplit);
+	free(coeffs);
+	free(state);
+	free(scratch);
+	free(coeffsSplit);
+	free(stateSplit);
+	free(lms);
+	return match ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+	uint16_t numTaps = 30U;
+	uint32_t blockSize = 100U;
+	q15_t mu = 1000;
+	uint32_t maxChannels = 1024U;
+	uint32_t totalFrames = 20000U;
+	uint64_t seed = 1U;
+
+	for(int i = 1; i + 1 < argc; i += 2)
+	{
+		if(argv[i][0] != '-')
+		{
+			fprintf(stderr, "Opcion desconocida: %s\n", argv[i]);
+			return 1;
+		}
+		switch(argv[i][1])
+		{
+			case 'n': numTaps = (uint16_t)strtoul(argv[i + 1], NULL, 0); break;
+			case 'b': blockSize = (uint32_t)strtoul(argv[i + 1], NULL, 0); break;
+			case 'm': mu = (q15_t)strtol(argv[i + 1], NULL, 0); break;
+			case 'c': maxChannels = (uint32_t)strtoul(argv[i + 1], NULL, 0); break;
+			case 'f': totalFrames = (uint32_t)strtoul(argv[i + 1], NULL, 0); break;
+			case 's': seed = strtoull(argv[i + 1], NULL, 0); break;
+			default:
+				fprintf(stderr, "Opcion desconocida: %s\n", argv[i]);
+				return 1;
+		}
+	}
+
+	if((numTaps == 0U) || (blockSize == 0U) || (maxChannels == 0U) || (maxChannels > UINT16_MAX))
+	{
+		fprintf(stderr, "Configuracion invalida\n");
+		return 1;
+	}
+
+	printf("# %u taps, tramas de %u muestras, mu %d, un hilo\n", numTaps, blockSize, mu);
+	printf("# %6s %8s %12s %12s %12s %8s %6s\n", "canales", "tramas", "ns/trama", "Mmues/s", "Mmues/s sep",
+		   "mejora", "igual");
+	int status = 0;
+	for(uint32_t c = 1U; c <= maxChannels; c *= 2U)
+	{
+		uint32_t frames = totalFrames / c;
+		if(bench_run(numTaps, blockSize, mu, (uint16_t)c, (frames < MIN_FRAMES) ? MIN_FRAMES : frames, seed) != 0)
+		{
+			status = 1;
+		}
+	}
+
+	return status;
+}
@@ -0,0 +1,420 @@
+"""
+    Autor: Santiago Raimondi.
+    @brief: Bindings de Python (ctypes) del decodificador de telemetria
+    (host/telemetry_decoder.c) y graficador en vivo para plot_serial.ipynb.
+
+    Primero se compila la biblioteca (desde la raiz del repositorio):
+
+        gcc -O3 -march=native -shared -fPIC -ICMSIS -ICMSIS/DSP/Include -Isource -Ihost
+            host/telemetry_decoder.c source/telemetry.c source/prof.c -o libtelemetry.so -lm
+
+    Uso:
+
+        reader = TelemetryReader("/dev/ttyACM0")   # o un pty, FIFO, archivo o "-"
+        reader.read_run()                           # hasta el paquete de fin de corrida
+        reader.mse                                  # numpy float64, NaN si no llego
+
+    Los datos los decodifica la biblioteca directamente del descriptor y los arreglos que
+    devuelve TelemetryReader son vistas de numpy sobre la memoria del decodificador (no
+    se copian). Las vistas dejan de ser validas cuando empieza otra corrida (cambia
+    reader.runs), por eso se piden de nuevo en cada actualizacion.
+    En lugar de una ruta se puede pasar cualquier objeto con read(), por ejemplo un
+    serial.Serial de pyserial (en Windows, donde no hay pty): los bytes se entregan al
+    decodificador sin copiarlos.
+"""
+
+import ctypes
+import os
+import sys
+import time
+
+import numpy as np
+
+# Deben coincidir con telemetry.h y telemetry_decoder.h
+TELEMETRY_HEADER_SIZE = 6
+TELEMETRY_CRC_SIZE = 2
+TELEMETRY_DECODER_MAX_PAYLOAD = 65535
+TELEMETRY_DECODER_MAX_SCOPES = 16
+TELEMETRY_DECODER_NAME_SIZE = 16
+PROF_HIST_BINS = 32
+MSE_DELTA = 0
+MSE_LOG = 1
+
+
+class _Profile(ctypes.Structure):
+    _fields_ = [
+        ("name", ctypes.c_char * TELEMETRY_DECODER_NAME_SIZE),
+        ("count", ctypes.c_uint32),
+        ("min", ctypes.c_uint32),
+        ("max", ctypes.c_uint32),
+        ("sum", ctypes.c_uint64),
+        ("hist", ctypes.c_uint32 * PROF_HIST_BINS),
+    ]
+
+
+class _Run(ctypes.Structure):
+    _fields_ = [
+        ("numTaps", ctypes.c_uint16),
+        ("numFrames", ctypes.c_uint32),
+        ("mu", ctypes.c_int16),
+        ("signalPower", ctypes.c_int16),
+        ("blockSize", ctypes.c_uint16),
+        ("mseEncoding", ctypes.c_uint8),
+        ("logBits", ctypes.c_uint8),
+        ("plantCoeffs", ctypes.POINTER(ctypes.c_int16)),
+        ("mse", ctypes.POINTER(ctypes.c_double)),
+        ("numSnapshots", ctypes.c_uint32),
+        ("snapshotFrames", ctypes.POINTER(ctypes.c_uint32)),
+        ("snapshotCoeffs", ctypes.POINTER(ctypes.c_int16)),
+        ("started", ctypes.c_bool),
+        ("ended", ctypes.c_bool),
+        ("framesDone", ctypes.c_uint32),
+        ("framesReceived", ctypes.c_uint32),
+        ("lastFrame", ctypes.c_uint32),
+        ("profileTicksPerSecond", ctypes.c_uint64),
+        ("numProfileScopes", ctypes.c_uint32),
+        ("profile", _Profile * TELEMETRY_DECODER_MAX_SCOPES),
+    ]
+
+
+class _Decoder(ctypes.Structure):
+    _fields_ = [
+        ("run", _Run),
+        ("runs", ctypes.c_uint32),
+        ("packets", ctypes.c_uint32),
+        ("crcErrors", ctypes.c_uint32),
+        ("skippedBytes", ctypes.c_uint32),
+        ("start", ctypes.c_uint32),
+        ("fill", ctypes.c_uint32),
+        ("eof", ctypes.c_bool),
+        ("buffer", ctypes.c_uint8 * (TELEMETRY_HEADER_SIZE + TELEMETRY_DECODER_MAX_PAYLOAD + TELEMETRY_CRC_SIZE)),
+    ]
+
+
+def load_library(path=None):
+    """
+        @brief: Carga libtelemetry. Si no se da la ruta se busca junto a este archivo, en la
+        raiz del repositorio y en el directorio actual.
+    """
+    if path is None:
+        name = {"win32": "telemetry.dll", "darwin": "libtelemetry.dylib"}.get(sys.platform, "libtelemetry.so")
+        here = os.path.dirname(os.path.abspath(__file__))
+        candidates = [os.path.join(d, name) for d in (here, os.path.dirname(here), os.getcwd())]
+        path = next((c for c in candidates if os.path.exists(c)), name)
+
+    lib = ctypes.CDLL(path)
+    decoder_p = ctypes.POINTER(_Decoder)
+    lib.TELEMETRY_DECODER_Init.argtypes = [decoder_p]
+    lib.TELEMETRY_DECODER_Init.restype = None
+    lib.TELEMETRY_DECODER_Free.argtypes = [decoder_p]
+    lib.TELEMETRY_DECODER_Free.restype = None
+    lib.TELEMETRY_DECODER_Feed.argtypes = [decoder_p, ctypes.c_void_p, ctypes.c_size_t]
+    lib.TELEMETRY_DECODER_Feed.restype = ctypes.c_int
+    lib.TELEMETRY_DECODER_Read.argtypes = [decoder_p, ctypes.c_int, ctypes.c_int]
+    lib.TELEMETRY_DECODER_Read.restype = ctypes.c_int
+    lib.TELEMETRY_DECODER_Open.argtypes = [ctypes.c_char_p, ctypes.c_uint32]
+    lib.TELEMETRY_DECODER_Open.restype = ctypes.c_int
+    lib.TELEMETRY_DECODER_Q15ToFloat.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint32]
+    lib.TELEMETRY_DECODER_Q15ToFloat.restype = None
+    return lib
+
+
+def _view(pointer, shape):
+    """ Vista de numpy sobre memoria del decodificador (sin copia) """
+    if not pointer or (0 in shape):
+        return np.zeros(shape, dtype=np.dtype(pointer._type_))
+    return np.ctypeslib.as_array(pointer, shape=shape)
+
+
+class TelemetryReader:
+    """
+        @brief: Lee la telemetria de un puerto serie, pty, FIFO, archivo o de un objeto con
+        read(), y la decodifica a medida que llega.
+    """
+
+    def __init__(self, source, baudrate=115200, lib=None):
+        self._lib = lib if lib is not None else load_library()
+        self._decoder = _Decoder()
+        self._lib.TELEMETRY_DECODER_Init(ctypes.byref(self._decoder))
+        self._stream = None
+        self._fd = -1
+        if isinstance(source, (str, bytes, os.PathLike)):
+            path = os.fsencode(source)
+            self._fd = self._lib.TELEMETRY_DECODER_Open(path, baudrate)
+            if self._fd < 0:
+                raise OSError("No se pudo abrir {}".format(os.fsdecode(path)))
+        else:
+            self._stream = source
+
+    def close(self):
+        if self._fd >= 0:
+            os.close(self._fd)
+            self._fd = -1
+        self._lib.TELEMETRY_DECODER_Free(ctypes.byref(self._decoder))
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def feed(self, data):
+        """ Entrega bytes al decodificador. Devuelve la cantidad de paquetes validos """
+        if not isinstance(data, (bytes, bytearray)):
+            data = bytes(data)
+        buf = (ctypes.c_char * len(data)).from_buffer(data) if isinstance(data, bytearray) else data
+        packets = self._lib.TELEMETRY_DECODER_Feed(ctypes.byref(self._decoder), buf, len(data))
+        if packets < 0:
+            raise MemoryError("Sin memoria en el decodificador")
+        return packets
+
+    def poll(self, timeout=0.1):
+        """
+            @brief: Espera hasta timeout segundos (None = sin limite) a que lleguen datos y
+            procesa lo recibido. Devuelve la cantidad de paquetes validos.
+        """
+        if self._stream is not None:
+            waiting = getattr(self._stream, "in_waiting", 0)
+            if hasattr(self._stream, "timeout"):
+                self._stream.timeout = timeout
+            data = self._stream.read(waiting if waiting > 0 else 1)
+            if not data:
+                # Un archivo sin timeout no va a recibir mas datos
+                self._decoder.eof = not hasattr(self._stream, "timeout")
+                return 0
+            return self.feed(data)
+
+        timeout_ms = -1 if timeout is None else int(timeout * 1000)
+        packets = self._lib.TELEMETRY_DECODER_Read(ctypes.byref(self._decoder), self._fd, timeout_ms)
+        if packets < 0:
+            raise OSError("Error leyendo la telemetria")
+        return packets
+
+    def read_run(self, timeout=None):
+        """
+            @brief: Lee hasta el fin de la corrida o de los datos. Devuelve False si pasaron
+            timeout segundos sin recibir un paquete valido.
+        """
+        last = time.monotonic()
+        while not (self.ended or self.eof):
+            if self.poll(0.1) > 0:
+                last = time.monotonic()
+            elif timeout is not None and time.monotonic() - last >= timeout:
+                return False
+        return True
+
+    # Datos de la corrida
+    @property
+    def started(self):
+        return self._decoder.run.started
+
+    @property
+    def ended(self):
+        return self._decoder.run.ended
+
+    @property
+    def eof(self):
+        return self._decoder.eof
+
+    @property
+    def runs(self):
+        return self._decoder.runs
+
+    @property
+    def num_taps(self):
+        return self._decoder.run.numTaps
+
+    @property
+    def num_frames(self):
+        return self._decoder.run.numFrames
+
+    @property
+    def mu(self):
+        return self._decoder.run.mu
+
+    @property
+    def signal_power(self):
+        return self._decoder.run.signalPower
+
+    @property
+    def block_size(self):
+        return self._decoder.run.blockSize
+
+    @property
+    def last_frame(self):
+        """ Ultima trama con MSE + 1 """
+        return self._decoder.run.lastFrame
+
+    @property
+    def frames_received(self):
+        return self._decoder.run.framesReceived
+
+    @property
+    def crc_errors(self):
+        return self._decoder.crcErrors
+
+    @property
+    def skipped_bytes(self):
+        return self._decoder.skippedBytes
+
+    @property
+    def mse(self):
+        """ MSE de cada trama (q31 sin escalar), NaN si no llego """
+        return _view(self._decoder.run.mse, (self.num_frames,))
+
+    @property
+    def plant_q15(self):
+        return _view(self._decoder.run.plantCoeffs, (self.num_taps,))
+
+    @property
+    def snapshot_frames(self):
+        return _view(self._decoder.run.snapshotFrames, (self._decoder.run.numSnapshots,))
+
+    @property
+    def snapshots_q15(self):
+        """ Copias de los coeficientes, una fila por copia """
+        return _view(self._decoder.run.snapshotCoeffs, (self._decoder.run.numSnapshots, self.num_taps))
+
+    def to_float(self, values):
+        """ Convierte un arreglo q15 a float32 en [-1, 1) con la funcion vectorizada de la biblioteca """
+        values = np.ascontiguousarray(values, dtype=np.int16)
+        out = np.empty(values.shape, dtype=np.float32)
+        self._lib.TELEMETRY_DECODER_Q15ToFloat(values.ctypes.data, out.ctypes.data, values.size)
+        return out
+
+    @property
+    def profile(self):
+        """
+            Ciclos por etapa del paquete 'P' (vacio si no llego): nombre -> dict con count,
+            min, max y mean en ticks, mean_us y el histograma (bin b = [2^(b-1), 2^b) ticks)
+        """
+        run = self._decoder.run
+        out = {}
+        for p in run.profile[:run.numProfileScopes]:
+            mean = p.sum / p.count if p.count else 0.0
+            out[p.name.decode()] = {
+                "count": p.count, "min": p.min, "max": p.max, "mean": mean,
+                "mean_us": mean * 1e6 / run.profileTicksPerSecond if run.profileTicksPerSecond else float("nan"),
+                "hist": np.array(p.hist, dtype=np.uint32),
+            }
+        return out
+
+    @property
+    def plant(self):
+        return self.to_float(self.plant_q15)
+
+    @property
+    def snapshots(self):
+        return self.to_float(self.snapshots_q15)
+
+
+class LivePlot:
+    """
+        @brief: Grafica la corrida mientras llega: coeficientes de la planta y de la ultima
+        copia del filtro adaptativo (en punto flotante y en entero) y la evolucion del MSE.
+        Solo se actualizan los datos de las lineas, sin volver a crear la figura.
+    """
+
+    def __init__(self, reader, fig=None):
+        import matplotlib.pyplot as plt
+
+        self._plt = plt
+        self.reader = reader
+        self.fig = fig if fig is not None else plt.figure(figsize=[14, 14])
+        self.ax_fp = self.fig.add_subplot(3, 1, 1)
+        self.ax_int = self.fig.add_subplot(3, 1, 2)
+        self.ax_mse = self.fig.add_subplot(3, 1, 3)
+        self._runs = -1
+        self._snapshots = -1
+        self._frames = -1
+
+    def _reset(self):
+        r = self.reader
+        for ax in (self.ax_fp, self.ax_int, self.ax_mse):
+            ax.clear()
+            ax.grid(True)
+        x = np.arange(r.num_taps)
+        self._lms_fp, = self.ax_fp.plot(x, np.zeros(r.num_taps), 'ro')
+        self.ax_fp.plot(x, r.plant, 'bx')
+        self.ax_fp.legend(["LMS coeficients", "FIR coeficients"])
+        self._title = "Coeficientes en punto flotante (mu = {}, signal_power = {})".format(r.mu, r.signal_power)
+        self.ax_fp.set_title(self._title)
+        self._lms_int, = self.ax_int.plot(x, np.zeros(r.num_taps), 'ro')
+        self.ax_int.plot(x, r.plant_q15, 'bx')
+        self.ax_int.legend(["LMS coeficients", "FIR coeficients"])
+        self.ax_int.set_title("Coeficientes en entero")
+        self._mse_line, = self.ax_mse.semilogy([], [], 'b--')
+        self.ax_mse.set_xlim(0, max(r.num_frames, 1))
+        self.ax_mse.legend(["Medium Square Error"])
+        self.ax_mse.set_title("Evolución del MSE por iteración")
+        self._runs = r.runs
+        self._snapshots = -1
+        self._frames = -1
+
+    def update(self):
+        """ Actualiza las lineas con lo recibido. Devuelve True si cambio algo """
+        r = self.reader
+        if not r.started:
+            return False
+        if r.runs != self._runs:
+            self._reset()
+
+        changed = False
+        frames = r.snapshot_frames
+        if len(frames) != self._snapshots and len(frames) > 0:
+            last = r.snapshots_q15[-1]
+            self._lms_fp.set_ydata(r.to_float(last))
+            self._lms_int.set_ydata(last)
+            self.ax_fp.set_title("{} - trama {}".format(self._title, frames[-1]))
+            for ax in (self.ax_fp, self.ax_int):
+                ax.relim()
+                ax.autoscale_view()
+            self._snapshots = len(frames)
+            changed = True
+
+        if r.last_frame != self._frames:
+            mse = r.mse[:r.last_frame]
+            self._mse_line.set_data(np.arange(r.last_frame), mse)
+            valid = mse[np.isfinite(mse) & (mse > 0)]
+            if valid.size > 0:
+                self.ax_mse.set_ylim(valid.min() / 2, valid.max() * 2)
+            self._frames = r.last_frame
+            changed = True
+        return changed
+
+    def run(self, interval=0.2, timeout=None):
+        """
+            @brief: Lee y grafica hasta el fin de la corrida o de los datos, o hasta que pasen
+            timeout segundos sin paquetes. La figura se redibuja cada interval segundos como
+            mucho, para que dibujar no demore la lectura.
+        """
+        r = self.reader
+        last_packet = last_draw = time.monotonic()
+        while not (r.ended or r.eof):
+            now = time.monotonic()
+            if r.poll(0.02) > 0:
+                last_packet = now
+            elif timeout is not None and now - last_packet >= timeout:
+                break
+            if now - last_draw >= interval and self.update():
+                self.fig.canvas.draw_idle()
+                self._plt.pause(0.001)
+                last_draw = time.monotonic()
+        self.update()
+        self.fig.canvas.draw_idle()
+        return r.ended
+
+
+if __name__ == "__main__":
+    # Resumen de una corrida: python3 host/telemetry.py archivo|pty|puerto [baudios]
+    with TelemetryReader(sys.argv[1], int(sys.argv[2]) if len(sys.argv) > 2 else 115200) as reader:
+        reader.read_run()
+        mse = reader.mse
+        print("{} taps, {} tramas, mu {}, signal_power {}: {} tramas con MSE, {} copias, {} errores de CRC".format(
+            reader.num_taps, reader.num_frames, reader.mu, reader.signal_power, reader.frames_received,
+            len(reader.snapshot_frames), reader.crc_errors))
+        if reader.frames_received > 0:
+            print("MSE final {:.6g}".format(mse[np.isfinite(mse)][-1]))
+        for name, p in reader.profile.items():
+            print("{:8s} {:8d} mediciones, min {} max {} media {:.1f} ticks ({:.3f} us)".format(
+                name, p["count"], p["min"], p["max"], p["mean"], p["mean_us"]))
@@ -0,0 +1,524 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Decodificador de la telemetria (ver telemetry_decoder.h).
+ */
+
+#define _GNU_SOURCE
+#include "telemetry_decoder.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/* Lectura de bits del MSB al LSB. Leer pasado el final deja error en true */
+typedef struct _telemetry_bit_reader
+{
+	const uint8_t *data;
+	uint32_t size;
+	uint32_t pos;				/* En bits */
+	bool error;
+} telemetry_bit_reader_t;
+
+static uint32_t TELEMETRY_DECODER_GetBits(telemetry_bit_reader_t *bits, uint32_t n)
+{
+	uint32_t value = 0U;
+
+	if(bits->pos + n > bits->size * 8U)
+	{
+		bits->error = true;
+		return 0U;
+	}
+	for(uint32_t i = 0; i < n; i++)
+	{
+		uint32_t bit = (bits->data[bits->pos >> 3] >> (7U - (bits->pos & 7U))) & 1U;
+		value = (value << 1) | bit;
+		bits->pos++;
+	}
+	return value;
+}
+
+static inline uint16_t TELEMETRY_DECODER_U16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t TELEMETRY_DECODER_U32(const uint8_t *p)
+{
+	return (uint32_t)TELEMETRY_DECODER_U16(p) | ((uint32_t)TELEMETRY_DECODER_U16(&p[2]) << 16);
+}
+
+static inline int32_t TELEMETRY_DECODER_UnZigZag(uint32_t u)
+{
+	return (int32_t)(u >> 1) ^ -(int32_t)(u & 1U);
+}
+
+double TELEMETRY_DECODER_LogValue(uint16_t code, uint32_t fracBits)
+{
+	if(code == 0U)
+	{
+		return 0.0;
+	}
+	return exp2((double)(code - 1U) / (double)(1U << fracBits));
+}
+
+void TELEMETRY_DECODER_Init(telemetry_decoder_t *decoder)
+{
+	memset(&decoder->run, 0, sizeof(decoder->run));
+	decoder->packets = 0U;
+	decoder->crcErrors = 0U;
+	decoder->runs = 0U;
+	decoder->skippedBytes = 0U;
+	decoder->start = 0U;
+	decoder->fill = 0U;
+	decoder->eof = false;
+}
+
+void TELEMETRY_DECODER_Free(telemetry_decoder_t *decoder)
+{
+	telemetry_run_t *run = &decoder->run;
+
+	free(run->plantCoeffs);
+	free(run->mse);
+	free(run->snapshotFrames);
+	free(run->snapshotCoeffs);
+	memset(run, 0, sizeof(*run));
+}
+
+static int TELEMETRY_DECODER_Start(telemetry_decoder_t *decoder, const uint8_t *payload, uint32_t size)
+{
+	if(size < 14U)
+	{
+		return 0;
+	}
+	uint16_t numTaps = TELEMETRY_DECODER_U16(payload);
+	if(size < 14U + numTaps * 2U)
+	{
+		return 0;
+	}
+
+	TELEMETRY_DECODER_Free(decoder);
+	telemetry_run_t *run = &decoder->run;
+	run->numTaps = numTaps;
+	run->numFrames = TELEMETRY_DECODER_U32(&payload[2]);
+	run->mu = (q15_t)TELEMETRY_DECODER_U16(&payload[6]);
+	run->signalPower = (q15_t)TELEMETRY_DECODER_U16(&payload[8]);
+	run->blockSize = TELEMETRY_DECODER_U16(&payload[10]);
+	run->mseEncoding = payload[12];
+	run->logBits = payload[13];
+
+	run->plantCoeffs = malloc((numTaps + 1U) * sizeof(q15_t));
+	run->mse = malloc(((size_t)run->numFrames + 1U) * sizeof(double));
+	if((run->plantCoeffs == NULL) || (run->mse == NULL))
+	{
+		return -1;
+	}
+	for(uint32_t k = 0; k < numTaps; k++)
+	{
+		run->plantCoeffs[k] = (q15_t)TELEMETRY_DECODER_U16(&payload[14U + k * 2U]);
+	}
+	for(uint32_t i = 0; i < run->numFrames; i++)
+	{
+		run->mse[i] = NAN;
+	}
+	run->started = true;
+	decoder->runs++;
+	return 0;
+}
+
+static void TELEMETRY_DECODER_PutMse(telemetry_run_t *run, uint32_t frame, double mse)
+{
+	if(frame < run->numFrames)
+	{
+		run->framesReceived += isnan(run->mse[frame]) ? 1U : 0U;
+		run->lastFrame = (frame + 1U > run->lastFrame) ? (frame + 1U) : run->lastFrame;
+		run->mse[frame] = mse;
+	}
+}
+
+static void TELEMETRY_DECODER_Mse(telemetry_run_t *run, const uint8_t *payload, uint32_t size)
+{
+	if(!run->started || (size < 6U))
+	{
+		return;
+	}
+	uint32_t frame = TELEMETRY_DECODER_U32(payload);
+	uint32_t count = TELEMETRY_DECODER_U16(&payload[4]);
+	payload += 6;
+	size -= 6U;
+
+	if(run->mseEncoding == kTELEMETRY_MseLog)
+	{
+		telemetry_bit_reader_t bits = {payload, size, 0U, false};
+		int32_t code = 0;
+		uint32_t k = 0U;
+
+		for(uint32_t i = 0; i < count; i++)
+		{
+			if((i % TELEMETRY_RICE_GROUP) == 0U)
+			{
+				k = TELEMETRY_DECODER_GetBits(&bits, 4U);
+			}
+			uint32_t q = 0U;
+			while((q < TELEMETRY_RICE_ESCAPE) && (TELEMETRY_DECODER_GetBits(&bits, 1U) == 1U))
+			{
+				q++;
+			}
+			uint32_t u = (q < TELEMETRY_RICE_ESCAPE) ? ((q << k) | TELEMETRY_DECODER_GetBits(&bits, k))
+													 : TELEMETRY_DECODER_GetBits(&bits, 16U);
+			if(bits.error)
+			{
+				return;
+			}
+			code += TELEMETRY_DECODER_UnZigZag(u);
+			TELEMETRY_DECODER_PutMse(run, frame + i, TELEMETRY_DECODER_LogValue((uint16_t)code, run->logBits));
+		}
+	}
+	else
+	{
+		uint32_t value = 0U;
+		uint32_t pos = 0U;
+
+		for(uint32_t i = 0; i < count; i++)
+		{
+			uint32_t u = 0U;
+			for(uint32_t shift = 0U;; shift += 7U)
+			{
+				if((pos == size) || (shift > 28U))
+				{
+					return;
+				}
+				uint8_t byte = payload[pos++];
+				u |= (uint32_t)(byte & 0x7FU) << shift;
+				if((byte & 0x80U) == 0U)
+				{
+					break;
+				}
+			}
+			value += (uint32_t)TELEMETRY_DECODER_UnZigZag(u);
+			TELEMETRY_DECODER_PutMse(run, frame + i, (double)(int32_t)value);
+		}
+	}
+}
+
+static int TELEMETRY_DECODER_Coeffs(telemetry_run_t *run, const uint8_t *payload, uint32_t size)
+{
+	if(!run->started || (size < 6U) || (TELEMETRY_DECODER_U16(&payload[4]) != run->numTaps) ||
+	   (size < 6U + run->numTaps * 2U))
+	{
+		return 0;
+	}
+
+	uint32_t n = run->numSnapshots + 1U;
+	uint32_t *frames = realloc(run->snapshotFrames, n * sizeof(uint32_t));
+	if(frames == NULL)
+	{
+		return -1;
+	}
+	run->snapshotFrames = frames;
+	q15_t *coeffs = realloc(run->snapshotCoeffs, ((size_t)n * run->numTaps + 1U) * sizeof(q15_t));
+	if(coeffs == NULL)
+	{
+		return -1;
+	}
+	run->snapshotCoeffs = coeffs;
+
+	frames[run->numSnapshots] = TELEMETRY_DECODER_U32(payload);
+	for(uint32_t k = 0; k < run->numTaps; k++)
+	{
+		coeffs[(size_t)run->numSnapshots * run->numTaps + k] = (q15_t)TELEMETRY_DECODER_U16(&payload[6U + k * 2U]);
+	}
+	run->numSnapshots = n;
+	return 0;
+}
+
+static void TELEMETRY_DECODER_Profile(telemetry_run_t *run, const uint8_t *payload, uint32_t size)
+{
+	if(!run->started || (size < 9U))
+	{
+		return;
+	}
+	uint32_t numScopes = payload[8];
+	uint32_t pos = 9U;
+
+	run->numProfileScopes = 0U;
+	for(uint32_t i = 0; i < numScopes; i++)
+	{
+		if((pos >= size) || (size - pos < 1U + payload[pos] + 22U))
+		{
+			return;
+		}
+		uint32_t length = payload[pos++];
+		const uint8_t *name = &payload[pos];
+		const uint8_t *record = &payload[pos + length];
+		uint32_t first = record[20];
+		uint32_t count = record[21];
+		pos += length + 22U;
+		if((size - pos < count * 4U) || (first + count > PROF_HIST_BINS))
+		{
+			return;
+		}
+
+		if(run->numProfileScopes < TELEMETRY_DECODER_MAX_SCOPES)
+		{
+			telemetry_profile_t *profile = &run->profile[run->numProfileScopes++];
+			memset(profile, 0, sizeof(*profile));
+			length = (length < TELEMETRY_DECODER_NAME_SIZE) ? length : (TELEMETRY_DECODER_NAME_SIZE - 1U);
+			memcpy(profile->name, name, length);
+			profile->count = TELEMETRY_DECODER_U32(record);
+			profile->min = TELEMETRY_DECODER_U32(&record[4]);
+			profile->max = TELEMETRY_DECODER_U32(&record[8]);
+			profile->sum = TELEMETRY_DECODER_U32(&record[12]) | ((uint64_t)TELEMETRY_DECODER_U32(&record[16]) << 32);
+			for(uint32_t b = 0; b < count; b++)
+			{
+				profile->hist[first + b] = TELEMETRY_DECODER_U32(&payload[pos + b * 4U]);
+			}
+		}
+		pos += count * 4U;
+	}
+	run->profileTicksPerSecond = TELEMETRY_DECODER_U32(payload) | ((uint64_t)TELEMETRY_DECODER_U32(&payload[4]) << 32);
+}
+
+static int TELEMETRY_DECODER_Packet(telemetry_decoder_t *decoder, uint8_t type, const uint8_t *payload,
+									uint32_t size)
+{
+	telemetry_run_t *run = &decoder->run;
+
+	switch(type)
+	{
+		case 'S':
+			return TELEMETRY_DECODER_Start(decoder, payload, size);
+		case 'M':
+			TELEMETRY_DECODER_Mse(run, payload, size);
+			return 0;
+		case 'C':
+			return TELEMETRY_DECODER_Coeffs(run, payload, size);
+		case 'P':
+			TELEMETRY_DECODER_Profile(run, payload, size);
+			return 0;
+		case 'E':
+			if(run->started && (size >= 4U))
+			{
+				run->framesDone = TELEMETRY_DECODER_U32(payload);
+				run->ended = true;
+			}
+			return 0;
+		default:
+			return 0;
+	}
+}
+
+/* Descarta n bytes del principio de lo pendiente. Se compacta el buffer recien en
+ * TELEMETRY_DECODER_Feed() */
+static void TELEMETRY_DECODER_Drop(telemetry_decoder_t *decoder, uint32_t n)
+{
+	decoder->start += n;
+	decoder->fill -= n;
+}
+
+/* Busca un paquete al principio del buffer. Devuelve 1 si consumio bytes, 0 si faltan
+ * bytes y -1 si no hay memoria */
+static int TELEMETRY_DECODER_Parse(telemetry_decoder_t *decoder, int *packets)
+{
+	uint8_t *buffer = &decoder->buffer[decoder->start];
+
+	if(decoder->fill == 0U)
+	{
+		return 0;
+	}
+	if((buffer[0] != TELEMETRY_SYNC0) || ((decoder->fill > 1U) && (buffer[1] != TELEMETRY_SYNC1)))
+	{
+		/* Hasta el proximo inicio de sincronismo */
+		uint32_t n = 1U;
+		while((n < decoder->fill) && (buffer[n] != TELEMETRY_SYNC0))
+		{
+			n++;
+		}
+		decoder->skippedBytes += n;
+		TELEMETRY_DECODER_Drop(decoder, n);
+		return 1;
+	}
+	if(decoder->fill < TELEMETRY_HEADER_SIZE)
+	{
+		return 0;
+	}
+
+	uint32_t size = TELEMETRY_DECODER_U16(&buffer[4]);
+	uint32_t total = TELEMETRY_HEADER_SIZE + size + TELEMETRY_CRC_SIZE;
+	if(decoder->fill < total)
+	{
+		return 0;
+	}
+
+	uint16_t crc = TELEMETRY_Crc16(0xFFFFU, &buffer[2], TELEMETRY_HEADER_SIZE - 2U + size);
+	if(crc != TELEMETRY_DECODER_U16(&buffer[TELEMETRY_HEADER_SIZE + size]))
+	{
+		/* Puede que el sincronismo fuera parte de los datos: se sigue desde el byte siguiente */
+		decoder->crcErrors++;
+		decoder->skippedBytes++;
+		TELEMETRY_DECODER_Drop(decoder, 1U);
+		return 1;
+	}
+
+	if(buffer[2] == TELEMETRY_VERSION)
+	{
+		if(TELEMETRY_DECODER_Packet(decoder, buffer[3], &buffer[TELEMETRY_HEADER_SIZE], size) != 0)
+		{
+			return -1;
+		}
+		decoder->packets++;
+		(*packets)++;
+	}
+	TELEMETRY_DECODER_Drop(decoder, total);
+	return 1;
+}
+
+/* Mueve lo pendiente al principio del buffer */
+static void TELEMETRY_DECODER_Compact(telemetry_decoder_t *decoder)
+{
+	if(decoder->start > 0U)
+	{
+		memmove(decoder->buffer, &decoder->buffer[decoder->start], decoder->fill);
+		decoder->start = 0U;
+	}
+}
+
+/* Procesa todos los paquetes completos. Devuelve la cantidad o -1 si no hay memoria */
+static int TELEMETRY_DECODER_ParseAll(telemetry_decoder_t *decoder)
+{
+	int packets = 0;
+	int status;
+
+	while((status = TELEMETRY_DECODER_Parse(decoder, &packets)) > 0)
+	{
+	}
+	return (status < 0) ? -1 : packets;
+}
+
+int TELEMETRY_DECODER_Feed(telemetry_decoder_t *decoder, const uint8_t *data, size_t size)
+{
+	int packets = 0;
+
+	while(size > 0U)
+	{
+		TELEMETRY_DECODER_Compact(decoder);
+		uint32_t room = (uint32_t)sizeof(decoder->buffer) - decoder->fill;
+		uint32_t n = (size < room) ? (uint32_t)size : room;
+
+		memcpy(&decoder->buffer[decoder->fill], data, n);
+		decoder->fill += n;
+		data += n;
+		size -= n;
+
+		int status = TELEMETRY_DECODER_ParseAll(decoder);
+		if(status < 0)
+		{
+			return -1;
+		}
+		packets += status;
+	}
+	return packets;
+}
+
+int TELEMETRY_DECODER_Read(telemetry_decoder_t *decoder, int fd, int timeoutMs)
+{
+	struct pollfd pfd = {fd, POLLIN, 0};
+
+	int ready = poll(&pfd, 1, timeoutMs);
+	if(ready <= 0)
+	{
+		return ((ready == 0) || (errno == EINTR)) ? 0 : -1;
+	}
+
+	/* Se lee directamente en el buffer de armado, sin copias intermedias */
+	TELEMETRY_DECODER_Compact(decoder);
+	ssize_t n = read(fd, &decoder->buffer[decoder->fill], sizeof(decoder->buffer) - decoder->fill);
+	if(n == 0)
+	{
+		decoder->eof = true;
+		return 0;
+	}
+	if(n < 0)
+	{
+		return ((errno == EINTR) || (errno == EAGAIN)) ? 0 : -1;
+	}
+	decoder->fill += (uint32_t)n;
+	return TELEMETRY_DECODER_ParseAll(decoder);
+}
+
+static speed_t TELEMETRY_DECODER_Speed(uint32_t baudRate)
+{
+	switch(baudRate)
+	{
+		case 9600U: return B9600;
+		case 19200U: return B19200;
+		case 38400U: return B38400;
+		case 57600U: return B57600;
+		case 230400U: return B230400;
+		case 460800U: return B460800;
+		case 921600U: return B921600;
+		default: return B115200;
+	}
+}
+
+int TELEMETRY_DECODER_Open(const char *path, uint32_t baudRate)
+{
+	if(strcmp(path, "-") == 0)
+	{
+		return dup(STDIN_FILENO);
+	}
+
+	int fd = open(path, O_RDONLY | O_NOCTTY);
+	if((fd >= 0) && isatty(fd))
+	{
+		/* Puerto serie o pty: modo crudo, 8N1 */
+		struct termios tio;
+		if(tcgetattr(fd, &tio) == 0)
+		{
+			cfmakeraw(&tio);
+			tio.c_cflag |= CLOCAL | CREAD;
+			tio.c_cflag &= ~(tcflag_t)(CSTOPB | PARENB);
+			cfsetispeed(&tio, TELEMETRY_DECODER_Speed(baudRate));
+			cfsetospeed(&tio, TELEMETRY_DECODER_Speed(baudRate));
+			tcsetattr(fd, TCSANOW, &tio);
+		}
+	}
+	return fd;
+}
+
+void TELEMETRY_DECODER_Q15ToFloat(const q15_t *src, float *dst, uint32_t count)
+{
+	uint32_t i = 0U;
+
+#if defined(__AVX2__)
+	const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+	for(; i + 16U <= count; i += 16U)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i *)&src[i]);
+		__m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(x)));
+		__m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1)));
+		_mm256_storeu_ps(&dst[i], _mm256_mul_ps(lo, scale));
+		_mm256_storeu_ps(&dst[i + 8U], _mm256_mul_ps(hi, scale));
+	}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	for(; i + 8U <= count; i += 8U)
+	{
+		int16x8_t x = vld1q_s16(&src[i]);
+		vst1q_f32(&dst[i], vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(x)), 15));
+		vst1q_f32(&dst[i + 4U], vcvtq_n_f32_s32(vmovl_s16(vget_high_s16(x)), 15));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		dst[i] = (float)src[i] * (1.0f / 32768.0f);
+	}
+}
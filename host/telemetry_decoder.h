@@ -0,0 +1,121 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Decodificador en el host de la telemetria del firmware (formato en
+	source/telemetry.h). Los bytes se entregan a medida que llegan (de la UART, un
+	archivo o un pipe) con TELEMETRY_DECODER_Feed(), que arma los paquetes, verifica el
+	CRC y guarda los datos de la corrida en curso. Los paquetes con CRC incorrecto se
+	descartan y se vuelve a buscar el sincronismo. TELEMETRY_DECODER_Read() lee de un
+	puerto serie, pty, FIFO o archivo directamente en el buffer del decodificador.
+
+	Los arreglos de la corrida se pueden leer mientras llegan datos (host/telemetry.py
+	los expone como arreglos de numpy sin copiarlos): lastFrame indica hasta donde hay
+	MSE y runs cambia cuando empieza otra corrida, que reserva arreglos nuevos.
+
+	Las tramas cuyo MSE no llego quedan en NAN. Con kTELEMETRY_MseLog el MSE es el centro
+	del intervalo del codigo (2^((c - 1) / 2^R)).
+ */
+
+#ifndef TELEMETRY_DECODER_H_
+#define TELEMETRY_DECODER_H_
+
+#include "telemetry.h"
+#include "prof.h"
+#include <stddef.h>
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+/* Contenido mas largo que se acepta (65535 del campo de largo) */
+#define TELEMETRY_DECODER_MAX_PAYLOAD (65535U)
+
+/* Etapas del paquete 'P' que se guardan */
+#define TELEMETRY_DECODER_MAX_SCOPES (16U)
+#define TELEMETRY_DECODER_NAME_SIZE (16U)
+
+/* Ciclos de una etapa (prof_stats_t del firmware) */
+typedef struct _telemetry_profile
+{
+	char name[TELEMETRY_DECODER_NAME_SIZE];
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t hist[PROF_HIST_BINS];
+} telemetry_profile_t;
+
+/* Datos de una corrida. Los arreglos los reserva el decodificador */
+typedef struct _telemetry_run
+{
+	uint16_t numTaps;
+	uint32_t numFrames;
+	q15_t mu;
+	q15_t signalPower;
+	uint16_t blockSize;
+	uint8_t mseEncoding;		/* telemetry_mse_encoding_t */
+	uint8_t logBits;
+	q15_t *plantCoeffs;			/* numTaps */
+	double *mse;				/* numFrames, NAN si no llego */
+	uint32_t numSnapshots;
+	uint32_t *snapshotFrames;	/* numSnapshots */
+	q15_t *snapshotCoeffs;		/* numSnapshots * numTaps */
+	bool started;				/* Llego el paquete 'S' */
+	bool ended;					/* Llego el paquete 'E' */
+	uint32_t framesDone;		/* Del paquete 'E' */
+	uint32_t framesReceived;	/* Tramas con MSE */
+	uint32_t lastFrame;			/* Ultima trama con MSE + 1 */
+	uint64_t profileTicksPerSecond;	/* Del paquete 'P', 0 si no llego */
+	uint32_t numProfileScopes;
+	telemetry_profile_t profile[TELEMETRY_DECODER_MAX_SCOPES];
+} telemetry_run_t;
+
+typedef struct _telemetry_decoder
+{
+	telemetry_run_t run;
+	uint32_t runs;				/* Paquetes 'S' recibidos */
+	uint32_t packets;			/* Paquetes validos */
+	uint32_t crcErrors;
+	uint32_t skippedBytes;		/* Descartados buscando el sincronismo */
+	uint32_t start;				/* Primer byte pendiente del buffer */
+	uint32_t fill;				/* Bytes pendientes */
+	bool eof;					/* read() devolvio 0 */
+	uint8_t buffer[TELEMETRY_HEADER_SIZE + TELEMETRY_DECODER_MAX_PAYLOAD + TELEMETRY_CRC_SIZE];
+} telemetry_decoder_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void TELEMETRY_DECODER_Init(telemetry_decoder_t *decoder);
+
+/* Procesa size bytes. Devuelve la cantidad de paquetes validos encontrados o -1 si no
+ * hay memoria. Un paquete 'S' reemplaza la corrida anterior */
+int TELEMETRY_DECODER_Feed(telemetry_decoder_t *decoder, const uint8_t *data, size_t size);
+
+/* Espera hasta timeoutMs (-1 = sin limite) a que haya datos en fd y procesa lo que se
+ * pueda leer de una vez. Devuelve la cantidad de paquetes validos (0 si no llego nada o
+ * se llego al final, ver eof) o -1 si hubo un error */
+int TELEMETRY_DECODER_Read(telemetry_decoder_t *decoder, int fd, int timeoutMs);
+
+/* Abre path para lectura ("-" es stdin). Si es un puerto serie o pty lo configura en
+ * modo crudo 8N1 a baudRate. Devuelve el descriptor o -1 */
+int TELEMETRY_DECODER_Open(const char *path, uint32_t baudRate);
+
+/* Convierte count valores q15 a float en [-1, 1) (AVX2 o NEON si estan disponibles) */
+void TELEMETRY_DECODER_Q15ToFloat(const q15_t *src, float *dst, uint32_t count);
+
+/* Libera los arreglos de la corrida */
+void TELEMETRY_DECODER_Free(telemetry_decoder_t *decoder);
+
+/* MSE aproximado de un codigo de kTELEMETRY_MseLog */
+double TELEMETRY_DECODER_LogValue(uint16_t code, uint32_t fracBits);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* TELEMETRY_DECODER_H_ */
@@ -0,0 +1,126 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Lee la telemetria del firmware o de ident_host -T (formato en source/telemetry.h)
+	desde un archivo, un pseudo terminal o stdin ("-") y la imprime como texto.
+
+	Uso:
+		telemetry_dump [-c] [archivo]
+
+	Por stdout se imprime, por cada trama, "<trama> <mse>" (nan si no llego) y un resumen
+	con los datos de la corrida, los paquetes recibidos y los errores de CRC. Con -c se
+	imprimen ademas las copias de los coeficientes. Si llego el paquete 'P' se imprimen los
+	ciclos de cada etapa (minimo, media, maximo e histograma).
+ */
+
+#include "telemetry_decoder.h"
+#include <stdio.h>
+#include <string.h>
+
+static telemetry_decoder_t s_decoder;
+
+int main(int argc, char *argv[])
+{
+	const char *path = "-";
+	int coeffs = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-c") == 0)
+		{
+			coeffs = 1;
+		}
+		else if((argv[i][0] != '-') || (argv[i][1] == '\0'))
+		{
+			path = argv[i];
+		}
+		else
+		{
+			fprintf(stderr, "Uso: %s [-c] [archivo]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	FILE *file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+	if(file == NULL)
+	{
+		fprintf(stderr, "No se pudo abrir %s\n", path);
+		return 1;
+	}
+
+	/* Se lee hasta el fin de archivo o hasta el paquete de fin de corrida */
+	TELEMETRY_DECODER_Init(&s_decoder);
+	uint64_t bytes = 0U;
+	uint8_t chunk[4096];
+	size_t n;
+	while(!s_decoder.run.ended && ((n = fread(chunk, 1, sizeof(chunk), file)) > 0U))
+	{
+		bytes += n;
+		if(TELEMETRY_DECODER_Feed(&s_decoder, chunk, n) < 0)
+		{
+			fprintf(stderr, "Sin memoria\n");
+			return 1;
+		}
+	}
+	if(file != stdin)
+	{
+		fclose(file);
+	}
+
+	const telemetry_run_t *run = &s_decoder.run;
+	if(!run->started)
+	{
+		fprintf(stderr, "No se encontro el inicio de una corrida\n");
+		return 1;
+	}
+
+	uint32_t received = 0U;
+	for(uint32_t i = 0; i < run->numFrames; i++)
+	{
+		printf("%u %.10g\n", i, run->mse[i]);
+		received += (run->mse[i] == run->mse[i]) ? 1U : 0U;
+	}
+	if(coeffs)
+	{
+		for(uint32_t s = 0; s < run->numSnapshots; s++)
+		{
+			printf("# coeficientes trama %u:", run->snapshotFrames[s]);
+			for(uint32_t k = 0; k < run->numTaps; k++)
+			{
+				printf(" %d", run->snapshotCoeffs[(size_t)s * run->numTaps + k]);
+			}
+			printf("\n");
+		}
+	}
+
+	printf("# %u taps, %u tramas de %u muestras, mu %d, signal_power %d, MSE %s\n", run->numTaps,
+		   run->numFrames, run->blockSize, run->mu, run->signalPower,
+		   (run->mseEncoding == kTELEMETRY_MseLog) ? "logaritmico" : "sin perdidas");
+	printf("# %llu bytes, %u paquetes, %u tramas con MSE, %u copias de coeficientes, %u errores de CRC, "
+		   "%u bytes descartados%s\n",
+		   (unsigned long long)bytes, s_decoder.packets, received, run->numSnapshots, s_decoder.crcErrors,
+		   s_decoder.skippedBytes, run->ended ? "" : ", sin fin de corrida");
+
+	/* Ciclos por etapa, si la corrida los envio */
+	for(uint32_t i = 0; i < run->numProfileScopes; i++)
+	{
+		const telemetry_profile_t *p = &run->profile[i];
+		double mean = (p->count > 0U) ? (double)p->sum / p->count : 0.0;
+		printf("# %-8s %10u mediciones, min %u max %u media %.1f ticks", p->name, p->count, p->min, p->max, mean);
+		if(run->profileTicksPerSecond > 0U)
+		{
+			printf(" (%.3f us)", mean * 1e6 / run->profileTicksPerSecond);
+		}
+		printf(", histograma");
+		for(uint32_t b = 0; b < PROF_HIST_BINS; b++)
+		{
+			if(p->hist[b] > 0U)
+			{
+				printf(" <2^%u:%u", b, p->hist[b]);
+			}
+		}
+		printf("\n");
+	}
+
+	TELEMETRY_DECODER_Free(&s_decoder);
+	return 0;
+}
@@ -0,0 +1,221 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Transmision no bloqueante con un hilo de escritura (ver uart_pipe.h).
+	Se escribe de a UART_PIPE_CHUNK bytes y se espera lo que tardaria la UART en
+	sacarlos, con tiempos absolutos para que el error no se acumule.
+ */
+
+#define _GNU_SOURCE
+#include "uart_pipe.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Bytes que se escriben de una vez (tamaño de la FIFO de TX del K64F: 8) */
+#define UART_PIPE_CHUNK (8U)
+
+static void UART_PIPE_AddNs(struct timespec *t, uint64_t ns)
+{
+	ns += (uint64_t)t->tv_nsec;
+	t->tv_sec += (time_t)(ns / 1000000000U);
+	t->tv_nsec = (long)(ns % 1000000000U);
+}
+
+static void UART_PIPE_Write(uart_pipe_t *pipe, const uint8_t *data, size_t size)
+{
+	while(size > 0U)
+	{
+		ssize_t n = write(pipe->fd, data, size);
+		if(n < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			/* Sin lector (pty lleno) o destino cerrado: se descarta, como en una UART
+			 * sin nada conectado */
+			return;
+		}
+		data += n;
+		size -= (size_t)n;
+	}
+}
+
+static void *UART_PIPE_Thread(void *param)
+{
+	uart_pipe_t *pipe = (uart_pipe_t *)param;
+
+	pthread_mutex_lock(&pipe->lock);
+	for(;;)
+	{
+		while(!pipe->busy && !pipe->stop)
+		{
+			pthread_cond_wait(&pipe->cond, &pipe->lock);
+		}
+		if(!pipe->busy)
+		{
+			break;
+		}
+		const uint8_t *data = pipe->data;
+		size_t size = pipe->size;
+		pthread_mutex_unlock(&pipe->lock);
+
+		struct timespec next;
+		clock_gettime(CLOCK_MONOTONIC, &next);
+		for(size_t offset = 0; offset < size; offset += UART_PIPE_CHUNK)
+		{
+			size_t n = ((size - offset) < UART_PIPE_CHUNK) ? (size - offset) : UART_PIPE_CHUNK;
+			UART_PIPE_Write(pipe, &data[offset], n);
+			if(pipe->baudRate != 0U)
+			{
+				/* 1 bit de start, 8 de datos y 1 de stop */
+				UART_PIPE_AddNs(&next, (uint64_t)n * 10U * 1000000000U / pipe->baudRate);
+				while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+				{
+				}
+			}
+		}
+
+		pthread_mutex_lock(&pipe->lock);
+		pipe->bytesSent += size;
+		pipe->busy = false;
+		pthread_cond_broadcast(&pipe->cond);
+		pthread_mutex_unlock(&pipe->lock);
+
+		/* Como la interrupcion de fin de transmision: puede iniciar el proximo envio */
+		if(pipe->callback != NULL)
+		{
+			pipe->callback(pipe->userData);
+		}
+		pthread_mutex_lock(&pipe->lock);
+	}
+	pthread_mutex_unlock(&pipe->lock);
+	return NULL;
+}
+
+static int UART_PIPE_OpenPty(uart_pipe_t *pipe)
+{
+	int fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if((fd < 0) || (grantpt(fd) != 0) || (unlockpt(fd) != 0))
+	{
+		return -1;
+	}
+
+	/* Modo crudo del lado esclavo, para que no se traduzcan los bytes */
+	const char *name = ptsname(fd);
+	int slave = (name != NULL) ? open(name, O_RDWR | O_NOCTTY) : -1;
+	if(slave < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	struct termios tio;
+	tcgetattr(slave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slave, TCSANOW, &tio);
+
+	/* Sin lector el pty se llena: se escribe sin bloquear y se descarta lo que no entra */
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	fprintf(stderr, "UART en %s\n", name);
+	pipe->fd = fd;
+	pipe->slaveFd = slave;
+	return 0;
+}
+
+int UART_PIPE_Open(uart_pipe_t *pipe, const char *path, uint32_t baudRate, uart_pipe_callback_t callback,
+				   void *userData)
+{
+	pipe->slaveFd = -1;
+	if(strcmp(path, "pty") == 0)
+	{
+		if(UART_PIPE_OpenPty(pipe) != 0)
+		{
+			return -1;
+		}
+	}
+	else if(strcmp(path, "-") == 0)
+	{
+		pipe->fd = dup(STDOUT_FILENO);
+	}
+	else
+	{
+		pipe->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	}
+	if(pipe->fd < 0)
+	{
+		return -1;
+	}
+
+	pipe->baudRate = baudRate;
+	pipe->callback = callback;
+	pipe->userData = userData;
+	pipe->data = NULL;
+	pipe->size = 0U;
+	pipe->busy = false;
+	pipe->stop = false;
+	pipe->bytesSent = 0U;
+	pthread_mutex_init(&pipe->lock, NULL);
+	pthread_cond_init(&pipe->cond, NULL);
+
+	if(pthread_create(&pipe->thread, NULL, UART_PIPE_Thread, pipe) != 0)
+	{
+		close(pipe->fd);
+		return -1;
+	}
+	return 0;
+}
+
+int UART_PIPE_SendNonBlocking(uart_pipe_t *pipe, const uint8_t *data, size_t size)
+{
+	int status = 0;
+
+	pthread_mutex_lock(&pipe->lock);
+	if(pipe->busy)
+	{
+		status = -1;
+	}
+	else
+	{
+		pipe->data = data;
+		pipe->size = size;
+		pipe->busy = true;
+		pthread_cond_broadcast(&pipe->cond);
+	}
+	pthread_mutex_unlock(&pipe->lock);
+	return status;
+}
+
+bool UART_PIPE_IsBusy(uart_pipe_t *pipe)
+{
+	pthread_mutex_lock(&pipe->lock);
+	bool busy = pipe->busy;
+	pthread_mutex_unlock(&pipe->lock);
+	return busy;
+}
+
+void UART_PIPE_Close(uart_pipe_t *pipe)
+{
+	pthread_mutex_lock(&pipe->lock);
+	while(pipe->busy)
+	{
+		pthread_cond_wait(&pipe->cond, &pipe->lock);
+	}
+	pipe->stop = true;
+	pthread_cond_broadcast(&pipe->cond);
+	pthread_mutex_unlock(&pipe->lock);
+
+	pthread_join(pipe->thread, NULL);
+	pthread_mutex_destroy(&pipe->lock);
+	pthread_cond_destroy(&pipe->cond);
+	close(pipe->fd);
+	if(pipe->slaveFd >= 0)
+	{
+		close(pipe->slaveFd);
+	}
+}
@@ -0,0 +1,62 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Reemplazo en el host de la transmision no bloqueante de la UART
+	(UART_TransferSendNonBlocking de drivers/fsl_uart.c). Un hilo escribe los datos en
+	un pseudo terminal, un FIFO, un archivo o stdout, al ritmo de la velocidad de la
+	UART (10 bits por byte), y al terminar llama al callback como lo haria la
+	interrupcion de la UART con kStatus_UART_TxIdle. Sirve para probar en Linux que la
+	transmision se superpone con el calculo de las tramas.
+ */
+
+#ifndef UART_PIPE_H_
+#define UART_PIPE_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Se llama desde el hilo de transmision al terminar cada envio */
+typedef void (*uart_pipe_callback_t)(void *userData);
+
+typedef struct _uart_pipe
+{
+	int fd;
+	int slaveFd;				/* Lado esclavo del pty (se mantiene abierto), o -1 */
+	uint32_t baudRate;			/* 0 = sin limite de velocidad */
+	uart_pipe_callback_t callback;
+	void *userData;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	const uint8_t *data;		/* Envio en curso */
+	size_t size;
+	bool busy;
+	bool stop;
+	uint64_t bytesSent;
+} uart_pipe_t;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* path: "pty" crea un pseudo terminal (el nombre del esclavo se imprime por stderr),
+ * "-" usa stdout y cualquier otro valor se abre como archivo o FIFO.
+ * Devuelve 0 o -1 si no se pudo abrir */
+int UART_PIPE_Open(uart_pipe_t *pipe, const char *path, uint32_t baudRate, uart_pipe_callback_t callback,
+				   void *userData);
+
+/* Inicia el envio de size bytes. data no debe cambiar hasta el callback.
+ * Devuelve -1 si hay un envio en curso (como kStatus_UART_TxBusy) */
+int UART_PIPE_SendNonBlocking(uart_pipe_t *pipe, const uint8_t *data, size_t size);
+
+bool UART_PIPE_IsBusy(uart_pipe_t *pipe);
+
+/* Espera a que termine el envio en curso, detiene el hilo y cierra el destino */
+void UART_PIPE_Close(uart_pipe_t *pipe);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* UART_PIPE_H_ */
@@ -0,0 +1,153 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Pool de hilos con robo de rangos (ver work_pool.h).
+	Cada rango se guarda como (fin << 32) | inicio. El dueño toma el indice inicio y
+	los ladrones se llevan [medio, fin); ambos con compare-and-swap. Un rango no vacio
+	nunca vuelve a tener el mismo valor (su primer indice sigue pendiente y el rango
+	solo se achica), por lo que no hay problema ABA.
+ */
+
+#include "work_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Cada worker en su propia linea de cache, para que los pops no se invaliden entre hilos */
+typedef struct _pool_worker
+{
+	_Alignas(64) _Atomic uint64_t range;
+	pthread_t thread;
+	uint32_t id;
+	struct _pool *pool;
+} pool_worker_t;
+
+typedef struct _pool
+{
+	pool_worker_t *workers;
+	uint32_t numWorkers;
+	pool_job_t job;
+	void *arg;
+} pool_t;
+
+static inline uint64_t POOL_Pack(uint32_t begin, uint32_t end)
+{
+	return ((uint64_t)end << 32) | begin;
+}
+
+/* Toma el proximo indice del rango propio */
+static int POOL_Pop(pool_worker_t *self, uint32_t *index)
+{
+	uint64_t r = atomic_load(&self->range);
+	for(;;)
+	{
+		uint32_t begin = (uint32_t)r;
+		uint32_t end = (uint32_t)(r >> 32);
+		if(begin >= end)
+		{
+			return 0;
+		}
+		if(atomic_compare_exchange_weak(&self->range, &r, POOL_Pack(begin + 1U, end)))
+		{
+			*index = begin;
+			return 1;
+		}
+	}
+}
+
+/* Roba la mitad final del rango de otro hilo. Se queda con el primer indice robado
+ * y guarda el resto como rango propio (que estaba vacio) */
+static int POOL_Steal(pool_worker_t *self, uint32_t *index)
+{
+	pool_t *pool = self->pool;
+
+	for(uint32_t k = 1U; k < pool->numWorkers; k++)
+	{
+		pool_worker_t *victim = &pool->workers[(self->id + k) % pool->numWorkers];
+		uint64_t r = atomic_load(&victim->range);
+		for(;;)
+		{
+			uint32_t begin = (uint32_t)r;
+			uint32_t end = (uint32_t)(r >> 32);
+			if(begin >= end)
+			{
+				break;
+			}
+			uint32_t mid = begin + (end - begin) / 2U;
+			if(atomic_compare_exchange_weak(&victim->range, &r, POOL_Pack(begin, mid)))
+			{
+				atomic_store(&self->range, POOL_Pack(mid + 1U, end));
+				*index = mid;
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+static void *POOL_Worker(void *param)
+{
+	pool_worker_t *self = (pool_worker_t *)param;
+	uint32_t index;
+
+	while(POOL_Pop(self, &index) || POOL_Steal(self, &index))
+	{
+		self->pool->job(index, self->id, self->pool->arg);
+	}
+	return NULL;
+}
+
+uint32_t POOL_GetNumCpus(void)
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? (uint32_t)n : 1U;
+}
+
+int POOL_Run(uint32_t numJobs, uint32_t numWorkers, pool_job_t job, void *arg)
+{
+	pool_t pool;
+
+	if(numWorkers == 0U)
+	{
+		numWorkers = 1U;
+	}
+
+	pool.workers = (pool_worker_t *)aligned_alloc(64U, numWorkers * sizeof(pool_worker_t));
+	if(pool.workers == NULL)
+	{
+		return -1;
+	}
+	pool.numWorkers = numWorkers;
+	pool.job = job;
+	pool.arg = arg;
+
+	/* Reparto inicial en rangos contiguos */
+	for(uint32_t w = 0; w < numWorkers; w++)
+	{
+		uint32_t begin = (uint32_t)(((uint64_t)numJobs * w) / numWorkers);
+		uint32_t end = (uint32_t)(((uint64_t)numJobs * (w + 1U)) / numWorkers);
+		atomic_init(&pool.workers[w].range, POOL_Pack(begin, end));
+		pool.workers[w].id = w;
+		pool.workers[w].pool = &pool;
+	}
+
+	/* El hilo que llama trabaja como worker 0 */
+	uint32_t started = 1U;
+	for(; started < numWorkers; started++)
+	{
+		if(pthread_create(&pool.workers[started].thread, NULL, POOL_Worker, &pool.workers[started]) != 0)
+		{
+			/* Los rangos de los hilos que no arrancaron los roban los demas */
+			break;
+		}
+	}
+	POOL_Worker(&pool.workers[0]);
+
+	for(uint32_t w = 1U; w < started; w++)
+	{
+		pthread_join(pool.workers[w].thread, NULL);
+	}
+
+	free(pool.workers);
+	return 0;
+}
@@ -0,0 +1,37 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Pool de hilos con robo de trabajo para correr muchos trabajos independientes
+	(por ejemplo, un barrido de parametros de identificacion) en todos los nucleos.
+
+	Los trabajos se identifican por un indice de 0 a numJobs - 1. Al empezar, cada
+	hilo recibe un rango contiguo de indices y los toma de a uno desde el principio.
+	Cuando su rango se vacia roba la mitad final del rango de otro hilo, de modo que
+	los trabajos largos (plantas o tramas grandes) no dejan hilos ociosos al final.
+	Cada rango es un entero atomico de 64 bits (inicio y fin), sin mutex.
+ */
+
+#ifndef WORK_POOL_H_
+#define WORK_POOL_H_
+
+#include <stdint.h>
+
+/* Funcion que ejecuta el trabajo index. worker (0 a numWorkers - 1) identifica al hilo,
+ * para que cada hilo use sus propios buffers */
+typedef void (*pool_job_t)(uint32_t index, uint32_t worker, void *arg);
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Cantidad de nucleos disponibles */
+uint32_t POOL_GetNumCpus(void);
+
+/* Ejecuta los numJobs trabajos en numWorkers hilos (el que llama es uno de ellos) y
+ * vuelve cuando terminaron todos. Devuelve -1 si no hay memoria para los hilos */
+int POOL_Run(uint32_t numJobs, uint32_t numWorkers, pool_job_t job, void *arg);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* WORK_POOL_H_ */
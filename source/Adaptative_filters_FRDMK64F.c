@@ -17,8 +17,9 @@
 	Analizar el resultado con diferentes valores de μ y de la potencia de la señal random de entrada.
     @brief:
     El programa primero inicializa las funciones de los filtros.
-	Luego, crea un arreglo de 100 muestras aleatorias utilizando la función de C rand() la cual se acota
-	a valores entre [-1, 1]. Al finalizar esta operación se lo castea a punto fijo al resultado.
+	Luego, crea un arreglo de 100 muestras aleatorias con un generador xoshiro128+ por bloques (prng.h, en
+	reemplazo de la función de C rand()) la cual se acota a valores entre [-1, 1]. Al finalizar esta
+	operación se lo castea a punto fijo al resultado.
 	Finalmente, se computa la planta (filtro FIR) con las entradas aleatorias y luego con la salida de la
 	planta, las entradas aleatorias y el error (diferencia entre la referencia y la salida anterior) se computa
 	la salida actual del filtro adaptativo. Este proceso se repite NUMFRAMES cantidad de veces, en este caso se
@@ -38,16 +39,404 @@
 #include "pin_mux.h"
 #include "clock_config.h"
 #include "fsl_debug_console.h"
+#include "ident.h"
+#include "ident_ckpt.h"
+#include "conv_detect.h"
+#include "adc_stream.h"
+#include "mem_plan.h"
+#include "fsl_adc16.h"
+#include "telemetry.h"
+#include "prof.h"
 
 #define NUMTAPS (uint16_t) 30
 #define BLOCKSIZE (uint32_t) 100
 #define POSTSHIFT (uint32_t) 0
 #define NUMFRAMES (uint16_t) 5000
 
+/* Algoritmo de adaptacion: kIDENT_AlgLms (arm_lms_q15) o kIDENT_AlgBlockLms (LMS por
+ * bloques, una actualizacion cada SUBBLOCKSIZE muestras). kIDENT_AlgFdaf, kIDENT_AlgAuto,
+ * kIDENT_AlgRls/kIDENT_AlgRlsQ31 y kIDENT_AlgApa requieren ademas un buffer de trabajo
+ * (ver ident.h) */
+#define ALGORITHM kIDENT_AlgLms
+#define SUBBLOCKSIZE (uint32_t) 0
+
+/* Regla de actualizacion del LMS (lms_rule.h): kLMS_RULE_Standard (arm_lms_q15),
+ * kLMS_RULE_Leaky (con fuga LMS_LEAK por trama), kLMS_RULE_SignError, kLMS_RULE_SignData
+ * o kLMS_RULE_SignSign. Con las reglas de signo el mu de los pulsadores da pasos mucho
+ * mayores (ver lms_rule.h) */
+#define LMS_RULE kLMS_RULE_Standard
+#define LMS_LEAK (q15_t) 1
+
+/* Paso variable (vss.h): con 1 mu se adapta en cada trama a partir del MSE, y el mu
+ * elegido con SW3 es solo el valor inicial */
+#define VARIABLE_MU 0
+
+/* Modo de envio de resultados:
+ * 0: al terminar la corrida se envian los coeficientes y el MSE de las NUMFRAMES tramas
+ *    (trama original, sin cabecera).
+ * 1: telemetria por trama (ver telemetry.h), la que lee plot_serial.ipynb. El MSE, sin saturar, se envia en paquetes
+ *    con CRC de TELEMETRY_MSE_BLOCK tramas y cada COEFF_SNAPSHOT_FRAMES tramas (0 = nunca)
+ *    una copia de los coeficientes. La memoria usada no depende de NUMFRAMES. Con
+ *    TELEMETRY_MSE_ENCODING kTELEMETRY_MseLog cada MSE ocupa en promedio de 2 a 9 bits (en
+ *    lugar de 16) con un error menor al 9 %; con kTELEMETRY_MseDelta se envia exacto.
+ */
+#define TELEMETRY_STREAMING 1
+#define COEFF_SNAPSHOT_FRAMES (uint32_t) 100
+#define TELEMETRY_MSE_ENCODING kTELEMETRY_MseLog
+
+/* Deteccion de convergencia (conv_detect.h): con EARLY_STOP en 1 y telemetria por trama,
+ * la corrida termina en la trama en que el MSE llega a su piso, se envia una ultima copia
+ * de los coeficientes y el paquete 'E' informa cuantas tramas se procesaron. En el modo 0
+ * la trama de salida tiene siempre NUMFRAMES valores y la corrida se hace completa */
+#define EARLY_STOP 1
+
+/* Arranque en caliente: con 1, cada reinicio sigue desde el ultimo checkpoint
+ * (ident_ckpt.h) en lugar de poner los coeficientes en cero. El checkpoint se reemplaza al
+ * final de cada corrida en la que se detecto la convergencia. Queda en RAM; el bloque es
+ * autocontenido (con CRC) para poder grabarlo en flash sin cambios.
+ * Con 0 (por defecto) cada pulsacion de SW2/SW3 muestra la convergencia desde cero con el
+ * nuevo mu o la nueva potencia, que es lo que se quiere ver con los pulsadores */
+#define WARM_START 0
+
+/* Entrada de la planta: con ADC_INPUT en 0 se genera en cada trama (prng.h). Con 1 se
+ * adquiere por bloques de BLOCKSIZE muestras con doble buffer (adc_stream.h): el canal 0
+ * del PIT dispara el ADC0 a ADC_SAMPLE_RATE muestras por segundo y la interrupcion de fin
+ * de conversion llena un bloque mientras se procesa el otro. Con ADC_CHANNELS en 2 el
+ * ADC1, disparado por el mismo PIT, mide la salida de la planta real y se identifica esa
+ * planta; con 1 la salida se calcula con la planta de ident.c. La muestra de 16 bits sin
+ * signo se centra y se desplaza ADC_SHIFT bits (con 5 queda en 11 bits, como la señal
+ * generada); signal_power no se usa. Los bloques descartados porque el procesamiento no
+ * llego a tiempo se cuentan en adc_stream.stats */
+#define ADC_INPUT 0
+#define ADC_SAMPLE_RATE (uint32_t) 10000
+#define ADC_CHANNELS 1
+#define ADC_SHIFT 5
+#define ADC0_INPUT_CHANNEL (uint32_t) 12	/* ADC0_SE12, PTB2 (J4[2]), analogico desde el reset */
+#define ADC1_OUTPUT_CHANNEL (uint32_t) 0	/* ADC1_DP0 (J2[11]) */
+
+/* Plan de memoria (mem_plan.h): todos los buffers son estaticos y main() no usa la pila
+ * para datos. Los coeficientes y las lineas de retardo (ident) y el detector de
+ * convergencia van en SRAM_L, por el bus de codigo; los bloques de entrada y salida de
+ * cada trama (ident_io y los bloques del ADC), los buffers de salida, que lee la
+ * interrupcion de la UART, y el checkpoint van en SRAM_U, por el bus de sistema, donde
+ * esta tambien la pila. Asi en arm_fir_q15/arm_lms_q15 los accesos a coeficientes y
+ * estado y los accesos a las muestras van por buses distintos, y la interrupcion del ADC
+ * que llena un bloque no compite con el filtro por SRAM_L. Con MEM_MAP_REPORT en 1 se imprime el mapa al arrancar, antes de la
+ * telemetria (el receptor descarta lo que no empieza con 0xA5 0x5A); en el modo 0 no se
+ * imprime para no desplazar la trama de salida */
+#define MEM_MAP_REPORT TELEMETRY_STREAMING
+
+/* Con 1, al arrancar se miden con el DWT los ciclos por trama del motor con los bloques
+ * de entrada y salida en SRAM_L (en el mismo bus que los coeficientes, como antes del
+ * plan) y en SRAM_U, y se imprimen por la consola de depuracion. Solo con
+ * TELEMETRY_STREAMING en 1, por el mismo motivo que MEM_MAP_REPORT */
+#define PLACEMENT_BENCH 0
+#define PLACEMENT_BENCH_FRAMES (uint32_t) 200
+
+/* Trama de salida del modo 0: coeficientes de los dos filtros y MSE de cada trama */
+#define DUMP_BUFFER_SIZE (NUMTAPS*4 + NUMFRAMES*2)
+
 volatile q15_t mu = 1;
 volatile q15_t signal_power = 1;	/* Amplitud de la señal de entrada */
 volatile bool restart = false;
 
+/* SRAM_L: coeficientes y lineas de retardo */
+static ident_handle_t ident MEM_PLAN_SRAM_L;
+static conv_detect_instance_t conv_detect MEM_PLAN_SRAM_L;
+
+#if PLACEMENT_BENCH
+/* Bloques de entrada y salida en el bus de los coeficientes, solo para la medicion */
+static ident_io_t bench_io MEM_PLAN_SRAM_L;
+#endif
+
+/* SRAM_U: bloques de entrada y salida de la trama */
+static ident_io_t ident_io MEM_PLAN_SRAM_U;
+
+#if ADC_INPUT
+static adc_stream_handle_t adc_stream MEM_PLAN_SRAM_U;
+#endif
+
+/* SRAM_U: salida y checkpoint.
+ * Transmision por UART0 con interrupciones (UART_TransferSendNonBlocking), para que el
+ * envio de resultados se superponga con el calculo de las tramas siguientes */
+static uart_handle_t uart_handle MEM_PLAN_SRAM_U;
+static volatile bool uart_tx_busy = false;
+
+#if TELEMETRY_STREAMING
+static telemetry_handle_t telemetry MEM_PLAN_SRAM_U;
+#else
+/* Se sigue transmitiendo despues de terminar la corrida, mientras se espera el pulsador y
+ * durante la corrida siguiente, por lo que cada corrida usa un buffer distinto */
+static uint8_t dump_buffer[2][DUMP_BUFFER_SIZE] MEM_PLAN_SRAM_U;
+#endif
+
+#if WARM_START
+static uint8_t checkpoint[IDENT_CKPT_MAX_SIZE] MEM_PLAN_SRAM_U;
+static uint32_t checkpoint_size = 0;
+#endif
+
+/* Tamaño de los buffers del plan en cada region, conocido al compilar */
+#define MEM_BENCH_BYTES (PLACEMENT_BENCH ? sizeof(ident_io_t) : 0U)
+#define MEM_SRAM_L_BYTES (sizeof(ident_handle_t) + sizeof(conv_detect_instance_t) + MEM_BENCH_BYTES)
+#define MEM_ADC_BYTES (ADC_INPUT ? sizeof(adc_stream_handle_t) : 0U)
+#define MEM_OUTPUT_BYTES (TELEMETRY_STREAMING ? sizeof(telemetry_handle_t) : (2U * DUMP_BUFFER_SIZE))
+#define MEM_CKPT_BYTES (WARM_START ? IDENT_CKPT_MAX_SIZE : 0U)
+#define MEM_SRAM_U_BYTES (sizeof(ident_io_t) + MEM_ADC_BYTES + sizeof(uart_handle_t) + MEM_OUTPUT_BYTES + MEM_CKPT_BYTES)
+
+_Static_assert((NUMTAPS <= IDENT_MAX_TAPS) && (BLOCKSIZE <= IDENT_MAX_BLOCKSIZE) &&
+			   (BLOCKSIZE <= ADC_STREAM_MAX_BLOCKSIZE), "NUMTAPS o BLOCKSIZE superan los maximos de ident.h");
+_Static_assert(MEM_SRAM_L_BYTES <= MEM_PLAN_SRAM_L_SIZE, "El plan no entra en SRAM_L");
+_Static_assert(MEM_SRAM_U_BYTES <= MEM_PLAN_SRAM_U_SIZE, "El plan no entra en SRAM_U");
+_Static_assert(!PLACEMENT_BENCH || TELEMETRY_STREAMING, "PLACEMENT_BENCH requiere TELEMETRY_STREAMING");
+
+/* Fin de transmision (contexto de interrupcion) */
+static void UartTxCallback(UART_Type *base, uart_handle_t *handle, status_t status, void *userData)
+{
+	(void)base;
+	(void)handle;
+	(void)userData;
+
+	if(status == kStatus_UART_TxIdle)
+	{
+		uart_tx_busy = false;
+#if TELEMETRY_STREAMING
+		TELEMETRY_TxDone(&telemetry);
+#endif
+	}
+}
+
+/* Inicia el envio de size bytes de data, que no debe modificarse hasta que
+ * uart_tx_busy vuelva a false. Si hay un envio en curso, primero se espera */
+static void UartSendNonBlocking(const uint8_t *data, uint32_t size)
+{
+	uart_transfer_t xfer;
+
+	while(uart_tx_busy){}
+
+	uart_tx_busy = true;
+	xfer.txData = data;
+	xfer.dataSize = size;
+	UART_TransferSendNonBlocking(UART0, &uart_handle, &xfer);
+}
+
+#if TELEMETRY_STREAMING
+/* Transporte de la telemetria. El buffer se libera en UartTxCallback() */
+static void TelemetrySend(void *userData, const uint8_t *data, uint32_t size)
+{
+	(void)userData;
+	UartSendNonBlocking(data, size);
+}
+#endif
+
+/* Reinicia la deteccion de planta: desde el checkpoint si hay uno valido, si no con los
+ * coeficientes en cero */
+static void IdentRestart(ident_handle_t *ident)
+{
+	conv_detect_config_t conv_config;
+
+	CONV_DETECT_GetDefaultConfig(&conv_config);
+#if WARM_START
+	if(IDENT_CKPT_Load(ident, checkpoint, checkpoint_size, NULL) == ARM_MATH_SUCCESS)
+	{
+		IDENT_Resume(ident, mu);
+
+		/* El error arranca en el piso: no se espera que baje */
+		conv_config.minDrop = 0U;
+		CONV_DETECT_Init(&conv_detect, &conv_config);
+		return;
+	}
+#endif
+	IDENT_Restart(ident, mu);
+	CONV_DETECT_Init(&conv_detect, &conv_config);
+}
+
+#if ADC_INPUT
+/* Muestra del ADC en q15: se quita el valor medio del rango y se reduce a la escala de la
+ * señal generada */
+static inline q15_t AdcToQ15(uint32_t value)
+{
+	return (q15_t)(((int32_t)value - 32768) >> ADC_SHIFT);
+}
+
+/* ADC0 (y ADC1) con resolucion de 16 bits, disparados por el canal 0 del PIT */
+static void AdcInit(void)
+{
+	adc16_config_t adc_config;
+	adc16_channel_config_t channel_config = {0};
+
+	ADC16_GetDefaultConfig(&adc_config);
+	adc_config.resolution = kADC16_ResolutionSE16Bit;
+	adc_config.clockDivider = kADC16_ClockDivider2;
+
+	/* La calibracion usa el disparo por software: se hace antes del disparo por hardware */
+	ADC16_Init(ADC0, &adc_config);
+	ADC16_DoAutoCalibration(ADC0);
+	ADC16_EnableHardwareTrigger(ADC0, true);
+	channel_config.channelNumber = ADC0_INPUT_CHANNEL;
+	channel_config.enableInterruptOnConversionCompleted = true;
+	ADC16_SetChannelConfig(ADC0, 0U, &channel_config);
+#if ADC_CHANNELS > 1
+	ADC16_Init(ADC1, &adc_config);
+	ADC16_DoAutoCalibration(ADC1);
+	ADC16_EnableHardwareTrigger(ADC1, true);
+	channel_config.channelNumber = ADC1_OUTPUT_CHANNEL;
+	channel_config.enableInterruptOnConversionCompleted = false;
+	ADC16_SetChannelConfig(ADC1, 0U, &channel_config);
+#endif
+
+	/* Disparo alternativo de los dos ADC por el canal 0 del PIT (ADCxTRGSEL = 4) */
+	SIM->SOPT7 = SIM_SOPT7_ADC0ALTTRGEN_MASK | SIM_SOPT7_ADC0TRGSEL(4U) | SIM_SOPT7_ADC1ALTTRGEN_MASK |
+				 SIM_SOPT7_ADC1TRGSEL(4U);
+	CLOCK_EnableClock(kCLOCK_Pit0);
+	PIT->MCR = 0U;
+	PIT->CHANNEL[0].LDVAL = CLOCK_GetFreq(kCLOCK_BusClk) / ADC_SAMPLE_RATE - 1U;
+
+	ADC_STREAM_Init(&adc_stream, BLOCKSIZE, ADC_CHANNELS);
+	EnableIRQ(ADC0_IRQn);
+}
+
+/* Fin de conversion del ADC0: la muestra (y la del ADC1) va al bloque en llenado */
+void ADC0_IRQHandler(void)
+{
+	q15_t samples[ADC_STREAM_MAX_CHANNELS];
+
+	/* La lectura del resultado borra la bandera de fin de conversion */
+	samples[0] = AdcToQ15(ADC16_GetChannelConversionValue(ADC0, 0U));
+#if ADC_CHANNELS > 1
+	while((ADC16_GetChannelStatusFlags(ADC1, 0U) & kADC16_ChannelConversionDoneFlag) == 0U){}
+	samples[1] = AdcToQ15(ADC16_GetChannelConversionValue(ADC1, 0U));
+#endif
+	ADC_STREAM_PutSample(&adc_stream, samples);
+
+	/* Add for ARM errata 838869, affects Cortex-M4, Cortex-M4F
+	   Store immediate overlapping exception return operation might vector to incorrect interrupt. */
+	#if defined __CORTEX_M && (__CORTEX_M == 4U)
+	  __DSB();
+	#endif
+}
+#endif
+
+/* Arranca el muestreo al comenzar una corrida, con los bloques y contadores en cero. Entre
+ * corridas el PIT queda detenido para no contar overruns mientras se espera el pulsador */
+static void AdcStart(void)
+{
+#if ADC_INPUT
+	ADC_STREAM_Reset(&adc_stream);
+	PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TEN_MASK;
+#endif
+}
+
+static void AdcStop(void)
+{
+#if ADC_INPUT
+	PIT->CHANNEL[0].TCTRL = 0U;
+#endif
+}
+
+/* Con ADC_INPUT espera a que haya un bloque completo, fuera de la medicion de la trama */
+static inline void AdcWaitBlock(void)
+{
+#if ADC_INPUT
+	while(ADC_STREAM_GetBlock(&adc_stream, 0U) == NULL){}
+#endif
+}
+
+/* Procesa una trama con la señal generada o con el bloque adquirido */
+static q31_t IdentFrame(ident_handle_t *ident)
+{
+#if ADC_INPUT
+	q31_t frame_mse = IDENT_ProcessBlock(ident, ADC_STREAM_GetBlock(&adc_stream, 0U),
+										 ADC_STREAM_GetBlock(&adc_stream, 1U));
+	ADC_STREAM_ReleaseBlock(&adc_stream);
+	return frame_mse;
+#else
+	return IDENT_ProcessFrame(ident, signal_power);
+#endif
+}
+
+#if MEM_MAP_REPORT
+/* Mapa de memoria por la consola de depuracion */
+static void MemMapReport(void)
+{
+	const mem_plan_entry_t entries[] = {
+		{"ident", &ident, sizeof(ident), kMEM_PLAN_SramL},
+		{"conv_detect", &conv_detect, sizeof(conv_detect), kMEM_PLAN_SramL},
+#if PLACEMENT_BENCH
+		{"bench_io", &bench_io, sizeof(bench_io), kMEM_PLAN_SramL},
+#endif
+		{"ident_io", &ident_io, sizeof(ident_io), kMEM_PLAN_SramU},
+#if ADC_INPUT
+		{"adc_stream", &adc_stream, sizeof(adc_stream), kMEM_PLAN_SramU},
+#endif
+		{"uart_handle", &uart_handle, sizeof(uart_handle), kMEM_PLAN_SramU},
+#if TELEMETRY_STREAMING
+		{"telemetry", &telemetry, sizeof(telemetry), kMEM_PLAN_SramU},
+#else
+		{"dump_buffer", dump_buffer, sizeof(dump_buffer), kMEM_PLAN_SramU},
+#endif
+#if WARM_START
+		{"checkpoint", checkpoint, sizeof(checkpoint), kMEM_PLAN_SramU},
+#endif
+	};
+
+	PRINTF("\r\nPlan de memoria: NUMTAPS %u, BLOCKSIZE %u, NUMFRAMES %u\r\n", (unsigned)NUMTAPS,
+		   (unsigned)BLOCKSIZE, (unsigned)NUMFRAMES);
+	MEM_PLAN_Report(entries, sizeof(entries) / sizeof(entries[0]), PRINTF);
+}
+#endif
+
+#if PLACEMENT_BENCH
+/* Ciclos por trama con los bloques de entrada y salida en cada region. Las dos mediciones
+ * procesan la misma secuencia de tramas (IDENT_Init reinicia el generador). Al terminar
+ * el motor queda inicializado con ident_io y se borran las estadisticas de prof.h */
+static void PlacementBench(ident_config_t *config)
+{
+	ident_io_t *const layouts[2] = {&bench_io, &ident_io};
+	const char *const names[2] = {"E/S en SRAM_L (un bus)", "E/S en SRAM_U (dos buses)"};
+
+	PRINTF("\r\nUbicacion de los bloques de E/S: %u tramas\r\n", (unsigned)PLACEMENT_BENCH_FRAMES);
+	for(uint32_t k = 0; k < 2U; k++)
+	{
+		uint64_t total = 0;
+		uint32_t best = UINT32_MAX;
+
+		config->io = layouts[k];
+		IDENT_Init(&ident, config);
+		IDENT_Restart(&ident, 10000);
+		for(uint32_t i = 0; i < PLACEMENT_BENCH_FRAMES; i++)
+		{
+			uint32_t start = PROF_Now();
+			(void)IDENT_ProcessFrame(&ident, 1);
+			uint32_t cycles = PROF_Now() - start;
+
+			total += cycles;
+			best = (cycles < best) ? cycles : best;
+		}
+		PRINTF("%-26s %lu ciclos por trama (minimo %lu)\r\n", names[k],
+			   (unsigned long)(total / PLACEMENT_BENCH_FRAMES), (unsigned long)best);
+	}
+
+	config->io = &ident_io;
+	IDENT_Init(&ident, config);
+	PROF_Reset();
+}
+#endif
+
+/* Al terminar la corrida se guarda el checkpoint si se detecto la convergencia */
+static void CheckpointUpdate(const ident_handle_t *ident, q31_t frame_mse)
+{
+#if WARM_START
+	if(conv_detect.convFrame >= 0)
+	{
+		ident_ckpt_info_t info = {mu, signal_power, conv_detect.frames, frame_mse};
+		checkpoint_size = IDENT_CKPT_Save(ident, &info, checkpoint, sizeof(checkpoint));
+	}
+#else
+	(void)ident;
+	(void)frame_mse;
+#endif
+}
+
 /* SW2 Interr.: Se actualiza el valor de la potencia de señal */
 void GPIOC_IRQHANDLER(void) {
   /* Get pin flags */
@@ -121,80 +510,147 @@ int main()
 	BOARD_InitDebugConsole();
 
 	/****************************************************************
-	 * Se crean las instancias de cada filtro de acuerdo a la
-	 * documentacion oficial CMSIS.
+	 * Se inicializa el motor de identificacion (planta FIR + filtro
+	 * LMS de CMSIS). Ver ident.h.
 	 ****************************************************************
 	 */
-
-	/* Filtro FIR (planta) */
-	arm_fir_instance_q15 fir_struct;
-	q15_t fir_coeficients[NUMTAPS] = {5,		10,		20,		40,		80,	  160,	320,	640,	1320,	2640,
-									5280, 10560,	21120, 21120, 21120, 21120, 21120, 21120, 10560, 	5280,
-									2640, 	1320, 	640,	320, 	160, 	80, 	40, 	20, 	10, 	5};
-	q15_t fir_state[NUMTAPS + BLOCKSIZE - 1];
-	arm_fir_init_q15(&fir_struct, NUMTAPS, fir_coeficients, fir_state, BLOCKSIZE);
-
-	/* Filtro LMS */
-	arm_lms_instance_q15 lms_struct;
-	q15_t lms_coeficients[NUMTAPS] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	q15_t lms_state[NUMTAPS + BLOCKSIZE - 1];
-
-	/* Buffers auxiliares para computar algoritmo LMS */
-	q15_t src[BLOCKSIZE];
-	q15_t ref[BLOCKSIZE];
-	q15_t out[BLOCKSIZE];
-	q15_t err[BLOCKSIZE];
-
-    /* Variables para guardar la evolucion del error */
-    q31_t mse[NUMFRAMES];
+	ident_config_t ident_config;
+
+	IDENT_GetDefaultConfig(&ident_config);
+	ident_config.numTaps = NUMTAPS;
+	ident_config.blockSize = BLOCKSIZE;
+	ident_config.postShift = POSTSHIFT;
+	ident_config.algorithm = ALGORITHM;
+	ident_config.subBlockSize = SUBBLOCKSIZE;
+	ident_config.lmsRule = LMS_RULE;
+	ident_config.lmsLeak = LMS_LEAK;
+	ident_config.variableMu = (VARIABLE_MU != 0);
+	ident_config.io = &ident_io;
+	IDENT_Init(&ident, &ident_config);
+
+	q15_t* fir_coeficients = ident.plantCoeffs;
+	q15_t* lms_coeficients = ident.lmsCoeffs;
+
+#if MEM_MAP_REPORT
+	MemMapReport();
+#endif
+
+	UART_TransferCreateHandle(UART0, &uart_handle, UartTxCallback, NULL);
+
+	/* Contador de ciclos del DWT para medir cada etapa de la trama (prof.h) */
+	PROF_Init();
+#if PLACEMENT_BENCH
+	PlacementBench(&ident_config);
+#endif
+#if ADC_INPUT
+	AdcInit();
+#endif
+
+#if TELEMETRY_STREAMING
+	TELEMETRY_Init(&telemetry, TelemetrySend, &telemetry, TELEMETRY_MSE_ENCODING);
 
 	while(1)
 	{
 
 		restart = false;	/* Para que se ejecuta una vez la deteccion de planta*/
+		uint32_t frames = NUMFRAMES;
+		q31_t frame_mse = 0;
 
-		/* Se resetea el valor de los coficientes del filtro LMS*/
-		for(uint8_t i = 0; i < NUMTAPS; i++)
-			lms_coeficients[i] = 0;
-
-		/* Se inicializa el filtro LMS para una nueva deteccion de planta */
-		arm_lms_init_q15(&lms_struct, NUMTAPS, lms_coeficients, lms_state, mu, BLOCKSIZE, POSTSHIFT);
+		/* Se reinicia el filtro LMS para una nueva deteccion de planta */
+		IdentRestart(&ident);
+		PROF_Reset();
+		TELEMETRY_SendStart(&telemetry, fir_coeficients, NUMTAPS, mu, signal_power, NUMFRAMES, BLOCKSIZE);
+		AdcStart();
 
-		for(uint16_t i = 0; i < NUMFRAMES; i++)
+		for(uint32_t i = 0; i < NUMFRAMES; i++)
 		{
-			/* Se construye la señal aleatoria. Se shiftea el valor devuelto
-			 * para que sea una señal pequeña y no sature el calculo del filtro.
-			 * Recordar que la amplitud de señal de entrada y mu tienen una
-			 * relacion de compromiso para la velocidad de convergencia del
-			 * algoritmo. Si mu es muy grande o la señal de entrada es muy
-			 * grande, el algoritmo puede diverger.
-			 */
-			for(uint16_t j = 0; j < BLOCKSIZE; j++)
+			AdcWaitBlock();
+			PROF_BEGIN(kPROF_Frame);
+
+			/* Se computa la trama y se encola su MSE */
+			frame_mse = IdentFrame(&ident);
+			bool stop = EARLY_STOP && CONV_DETECT_Update(&conv_detect, frame_mse);
+
+			PROF_BEGIN(kPROF_Output);
+			TELEMETRY_SendMse(&telemetry, i, frame_mse);
+			if(((COEFF_SNAPSHOT_FRAMES != 0U) && (((i + 1U) % COEFF_SNAPSHOT_FRAMES) == 0U)) || stop)
 			{
-				src[j] = (q15_t)(rand()>>20) * signal_power;
+				TELEMETRY_SendCoeffs(&telemetry, i, lms_coeficients, NUMTAPS);
 			}
+			PROF_END(kPROF_Output);
 
-			arm_fir_q15(&fir_struct, src, ref, BLOCKSIZE);
+			PROF_END(kPROF_Frame);
 
-			arm_lms_q15(&lms_struct, src, ref, out, err, BLOCKSIZE);
+			/* Con el error en su piso no tiene sentido seguir */
+			if(stop)
+			{
+				frames = i + 1U;
+				break;
+			}
+		}
 
-			/* Se computa el MSE para cada iteracion */
-	        for(uint16_t k = 0; k < BLOCKSIZE; k++)
-	        {
-	        	mse[i] += err[k] * err [k];
-	        }
+		AdcStop();
+		CheckpointUpdate(&ident, frame_mse);
 
-	        mse[i] = mse[i] / BLOCKSIZE;
+		/* El final de la corrida se sigue enviando mientras se espera el pulsador y
+		 * durante la corrida siguiente. Antes se envian los ciclos de cada etapa */
+#if PROF_ENABLE
+		TELEMETRY_SendProfile(&telemetry);
+#endif
+		TELEMETRY_SendEnd(&telemetry, frames);
+
+		/* Se espera hasta que el usuario haga cambie el mu o la potencia de entrada */
+		while(!restart){}
+	}
+#else
+	uint32_t dump_index = 0;
+
+	while(1)
+	{
+
+		restart = false;	/* Para que se ejecuta una vez la deteccion de planta*/
+		q31_t frame_mse = 0;
+
+		/* La trama anterior puede seguir enviandose desde el otro buffer. El de esta
+		 * corrida ya se envio entero: UartSendNonBlocking() espera el envio anterior */
+		uint8_t* tx_buffer = dump_buffer[dump_index];
+
+		/* El MSE de cada trama se guarda directamente en la trama de salida, 2 bytes por
+		 * trama, en lugar de un arreglo de NUMFRAMES q31_t en la pila (20 KB) */
+		uint8_t* err_tx_buffer = &tx_buffer[NUMTAPS*4];
+
+		/* Se reinicia el filtro LMS para una nueva deteccion de planta */
+		IdentRestart(&ident);
+
+		/* Sin cabecera en la trama no hay donde enviar los ciclos de cada etapa: quedan en
+		 * g_profStats para leerlos con el depurador */
+		PROF_Reset();
+		AdcStart();
+
+		for(uint16_t i = 0; i < NUMFRAMES; i++)
+		{
+			/* Se computa la trama y el MSE para cada iteracion */
+			AdcWaitBlock();
+			PROF_BEGIN(kPROF_Frame);
+			frame_mse = IdentFrame(&ident);
+			PROF_END(kPROF_Frame);
+			CONV_DETECT_Update(&conv_detect, frame_mse);
 
 	        /* Se satura el error para poder enviar los bits menos significativos.
 	         * No interesa que el error sea grande al principio, pero si es importante
 	         * saber que tan pequeño es al final.
 	         * Se satura al valor de 2^17.
+	         * Se descartan los dos bits LSB. No importan los bits mayores a 17 ya que
+	         * esta saturado. El rango de importancia es entre 2 a 17 bits.
 	         */
-	        if(mse[i] > 262143)
-	        	mse[i] = 262143;
+	        q31_t saturated_mse = (frame_mse > 262143) ? 262143 : frame_mse;
+	        err_tx_buffer[2U*i] = (uint8_t) (saturated_mse >> 2) & 0x0FF;
+	        err_tx_buffer[2U*i + 1U] = (uint8_t) (saturated_mse >> 10) & 0x0FF;
 		}
 
+		AdcStop();
+		CheckpointUpdate(&ident, frame_mse);
+
 		/* Se crea la trama de salida
 		 * El tx_buffer es de tamaño x4 porque el tamaño de dato que se puede
 		 * transmitir es de 8bits y cada dato q15_t ocupa 2 bytes y se meten los
@@ -213,7 +669,7 @@ int main()
 			   118      |   fir_coeficients[29] LowByte
 			   119      |   fir_coeficients[29] HighByte
 		 */
-		uint8_t tx_buffer[NUMTAPS*4];
+		PROF_BEGIN(kPROF_Output);
 		uint8_t* tx_buffer_ptr = tx_buffer;
 
 		for(uint8_t j = 0; j < 2; j++)
@@ -243,29 +699,15 @@ int main()
 				}
 			}
 		}
+		PROF_END(kPROF_Output);
 
-		/* Se hace la transmision de los datos */
-		UART_WriteBlocking(UART0, tx_buffer, NUMTAPS*4);
-
-		/* Se transmite la informacion del error */
-
-		uint8_t err_tx_buffer[NUMFRAMES*2];
-		uint8_t* err_tx_buffer_ptr = err_tx_buffer;
-
-		for(uint16_t i = 0; i < NUMFRAMES; i++)
-		{
-			/* Se descartan los dos bits LSB. No importan los bits mayores a 17 ya que
-			 * esta saturado. El rango de importancia es entre 2 a 17 bits.
-			 */
-			*err_tx_buffer_ptr = (uint8_t) (mse[i] >> 2) & 0x0FF;
-			err_tx_buffer_ptr++;
-			*err_tx_buffer_ptr = (uint8_t) (mse[i] >> 10) & 0x0FF ;
-			err_tx_buffer_ptr++;
-		}
-
-		UART_WriteBlocking(UART0, err_tx_buffer, NUMFRAMES*2);
+		/* Se hace la transmision de los datos sin bloquear: los mismos bytes que antes
+		 * enviaban los dos UART_WriteBlocking, en una sola transferencia */
+		UartSendNonBlocking(tx_buffer, DUMP_BUFFER_SIZE);
+		dump_index ^= 1U;
 
 		/* Se espera hasta que el usuario haga cambie el mu o la potencia de entrada */
 		while(!restart){}
 	}
+#endif
 }
@@ -0,0 +1,117 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Adquisicion por bloques con doble buffer (ver adc_stream.h).
+ */
+
+#include "adc_stream.h"
+#include "prof.h"
+#include <string.h>
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+/* pending es la unica variable que escriben los dos lados. Con release/acquire las
+ * muestras del bloque (y readyBuffer/readyTime) quedan visibles antes que la bandera: en
+ * el Cortex-M4 es una barrera del compilador y un DMB, en el host ordena los hilos */
+static inline bool ADC_STREAM_LoadPending(const adc_stream_handle_t *handle)
+{
+	return __atomic_load_n(&handle->pending, __ATOMIC_ACQUIRE);
+}
+
+static inline void ADC_STREAM_StorePending(adc_stream_handle_t *handle, bool value)
+{
+	__atomic_store_n(&handle->pending, value, __ATOMIC_RELEASE);
+}
+
+arm_status ADC_STREAM_Init(adc_stream_handle_t *handle, uint32_t blockSize, uint32_t numChannels)
+{
+	if((blockSize == 0U) || (blockSize > ADC_STREAM_MAX_BLOCKSIZE) || (numChannels == 0U) ||
+	   (numChannels > ADC_STREAM_MAX_CHANNELS))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	handle->blockSize = blockSize;
+	handle->numChannels = numChannels;
+	memset(handle->buffer, 0, sizeof(handle->buffer));
+	ADC_STREAM_Reset(handle);
+	return ARM_MATH_SUCCESS;
+}
+
+void ADC_STREAM_Reset(adc_stream_handle_t *handle)
+{
+	handle->fillBuffer = 0U;
+	handle->fillIndex = 0U;
+	handle->readyBuffer = 0U;
+	handle->readyTime = 0U;
+	handle->stats.blocks = 0U;
+	handle->stats.overruns = 0U;
+	handle->stats.droppedSamples = 0U;
+	handle->stats.maxLatency = 0U;
+	ADC_STREAM_StorePending(handle, false);
+}
+
+bool ADC_STREAM_PutSample(adc_stream_handle_t *handle, const q15_t *samples)
+{
+	uint32_t index = handle->fillIndex;
+
+	for(uint32_t ch = 0; ch < handle->numChannels; ch++)
+	{
+		handle->buffer[handle->fillBuffer][ch][index] = samples[ch];
+	}
+	index++;
+	if(index < handle->blockSize)
+	{
+		handle->fillIndex = index;
+		return false;
+	}
+
+	handle->fillIndex = 0U;
+	if(ADC_STREAM_LoadPending(handle))
+	{
+		/* El lazo principal sigue con el bloque anterior: se descarta este y se vuelve a
+		 * llenar el mismo buffer */
+		handle->stats.overruns++;
+		handle->stats.droppedSamples += handle->blockSize;
+		return false;
+	}
+
+	handle->readyBuffer = handle->fillBuffer;
+	handle->readyTime = PROF_Now();
+	handle->fillBuffer ^= 1U;
+	ADC_STREAM_StorePending(handle, true);
+	return true;
+}
+
+bool ADC_STREAM_TryPutSample(adc_stream_handle_t *handle, const q15_t *samples)
+{
+	if((handle->fillIndex + 1U == handle->blockSize) && ADC_STREAM_LoadPending(handle))
+	{
+		return false;
+	}
+	ADC_STREAM_PutSample(handle, samples);
+	return true;
+}
+
+const q15_t *ADC_STREAM_GetBlock(adc_stream_handle_t *handle, uint32_t channel)
+{
+	if(!ADC_STREAM_LoadPending(handle) || (channel >= handle->numChannels))
+	{
+		return NULL;
+	}
+	return handle->buffer[handle->readyBuffer][channel];
+}
+
+void ADC_STREAM_ReleaseBlock(adc_stream_handle_t *handle)
+{
+	if(!ADC_STREAM_LoadPending(handle))
+	{
+		return;
+	}
+
+	uint32_t latency = PROF_Now() - handle->readyTime;
+	handle->stats.maxLatency = (latency > handle->stats.maxLatency) ? latency : handle->stats.maxLatency;
+	handle->stats.blocks++;
+	ADC_STREAM_StorePending(handle, false);
+}
@@ -0,0 +1,106 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Adquisicion por bloques con doble buffer (ping-pong) para identificar la planta a
+	partir de señales muestreadas en lugar de la señal generada por software. Mientras
+	el motor de identificacion procesa un bloque de blockSize muestras, la interrupcion
+	del conversor (ADC16 disparado por el PIT en el firmware, host/adc_replay.c en Linux)
+	llena el otro.
+
+	El modulo no depende del hardware: la interrupcion llama a ADC_STREAM_PutSample() con
+	una muestra por canal y el lazo principal toma los bloques con ADC_STREAM_GetBlock() y
+	los devuelve con ADC_STREAM_ReleaseBlock(). Hay un solo productor y un solo consumidor,
+	por lo que alcanza con una bandera (pending) con semantica release/acquire.
+
+	Si al completar un bloque el anterior todavia no se devolvio, el procesamiento no llego
+	a tiempo: el bloque completo se descarta (se vuelve a llenar el mismo buffer) y se
+	cuenta en overruns. Asi un bloque nunca se procesa con mas de un periodo de bloque de
+	atraso: la latencia desde que se completa hasta que se devuelve (maxLatency, en ticks
+	de PROF_Now()) queda acotada por el periodo del bloque o se cuenta un overrun.
+
+	Los canales se guardan uno detras del otro (no intercalados) para pasarlos directo a
+	IDENT_ProcessBlock(): el canal 0 es la entrada de la planta y el 1, si se usa, su
+	salida medida.
+ */
+
+#ifndef ADC_STREAM_H_
+#define ADC_STREAM_H_
+
+#include "arm_math.h"
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+#ifndef ADC_STREAM_MAX_BLOCKSIZE
+#define ADC_STREAM_MAX_BLOCKSIZE (100U)
+#endif
+
+#define ADC_STREAM_MAX_CHANNELS (2U)
+
+/* Contadores de la adquisicion */
+typedef struct _adc_stream_stats
+{
+	uint32_t blocks;			/* Bloques entregados al lazo principal */
+	uint32_t overruns;			/* Bloques descartados porque el anterior seguia en proceso */
+	uint32_t droppedSamples;	/* Muestras descartadas por los overruns */
+	uint32_t maxLatency;		/* Maximo, en ticks, desde que se completa un bloque hasta que se devuelve */
+} adc_stream_stats_t;
+
+/* Estado de la adquisicion */
+typedef struct _adc_stream_handle
+{
+	uint32_t blockSize;
+	uint32_t numChannels;
+	q15_t buffer[2][ADC_STREAM_MAX_CHANNELS][ADC_STREAM_MAX_BLOCKSIZE];
+
+	/* Productor (interrupcion) */
+	uint32_t fillBuffer;		/* Buffer que se esta llenando */
+	uint32_t fillIndex;			/* Muestras ya escritas en el */
+
+	/* Compartido: el productor lo pone en true y el consumidor en false */
+	volatile bool pending;		/* Hay un bloque completo en readyBuffer */
+	uint32_t readyBuffer;
+	uint32_t readyTime;			/* PROF_Now() al completarse */
+
+	volatile adc_stream_stats_t stats;
+} adc_stream_handle_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Inicializa la adquisicion de bloques de blockSize muestras de numChannels canales.
+ * Devuelve ARM_MATH_ARGUMENT_ERROR si superan ADC_STREAM_MAX_BLOCKSIZE o
+ * ADC_STREAM_MAX_CHANNELS */
+arm_status ADC_STREAM_Init(adc_stream_handle_t *handle, uint32_t blockSize, uint32_t numChannels);
+
+/* Descarta el bloque pendiente y el que se esta llenando y borra los contadores. Se
+ * llama con la interrupcion del conversor detenida */
+void ADC_STREAM_Reset(adc_stream_handle_t *handle);
+
+/* Productor: agrega una muestra de cada canal (samples[0..numChannels-1]). Se llama
+ * desde la interrupcion de fin de conversion. Devuelve true si completo un bloque */
+bool ADC_STREAM_PutSample(adc_stream_handle_t *handle, const q15_t *samples);
+
+/* Productor: como ADC_STREAM_PutSample() pero si el bloque anterior sigue en proceso no
+ * lo completa y devuelve false sin agregar la muestra (para reproducir archivos sin
+ * perdidas en el host) */
+bool ADC_STREAM_TryPutSample(adc_stream_handle_t *handle, const q15_t *samples);
+
+/* Consumidor: devuelve las blockSize muestras del canal indicado del bloque pendiente, o
+ * NULL si todavia no hay uno completo. El bloque no cambia hasta ADC_STREAM_ReleaseBlock() */
+const q15_t *ADC_STREAM_GetBlock(adc_stream_handle_t *handle, uint32_t channel);
+
+/* Consumidor: devuelve el bloque al productor y actualiza la latencia maxima */
+void ADC_STREAM_ReleaseBlock(adc_stream_handle_t *handle);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* ADC_STREAM_H_ */
@@ -0,0 +1,201 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    APA de orden K con matriz de Gram de ventana deslizante (ver apa.h).
+	La muestra x(t) de la trama esta en pState[APA_HIST + t], con t desde
+	-(numTaps + APA_MAX_ORDER) hasta blockSize - 1, y la ventana de entrada de
+	la muestra t (orden de CMSIS) empieza en pState[APA_HIST + t - numTaps + 1].
+ */
+
+#include "apa.h"
+#include <math.h>
+#include <stdbool.h>
+
+/* Muestras anteriores a la trama que se conservan en pState */
+#define APA_HIST(numTaps) ((uint32_t)(numTaps) + APA_MAX_ORDER)
+
+/* [-1, 1) -> q15 con saturacion, antes de convertir a entero para no desbordar */
+static inline q15_t APA_FloatToQ15(float32_t v)
+{
+	v *= 32768.0f;
+	return (v >= 32767.0f) ? INT16_MAX : ((v <= -32768.0f) ? INT16_MIN : (q15_t)v);
+}
+
+static inline float32_t APA_Dot(const float32_t *w, const q15_t *x, uint32_t numTaps)
+{
+	float32_t acc = 0.0f;
+	for(uint32_t i = 0; i < numTaps; i++)
+	{
+		acc += w[i] * (float32_t)x[i];
+	}
+	return acc / 32768.0f;
+}
+
+/* Resuelve A a = b por Cholesky (A simetrica definida positiva, se usa el triangulo
+ * inferior y se sobreescribe con L). Devuelve false si A no es definida positiva */
+static bool APA_Solve(float32_t A[APA_MAX_ORDER][APA_MAX_ORDER], float32_t *b, uint32_t order)
+{
+	for(uint32_t j = 0; j < order; j++)
+	{
+		float32_t d = A[j][j];
+		for(uint32_t k = 0; k < j; k++)
+		{
+			d -= A[j][k] * A[j][k];
+		}
+		if(d <= 0.0f)
+		{
+			return false;
+		}
+		d = sqrtf(d);
+		A[j][j] = d;
+		for(uint32_t i = j + 1U; i < order; i++)
+		{
+			float32_t s = A[i][j];
+			for(uint32_t k = 0; k < j; k++)
+			{
+				s -= A[i][k] * A[j][k];
+			}
+			A[i][j] = s / d;
+		}
+	}
+
+	/* L y = b */
+	for(uint32_t i = 0; i < order; i++)
+	{
+		for(uint32_t k = 0; k < i; k++)
+		{
+			b[i] -= A[i][k] * b[k];
+		}
+		b[i] /= A[i][i];
+	}
+
+	/* L' a = y */
+	for(uint32_t i = order; i-- > 0U;)
+	{
+		for(uint32_t k = i + 1U; k < order; k++)
+		{
+			b[i] -= A[k][i] * b[k];
+		}
+		b[i] /= A[i][i];
+	}
+
+	return true;
+}
+
+arm_status APA_Init(apa_instance_f32 *S, uint16_t numTaps, uint16_t order, void *pBuffer, q15_t mu,
+					float32_t delta, uint32_t blockSize)
+{
+	if((order == 0U) || (order > APA_MAX_ORDER))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	S->numTaps = numTaps;
+	S->order = order;
+	S->mu = (float32_t)mu / 32768.0f;
+	S->delta = delta;
+	S->pW = (float32_t *)pBuffer;
+	S->pState = (q15_t *)&S->pW[numTaps];
+
+	memset(pBuffer, 0, APA_BUFFER_SIZE(numTaps, blockSize));
+	memset(S->gram, 0, sizeof(S->gram));
+	memset(S->refHist, 0, sizeof(S->refHist));
+
+	return ARM_MATH_SUCCESS;
+}
+
+void APA_Process(apa_instance_f32 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr,
+				 uint32_t blockSize)
+{
+	uint32_t numTaps = S->numTaps;
+	uint32_t order = S->order;
+	uint32_t hist = APA_HIST(numTaps);
+	q15_t *x = &S->pState[hist];	/* x[t] = x(t), con t >= -hist */
+	float32_t *pW = S->pW;
+	int64_t (*gram)[APA_MAX_ORDER] = S->gram;
+	float32_t A[APA_MAX_ORDER][APA_MAX_ORDER];
+	float32_t e[APA_MAX_ORDER];
+
+	memcpy(x, pSrc, blockSize * sizeof(q15_t));
+
+	for(int32_t n = 0; n < (int32_t)blockSize; n++)
+	{
+		/* Nueva primera fila de G: r_j(n) = r_j(n-1) + x(n) x(n-j) - x(n-N) x(n-N-j) */
+		int64_t row[APA_MAX_ORDER];
+		for(uint32_t j = 0; j < order; j++)
+		{
+			row[j] = gram[0][j] + (int32_t)x[n] * x[n - (int32_t)j] -
+					 (int32_t)x[n - (int32_t)numTaps] * x[n - (int32_t)numTaps - (int32_t)j];
+		}
+
+		/* El resto de G es la matriz de la muestra anterior desplazada en la diagonal */
+		for(uint32_t i = order - 1U; i > 0U; i--)
+		{
+			for(uint32_t j = order - 1U; j > 0U; j--)
+			{
+				gram[i][j] = gram[i - 1U][j - 1U];
+			}
+		}
+		for(uint32_t j = 0; j < order; j++)
+		{
+			gram[0][j] = row[j];
+			gram[j][0] = row[j];
+		}
+
+		/* Errores de las ultimas K muestras con los coeficientes actuales */
+		for(uint32_t j = 0; j < order; j++)
+		{
+			int32_t t = n - (int32_t)j;
+			q15_t d = (t >= 0) ? pRef[t] : S->refHist[-t - 1];
+			float32_t y = APA_Dot(pW, &x[t - (int32_t)numTaps + 1], numTaps);
+
+			if(j == 0U)
+			{
+				/* Salida y error con el mismo redondeo que arm_lms_q15 */
+				q15_t yq = APA_FloatToQ15(y);
+				pOut[n] = yq;
+				pErr[n] = (q15_t)((q31_t)d - yq);
+			}
+			e[j] = (float32_t)d / 32768.0f - y;
+		}
+
+		/* a = (X' X + delta I)^-1 e */
+		for(uint32_t i = 0; i < order; i++)
+		{
+			for(uint32_t j = 0; j <= i; j++)
+			{
+				A[i][j] = (float32_t)gram[i][j] * (1.0f / 1073741824.0f);
+			}
+			A[i][i] += S->delta;
+		}
+		if(!APA_Solve(A, e, order))
+		{
+			continue;
+		}
+
+		/* w += mu X a */
+		for(uint32_t j = 0; j < order; j++)
+		{
+			const q15_t *px = &x[n - (int32_t)j - (int32_t)numTaps + 1];
+			float32_t g = S->mu * e[j] / 32768.0f;
+			for(uint32_t i = 0; i < numTaps; i++)
+			{
+				pW[i] += g * (float32_t)px[i];
+			}
+		}
+	}
+
+	/* Se conservan las ultimas referencias y muestras para la proxima trama */
+	for(uint32_t m = APA_MAX_ORDER; m-- > 0U;)
+	{
+		S->refHist[m] = (m < blockSize) ? pRef[blockSize - 1U - m] : S->refHist[m - blockSize];
+	}
+	memmove(S->pState, &S->pState[blockSize], hist * sizeof(q15_t));
+}
+
+void APA_GetCoeffsQ15(const apa_instance_f32 *S, q15_t *pCoeffs)
+{
+	for(uint32_t i = 0; i < S->numTaps; i++)
+	{
+		pCoeffs[i] = APA_FloatToQ15(S->pW[i]);
+	}
+}
@@ -0,0 +1,68 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Identificacion por proyeccion afin (APA) de orden K, como alternativa a
+	arm_lms_q15. Por cada muestra se usan las ultimas K ventanas de entrada
+	X = [x(n), x(n-1), ..., x(n-K+1)] (numTaps x K):
+		e = d - X' w            (errores de las K ultimas muestras con los w actuales)
+		G = X' X + delta I      (matriz de Gram K x K, regularizada)
+		w = w + mu X G^-1 e
+	Con K = 1 es el NLMS. Al crecer K la convergencia con entradas coloreadas se
+	acerca a la del RLS, con un costo O(2 K numTaps + K^3) por muestra.
+
+	Las ventanas son versiones desplazadas de la misma señal, por lo que G no se
+	recalcula: G(n)[i][j] = G(n-1)[i-1][j-1] y solo la primera fila es nueva. Esa fila
+	son las autocorrelaciones de ventana deslizante
+		r_j(n) = r_j(n-1) + x(n) x(n-j) - x(n-N) x(n-N-j)
+	que se acumulan en enteros de 64 bits (productos q15 exactos), sin deriva. El
+	sistema K x K se resuelve por Cholesky en punto flotante.
+
+	Interfaz y formato de los coeficientes como arm_lms_q15 (invertidos en el tiempo).
+	mu en q15: 32767 equivale a mu = 1, el maximo estable para el APA.
+ */
+
+#ifndef APA_H_
+#define APA_H_
+
+#include "arm_math.h"
+
+/* Orden maximo de la proyeccion */
+#define APA_MAX_ORDER (8U)
+
+/* Bytes del buffer de trabajo (coeficientes y estado) */
+#define APA_BUFFER_SIZE(numTaps, blockSize) \
+	((numTaps) * sizeof(float32_t) + ((numTaps) + APA_MAX_ORDER + (blockSize)) * sizeof(q15_t))
+
+/* Instancia del APA */
+typedef struct _apa_instance_f32
+{
+	uint16_t numTaps;
+	uint16_t order;								/* K, entre 1 y APA_MAX_ORDER */
+	float32_t mu;
+	float32_t delta;							/* Regularizacion de G */
+	float32_t *pW;								/* Coeficientes */
+	q15_t *pState;								/* numTaps + APA_MAX_ORDER muestras anteriores y la trama */
+	int64_t gram[APA_MAX_ORDER][APA_MAX_ORDER];	/* X' X en unidades de 2^-30 */
+	q15_t refHist[APA_MAX_ORDER];				/* Ultimas referencias, refHist[0] la mas reciente */
+} apa_instance_f32;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* pBuffer debe tener APA_BUFFER_SIZE(numTaps, blockSize) bytes, alineado a 4.
+ * Devuelve ARM_MATH_ARGUMENT_ERROR si order no esta entre 1 y APA_MAX_ORDER */
+arm_status APA_Init(apa_instance_f32 *S, uint16_t numTaps, uint16_t order, void *pBuffer, q15_t mu,
+					float32_t delta, uint32_t blockSize);
+
+/* Misma interfaz que arm_lms_q15 */
+void APA_Process(apa_instance_f32 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr,
+				 uint32_t blockSize);
+
+/* Coeficientes en q15, en el orden de CMSIS */
+void APA_GetCoeffsQ15(const apa_instance_f32 *S, q15_t *pCoeffs);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* APA_H_ */
@@ -0,0 +1,229 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Implementacion portable (C puro) de las funciones de CMSIS-DSP que usa el motor
+	de identificacion (ident.c). En el K64F se enlaza la biblioteca precompilada
+	arm_cortexM4lf_math, por lo que este archivo solo se compila cuando el destino
+	no es un Cortex-M (por ejemplo, un host x86-64 o ARM64 con Linux).
+	Se puede forzar su uso definiendo DSP_PORT_FORCE.
+	El procesamiento se delega en los kernels bit-exactos de dsp_ref.c (y para el LMS,
+	en su version vectorizada de dsp_simd.c), por lo que el host reproduce
+	exactamente la numerica del firmware.
+ */
+
+#include "arm_math.h"
+#include "dsp_ref.h"
+#include "dsp_simd.h"
+
+#if !defined(__arm__) || defined(DSP_PORT_FORCE)
+
+/* Solo en el host: la Redlib del firmware no tiene pthread.h */
+#include <pthread.h>
+
+/*******************************************************************************
+ * FIR q15
+ ******************************************************************************/
+
+arm_status arm_fir_init_q15(arm_fir_instance_q15 *S, uint16_t numTaps, const q15_t *pCoeffs,
+							q15_t *pState, uint32_t blockSize)
+{
+	/* Igual que la version M4: numTaps debe ser par y mayor a 2 */
+	if((numTaps < 4U) || ((numTaps & 0x1U) != 0U))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	S->numTaps = numTaps;
+	S->pCoeffs = pCoeffs;
+	memset(pState, 0, (numTaps + (blockSize - 1U)) * sizeof(q15_t));
+	S->pState = pState;
+
+	return ARM_MATH_SUCCESS;
+}
+
+void arm_fir_q15(const arm_fir_instance_q15 *S, const q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+	DSP_REF_FirQ15(S, pSrc, pDst, blockSize);
+}
+
+/*******************************************************************************
+ * LMS q15
+ ******************************************************************************/
+
+void arm_lms_init_q15(arm_lms_instance_q15 *S, uint16_t numTaps, q15_t *pCoeffs, q15_t *pState,
+					  q15_t mu, uint32_t blockSize, uint32_t postShift)
+{
+	S->numTaps = numTaps;
+	S->pCoeffs = pCoeffs;
+	memset(pState, 0, (numTaps + (blockSize - 1U)) * sizeof(q15_t));
+	S->pState = pState;
+	S->mu = mu;
+	S->postShift = postShift;
+}
+
+void arm_lms_q15(const arm_lms_instance_q15 *S, const q15_t *pSrc, q15_t *pRef, q15_t *pOut,
+				 q15_t *pErr, uint32_t blockSize)
+{
+	DSP_SIMD_LmsQ15(S, pSrc, pRef, pOut, pErr, blockSize);
+}
+
+/*******************************************************************************
+ * Energia q15
+ ******************************************************************************/
+
+void arm_power_q15(const q15_t *pSrc, uint32_t blockSize, q63_t *pResult)
+{
+	*pResult = DSP_SIMD_PowerQ15(pSrc, blockSize);
+}
+
+/*******************************************************************************
+ * RFFT f32 (backend FFT del host)
+ * Mismo formato que la version CMSIS: la salida directa guarda X[0] y X[N/2] (ambos
+ * reales) en las posiciones 0 y 1, y luego Re/Im de X[1] .. X[N/2 - 1]. La inversa
+ * incluye el factor 1/N. La FFT real de N puntos se arma con una FFT compleja radix-2
+ * de N/2 puntos. Los twiddles de todas las longitudes se toman, con paso, de una
+ * unica tabla de PORT_FFT_MAX_LEN puntos.
+ ******************************************************************************/
+
+#define PORT_FFT_MAX_LEN (4096U)
+
+static float32_t s_twiddle[PORT_FFT_MAX_LEN];	/* cos/sin de -2*pi*k/PORT_FFT_MAX_LEN, k < PORT_FFT_MAX_LEN/2 */
+static pthread_once_t s_twiddleOnce = PTHREAD_ONCE_INIT;
+
+static void port_twiddle_init(void)
+{
+	for(uint32_t k = 0; k < PORT_FFT_MAX_LEN / 2U; k++)
+	{
+		double phase = -2.0 * PI * (double)k / (double)PORT_FFT_MAX_LEN;
+		s_twiddle[2U * k] = (float32_t)cos(phase);
+		s_twiddle[2U * k + 1U] = (float32_t)sin(phase);
+	}
+}
+
+/* exp(-2*pi*i*k/n) (o su conjugado si inverse != 0) */
+static inline void port_twiddle(uint32_t k, uint32_t n, uint8_t inverse, float32_t *re, float32_t *im)
+{
+	uint32_t idx = k * (PORT_FFT_MAX_LEN / n);
+	*re = s_twiddle[2U * idx];
+	*im = inverse ? -s_twiddle[2U * idx + 1U] : s_twiddle[2U * idx + 1U];
+}
+
+/* FFT compleja radix-2 in-place, sin escalar */
+static void port_cfft(float32_t *p, uint32_t n, uint8_t inverse)
+{
+	/* Reordenamiento bit-reverse */
+	for(uint32_t i = 1U, j = 0U; i < n; i++)
+	{
+		uint32_t bit = n >> 1;
+		for(; (j & bit) != 0U; bit >>= 1)
+		{
+			j ^= bit;
+		}
+		j ^= bit;
+		if(i < j)
+		{
+			float32_t tr = p[2U * i], ti = p[2U * i + 1U];
+			p[2U * i] = p[2U * j];
+			p[2U * i + 1U] = p[2U * j + 1U];
+			p[2U * j] = tr;
+			p[2U * j + 1U] = ti;
+		}
+	}
+
+	for(uint32_t len = 2U; len <= n; len <<= 1)
+	{
+		uint32_t half = len >> 1;
+		for(uint32_t k = 0; k < half; k++)
+		{
+			float32_t wr, wi;
+			port_twiddle(k, len, inverse, &wr, &wi);
+			for(uint32_t i = k; i < n; i += len)
+			{
+				float32_t *a = &p[2U * i];
+				float32_t *b = &p[2U * (i + half)];
+				float32_t tr = b[0] * wr - b[1] * wi;
+				float32_t ti = b[0] * wi + b[1] * wr;
+				b[0] = a[0] - tr;
+				b[1] = a[1] - ti;
+				a[0] += tr;
+				a[1] += ti;
+			}
+		}
+	}
+}
+
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen)
+{
+	if((fftLen < 32U) || (fftLen > PORT_FFT_MAX_LEN) || ((fftLen & (fftLen - 1U)) != 0U))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	pthread_once(&s_twiddleOnce, port_twiddle_init);
+
+	S->fftLenRFFT = fftLen;
+	S->pTwiddleRFFT = s_twiddle;
+	S->Sint.fftLen = fftLen / 2U;
+	S->Sint.pTwiddle = s_twiddle;
+	S->Sint.pBitRevTable = NULL;
+	S->Sint.bitRevLength = 0U;
+
+	return ARM_MATH_SUCCESS;
+}
+
+void arm_rfft_fast_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut, uint8_t ifftFlag)
+{
+	uint32_t n = S->fftLenRFFT;
+	uint32_t m = n / 2U;
+
+	if(ifftFlag == 0U)
+	{
+		/* z[k] = x[2k] + i x[2k+1], Z = FFT(z) */
+		port_cfft(p, m, 0U);
+
+		pOut[0] = p[0] + p[1];
+		pOut[1] = p[0] - p[1];
+		for(uint32_t k = 1U; k < m; k++)
+		{
+			/* X[k] = (Z[k] + conj(Z[m-k]))/2 - i W^k (Z[k] - conj(Z[m-k]))/2 */
+			float32_t ar = p[2U * k], ai = p[2U * k + 1U];
+			float32_t br = p[2U * (m - k)], bi = -p[2U * (m - k) + 1U];
+			float32_t er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+			float32_t or_ = 0.5f * (ar - br), oi = 0.5f * (ai - bi);
+			float32_t wr, wi;
+			port_twiddle(k, n, 0U, &wr, &wi);
+			float32_t tr = or_ * wr - oi * wi;
+			float32_t ti = or_ * wi + oi * wr;
+			pOut[2U * k] = er + ti;
+			pOut[2U * k + 1U] = ei - tr;
+		}
+	}
+	else
+	{
+		/* Se reconstruye Z[k] = E[k] + i O[k] y z = IFFT(Z) */
+		pOut[0] = 0.5f * (p[0] + p[1]);
+		pOut[1] = 0.5f * (p[0] - p[1]);
+		for(uint32_t k = 1U; k < m; k++)
+		{
+			float32_t ar = p[2U * k], ai = p[2U * k + 1U];
+			float32_t br = p[2U * (m - k)], bi = -p[2U * (m - k) + 1U];
+			float32_t er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+			float32_t dr = 0.5f * (ar - br), di = 0.5f * (ai - bi);
+			float32_t wr, wi;
+			port_twiddle(k, n, 1U, &wr, &wi);
+			float32_t or_ = dr * wr - di * wi;
+			float32_t oi = dr * wi + di * wr;
+			pOut[2U * k] = er - oi;
+			pOut[2U * k + 1U] = ei + or_;
+		}
+
+		port_cfft(pOut, m, 1U);
+
+		float32_t scale = 1.0f / (float32_t)m;
+		for(uint32_t k = 0; k < n; k++)
+		{
+			pOut[k] *= scale;
+		}
+	}
+}
+
+#endif /* !defined(__arm__) || defined(DSP_PORT_FORCE) */
@@ -0,0 +1,83 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Detector de convergencia en linea (ver conv_detect.h).
+ */
+
+#include "conv_detect.h"
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+/* log2(mse) con CONV_DETECT_LOG_FRAC bits fraccionarios: posicion del bit mas
+ * significativo y, como fraccion, los bits que le siguen (interpolacion lineal de la
+ * mantisa, error menor a 0.09 bits). 0 para mse <= 1 */
+static inline int32_t CONV_DETECT_Log2(q31_t mse)
+{
+	if(mse <= 1)
+	{
+		return 0;
+	}
+	uint32_t exponent = 31U - __CLZ((uint32_t)mse);
+	uint32_t frac = (((uint32_t)mse << (31U - exponent)) >> (31U - CONV_DETECT_LOG_FRAC)) &
+					((1U << CONV_DETECT_LOG_FRAC) - 1U);
+	return (int32_t)((exponent << CONV_DETECT_LOG_FRAC) | frac);
+}
+
+void CONV_DETECT_GetDefaultConfig(conv_detect_config_t *config)
+{
+	config->window = 25U;
+	config->tolerance = 1U << (CONV_DETECT_LOG_FRAC - 2U);
+	config->holdWindows = 3U;
+	config->minDrop = 7U << CONV_DETECT_LOG_FRAC;
+}
+
+void CONV_DETECT_Init(conv_detect_instance_t *S, const conv_detect_config_t *config)
+{
+	S->config = *config;
+	S->config.window = (config->window == 0U) ? 1U : config->window;
+	S->sum = 0;
+	S->firstMean = 0;
+	S->prevMean = 0;
+	S->frames = 0U;
+	S->stable = 0U;
+	S->convFrame = -1;
+}
+
+bool CONV_DETECT_Update(conv_detect_instance_t *S, q31_t mse)
+{
+	S->frames++;
+	if(S->convFrame >= 0)
+	{
+		return true;
+	}
+
+	S->sum += mse;
+	if((S->frames % S->config.window) != 0U)
+	{
+		return false;
+	}
+
+	int32_t mean = CONV_DETECT_Log2((q31_t)(S->sum / (q63_t)S->config.window));
+	S->sum = 0;
+	if(S->frames == S->config.window)
+	{
+		S->firstMean = mean;
+		S->prevMean = mean;
+		return false;
+	}
+
+	int32_t diff = mean - S->prevMean;
+	bool flat = ((diff < 0) ? -diff : diff) <= (int32_t)S->config.tolerance;
+	bool dropped = (S->firstMean - mean) >= (int32_t)S->config.minDrop;
+
+	S->stable = (flat && dropped) ? (S->stable + 1U) : 0U;
+	S->prevMean = mean;
+
+	if(S->stable >= S->config.holdWindows)
+	{
+		S->convFrame = (int32_t)S->frames - 1;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,83 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Detector de convergencia en linea a partir del MSE de cada trama, para terminar la
+	corrida (o el trabajo de un barrido) cuando el error ya llego a su piso en lugar de
+	correr siempre NUMFRAMES tramas.
+
+	El MSE se promedia en ventanas de window tramas y se compara el logaritmo en base 2
+	de la media (con CONV_DETECT_LOG_FRAC bits fraccionarios) con el de la ventana
+	anterior. En el piso el MSE de cada trama alterna ceros (error nulo) con picos de
+	cientos, por lo que la media de una ventana varia hasta en un factor 2 aunque la
+	pendiente sea nula: la tolerancia se expresa como factor y no como diferencia. Se
+	declara la convergencia cuando holdWindows ventanas seguidas difieren en no mas de
+	tolerance y ademas el MSE bajo al menos minDrop respecto de la primera ventana (ambos
+	en 1/2^CONV_DETECT_LOG_FRAC de bit, es decir de un factor 2).
+	La segunda condicion evita confundir con el regimen permanente la bajada muy lenta de
+	un mu chico (la media casi no cambia entre ventanas, pero sigue lejos del piso); al
+	arrancar en caliente desde un checkpoint el error ya esta en el piso y se usa
+	minDrop = 0.
+
+	Solo usa __CLZ, sumas y comparaciones, por lo que cuesta lo mismo en el Cortex-M4 que
+	en el host.
+ */
+
+#ifndef CONV_DETECT_H_
+#define CONV_DETECT_H_
+
+#include "arm_math.h"
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+/* Bits fraccionarios del logaritmo del MSE */
+#define CONV_DETECT_LOG_FRAC (4U)
+
+/* Configuracion del detector */
+typedef struct _conv_detect_config
+{
+	uint32_t window;			/* Tramas por ventana */
+	uint32_t tolerance;			/* Diferencia maxima entre ventanas, en 1/2^CONV_DETECT_LOG_FRAC de bit */
+	uint32_t holdWindows;		/* Ventanas seguidas dentro de la tolerancia */
+	uint32_t minDrop;			/* Caida minima respecto de la primera ventana (0 = ninguna) */
+} conv_detect_config_t;
+
+/* Estado del detector */
+typedef struct _conv_detect_instance
+{
+	conv_detect_config_t config;
+	q63_t sum;					/* Suma del MSE de la ventana en curso */
+	int32_t firstMean;			/* Logaritmo de la media de la primera ventana */
+	int32_t prevMean;			/* Logaritmo de la media de la ultima ventana completa */
+	uint32_t frames;			/* Tramas procesadas */
+	uint32_t stable;			/* Ventanas seguidas dentro de la tolerancia */
+	int32_t convFrame;			/* Trama en la que se detecto la convergencia, -1 si todavia no */
+} conv_detect_instance_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Ventanas de 25 tramas, tolerancia de 1/4 de bit (19 %), 3 ventanas seguidas y caida
+ * de 7 bits (21 dB). Elegidos sobre la planta del firmware con mu de 100 a 28000 y
+ * signal_power de 1 a 15: con menos caida se cortan corridas de mu chico que todavia
+ * bajan, y con menos tolerancia no se detecta el piso con signal_power 10 */
+void CONV_DETECT_GetDefaultConfig(conv_detect_config_t *config);
+
+/* Reinicia el detector para una nueva corrida */
+void CONV_DETECT_Init(conv_detect_instance_t *S, const conv_detect_config_t *config);
+
+/* Agrega el MSE de una trama. Devuelve true desde la trama en que se detecta la
+ * convergencia (S->convFrame) en adelante */
+bool CONV_DETECT_Update(conv_detect_instance_t *S, q31_t mse);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CONV_DETECT_H_ */
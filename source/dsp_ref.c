@@ -0,0 +1,121 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Kernels de referencia bit-exactos para FIR y LMS q15 (ver dsp_ref.h).
+	El buffer de estado tiene el mismo formato que en CMSIS: las numTaps - 1
+	muestras anteriores seguidas de las blockSize muestras de la trama actual.
+ */
+
+#include "dsp_ref.h"
+
+void DSP_REF_FirQ15(const arm_fir_instance_q15 *S, const q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+	q15_t *pState = S->pState;
+	const q15_t *pCoeffs = S->pCoeffs;
+	uint16_t numTaps = S->numTaps;
+
+	/* Las nuevas muestras se copian a continuacion de las numTaps - 1 anteriores */
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		const q15_t *px = &pState[n];
+		q63_t acc = 0;
+
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			acc += (q31_t)px[k] * pCoeffs[k];
+		}
+
+		/* La biblioteca M4 trunca a 32 bits antes de saturar (__SSAT recibe un q31_t) */
+		pDst[n] = (q15_t)__SSAT((q31_t)(acc >> 15), 16);
+	}
+
+	/* Se conservan las ultimas numTaps - 1 muestras para la siguiente trama */
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+}
+
+void DSP_REF_LmsQ15(const arm_lms_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					q15_t *pErr, uint32_t blockSize)
+{
+	q15_t *pState = S->pState;
+	q15_t *pCoeffs = S->pCoeffs;
+	uint16_t numTaps = S->numTaps;
+	q15_t mu = S->mu;
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		const q15_t *px = &pState[n];
+
+		/* Salida del filtro adaptativo */
+		q63_t acc = 0;
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			acc += (q31_t)px[k] * pCoeffs[k];
+		}
+
+		/* El error se guarda truncado, pero alpha se calcula con el error de 32 bits */
+		q31_t e = DSP_REF_LmsOutput(acc, pRef[n], S->postShift, &pOut[n]);
+		pErr[n] = (q15_t)e;
+		q15_t alpha = (q15_t)((e * mu) >> 15);
+
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			pCoeffs[k] = DSP_REF_LmsUpdate(pCoeffs[k], alpha, px[k]);
+		}
+	}
+
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+}
+
+q63_t DSP_REF_IdentQ15(const arm_lms_instance_q15 *S, const q15_t *pPlant, const q15_t *pSrc, q15_t *pRef,
+					   q15_t *pOut, q15_t *pErr, uint32_t blockSize)
+{
+	q15_t *pState = S->pState;
+	q15_t *pCoeffs = S->pCoeffs;
+	uint16_t numTaps = S->numTaps;
+	q15_t mu = S->mu;
+	q63_t energy = 0;
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		const q15_t *px = &pState[n];
+
+		/* Planta y filtro adaptativo leen las mismas muestras */
+		q63_t plant = 0;
+		q63_t acc = 0;
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			plant += (q31_t)px[k] * pPlant[k];
+			acc += (q31_t)px[k] * pCoeffs[k];
+		}
+		pRef[n] = (q15_t)__SSAT((q31_t)(plant >> 15), 16);
+
+		q31_t e = DSP_REF_LmsOutput(acc, pRef[n], S->postShift, &pOut[n]);
+		pErr[n] = (q15_t)e;
+		energy += (q31_t)pErr[n] * pErr[n];
+		q15_t alpha = (q15_t)((e * mu) >> 15);
+
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			pCoeffs[k] = DSP_REF_LmsUpdate(pCoeffs[k], alpha, px[k]);
+		}
+	}
+
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+	return energy;
+}
+
+q63_t DSP_REF_PowerQ15(const q15_t *pSrc, uint32_t blockSize)
+{
+	q63_t sum = 0;
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		sum += (q31_t)pSrc[n] * pSrc[n];
+	}
+	return sum;
+}
@@ -0,0 +1,65 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Kernels de referencia en C portable para arm_fir_q15, arm_lms_q15 y la planta y el
+	LMS fusionados (DSP_REF_IdentQ15).
+	Reproducen bit a bit el resultado de la biblioteca precompilada
+	arm_cortexM4lf_math (CMSIS-DSP V1.6.0, variante Cortex-M4 con extension DSP):
+	 - FIR: acumulador de 64 bits, salida = SSAT16((q31_t)(acc >> 15)).
+	 - LMS: acumulador de 64 bits, salida = SSAT16((q31_t)(acc >> (15 - postShift))).
+	   El error e = ref - salida se calcula en 32 bits; en pErr se guarda truncado
+	   a 16 bits (sin saturar) y con ese mismo e de 32 bits se calcula
+	   alpha = (q15_t)((e * mu) >> 15). Cada coeficiente se actualiza con
+	   SSAT16(coef + ((alpha * x) >> 15)).
+	La suma en 64 bits no puede desbordar para numTaps < 2^33, por lo que el orden de
+	acumulacion (y por lo tanto cualquier desenrollado o version SIMD) no altera el
+	resultado. Estas funciones sirven de patron para validar variantes optimizadas.
+ */
+
+#ifndef DSP_REF_H_
+#define DSP_REF_H_
+
+#include "arm_math.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Equivalente a arm_fir_q15. La instancia se inicializa con arm_fir_init_q15 */
+void DSP_REF_FirQ15(const arm_fir_instance_q15 *S, const q15_t *pSrc, q15_t *pDst, uint32_t blockSize);
+
+/* Equivalente a arm_lms_q15. La instancia se inicializa con arm_lms_init_q15 */
+void DSP_REF_LmsQ15(const arm_lms_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					q15_t *pErr, uint32_t blockSize);
+
+/* Planta FIR y LMS en una sola pasada sobre una unica linea de retardo (la de S): para
+ * cada muestra se calcula la salida de la planta pPlant (numTaps coeficientes, como
+ * arm_fir_q15), que se guarda en pRef y es la referencia del LMS. Equivale a llamar a
+ * arm_fir_q15 y luego a arm_lms_q15 con la misma entrada, con la planta arrancando con
+ * la historia de S. Devuelve la energia del error de la trama (suma de pErr[n]^2, igual
+ * que arm_power_q15 sobre pErr) */
+q63_t DSP_REF_IdentQ15(const arm_lms_instance_q15 *S, const q15_t *pPlant, const q15_t *pSrc, q15_t *pRef,
+					   q15_t *pOut, q15_t *pErr, uint32_t blockSize);
+
+/* Equivalente a arm_power_q15: suma de pSrc[n]^2 en 64 bits, sin desborde */
+q63_t DSP_REF_PowerQ15(const q15_t *pSrc, uint32_t blockSize);
+
+/* Salida y error de una muestra del LMS, segun el redondeo de la biblioteca M4.
+ * Devuelve el error en 32 bits (el que se usa para calcular alpha). */
+static inline q31_t DSP_REF_LmsOutput(q63_t acc, q15_t ref, uint32_t postShift, q15_t *out)
+{
+	q15_t y = (q15_t)__SSAT((q31_t)(acc >> (15U - postShift)), 16);
+	*out = y;
+	return (q31_t)ref - y;
+}
+
+/* Actualizacion de un coeficiente, segun el redondeo de la biblioteca M4 */
+static inline q15_t DSP_REF_LmsUpdate(q15_t coef, q15_t alpha, q15_t x)
+{
+	return (q15_t)__SSAT((q31_t)coef + (((q31_t)alpha * x) >> 15), 16);
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* DSP_REF_H_ */
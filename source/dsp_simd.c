@@ -0,0 +1,459 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    LMS q15 y energia de una señal vectorizados para el host (ver dsp_simd.h).
+
+	Para mantener la exactitud respecto de dsp_ref.c:
+	 - Producto escalar y energia (AVX2): _mm256_madd_epi16 suma pares de productos en 32 bits.
+	   El unico par que desborda es (-32768 * -32768) * 2 = 2^31, que aparece como
+	   INT32_MIN; ningun par legitimo vale INT32_MIN, asi que se cuentan esos carriles
+	   y se suma 2^32 por cada uno al acumulador de 64 bits.
+	 - Actualizacion: (alpha * x) >> 15 se arma con mulhi/mullo de 16 bits y se suma
+	   con saturacion (_mm256_adds_epi16). El resultado solo no entra en 16 bits si
+	   alpha = x = -32768, por lo que las muestras con alpha = -32768 se actualizan con
+	   el camino escalar.
+	 - NEON trabaja con productos ensanchados a 32/64 bits, sin casos especiales.
+	Si numTaps no es multiplo del ancho del vector, el ultimo bloque se carga
+	solapado con el anterior y se enmascaran los carriles ya procesados.
+ */
+
+#include "dsp_simd.h"
+#include "dsp_ref.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__) && (DSP_SIMD_NEON != 0U)
+#include <arm_neon.h>
+#endif
+
+#if defined(__AVX2__)
+
+/* Carriles [0, 16 - rem) del bloque solapado ya fueron procesados */
+static inline __m256i DSP_SIMD_TailMask(uint32_t rem)
+{
+	static const int16_t ramp[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+	__m256i idx = _mm256_loadu_si256((const __m256i *)ramp);
+	return _mm256_cmpgt_epi16(_mm256_set1_epi16((int16_t)(16U - rem)), idx);
+}
+
+/* Acumula en 64 bits el resultado de madd, corrigiendo el desborde de INT32_MIN */
+static inline __m256i DSP_SIMD_AccMadd(__m256i acc, __m256i *ovf, __m256i x, __m256i b)
+{
+	__m256i m = _mm256_madd_epi16(x, b);
+	*ovf = _mm256_sub_epi32(*ovf, _mm256_cmpeq_epi32(m, _mm256_set1_epi32(INT32_MIN)));
+	acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(m)));
+	return _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(m, 1)));
+}
+
+/* (alpha * x) >> 15 sumado con saturacion al coeficiente, para alpha != -32768 */
+static inline __m256i DSP_SIMD_Update(__m256i b, __m256i x, __m256i a)
+{
+	__m256i hi = _mm256_mulhi_epi16(x, a);
+	__m256i lo = _mm256_mullo_epi16(x, a);
+	__m256i t = _mm256_or_si256(_mm256_slli_epi16(hi, 1), _mm256_srli_epi16(lo, 15));
+	return _mm256_adds_epi16(b, t);
+}
+
+/* Suma horizontal del acumulador de 64 bits mas la correccion de desborde */
+static inline q63_t DSP_SIMD_Reduce(__m256i acc, __m256i ovf)
+{
+	__m128i acc2 = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+	__m128i ovf4 = _mm_add_epi32(_mm256_castsi256_si128(ovf), _mm256_extracti128_si256(ovf, 1));
+	ovf4 = _mm_hadd_epi32(ovf4, ovf4);
+	ovf4 = _mm_hadd_epi32(ovf4, ovf4);
+	return _mm_cvtsi128_si64(acc2) + _mm_extract_epi64(acc2, 1) + ((q63_t)_mm_cvtsi128_si32(ovf4) << 32);
+}
+
+/* Caso 16 < numTaps <= 32 (NUMTAPS = 30 en el firmware): los coeficientes se
+ * mantienen en dos registros durante todo el bloque. c1 cubre el bloque solapado
+ * [numTaps - 16, numTaps) con los carriles repetidos en cero, asi no hace falta
+ * enmascarar en el producto escalar y cada coeficiente vive en un solo registro.
+ * Como la recursion del LMS es serie muestra a muestra, lo que importa es la
+ * latencia: x se separa en x = 256 * xh + xl (xl sin signo de 8 bits), asi las
+ * sumas parciales de madd entran en 32 bits y la reduccion horizontal no necesita
+ * ensanchar a 64 bits. x no depende de los coeficientes, por lo que la separacion
+ * queda fuera del camino critico.
+ * Si pPlant no es NULL (kernel fusionado) la salida de la planta se calcula en el mismo
+ * lazo con sus coeficientes en otros dos registros y se guarda en pRef; no depende de
+ * la actualizacion, asi que tampoco alarga el camino critico. Lo mismo vale para la
+ * energia del error, que se devuelve. */
+__STATIC_FORCEINLINE q63_t DSP_SIMD_LmsQ15Reg(const arm_lms_instance_q15 *S, const q15_t *pPlant,
+											  const q15_t *pState, q15_t *pRef, q15_t *pOut, q15_t *pErr,
+											  uint32_t blockSize)
+{
+	uint16_t numTaps = S->numTaps;
+	q15_t *pCoeffs = S->pCoeffs;
+	q15_t mu = S->mu;
+	uint32_t tail = numTaps - 16U;
+	__m256i tailMask = DSP_SIMD_TailMask(numTaps - 16U);
+	__m256i lowByte = _mm256_set1_epi16(0x00FF);
+	q63_t energy = 0;
+
+	__m256i c0 = _mm256_loadu_si256((const __m256i *)&pCoeffs[0]);
+	__m256i c1 = _mm256_andnot_si256(tailMask, _mm256_loadu_si256((const __m256i *)&pCoeffs[tail]));
+	__m256i p0 = _mm256_setzero_si256();
+	__m256i p1 = _mm256_setzero_si256();
+	if(pPlant != NULL)
+	{
+		p0 = _mm256_loadu_si256((const __m256i *)&pPlant[0]);
+		p1 = _mm256_andnot_si256(tailMask, _mm256_loadu_si256((const __m256i *)&pPlant[tail]));
+	}
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		const q15_t *px = &pState[n];
+		__m256i x0 = _mm256_loadu_si256((const __m256i *)&px[0]);
+		__m256i x1 = _mm256_loadu_si256((const __m256i *)&px[tail]);
+		__m256i xh0 = _mm256_srai_epi16(x0, 8);
+		__m256i xh1 = _mm256_srai_epi16(x1, 8);
+		__m256i xl0 = _mm256_and_si256(x0, lowByte);
+		__m256i xl1 = _mm256_and_si256(x1, lowByte);
+
+		if(pPlant != NULL)
+		{
+			__m256i ph = _mm256_add_epi32(_mm256_madd_epi16(xh0, p0), _mm256_madd_epi16(xh1, p1));
+			__m256i pl = _mm256_add_epi32(_mm256_madd_epi16(xl0, p0), _mm256_madd_epi16(xl1, p1));
+			__m256i phl = _mm256_hadd_epi32(ph, pl);
+			__m128i r = _mm_add_epi32(_mm256_castsi256_si128(phl), _mm256_extracti128_si256(phl, 1));
+			r = _mm_add_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+			q63_t plant = ((q63_t)_mm_cvtsi128_si32(r) << 8) + _mm_extract_epi32(r, 2);
+			pRef[n] = (q15_t)__SSAT((q31_t)(plant >> 15), 16);
+		}
+
+		/* Salida del filtro adaptativo: |sumas parciales| < 2^28 */
+		__m256i hi = _mm256_add_epi32(_mm256_madd_epi16(xh0, c0), _mm256_madd_epi16(xh1, c1));
+		__m256i lo = _mm256_add_epi32(_mm256_madd_epi16(xl0, c0), _mm256_madd_epi16(xl1, c1));
+		/* Tras el plegado, el carril 0 tiene la suma alta y el carril 2 la baja */
+		__m256i hl = _mm256_hadd_epi32(hi, lo);
+		__m128i r = _mm_add_epi32(_mm256_castsi256_si128(hl), _mm256_extracti128_si256(hl, 1));
+		r = _mm_add_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+		q63_t sum = ((q63_t)_mm_cvtsi128_si32(r) << 8) + _mm_extract_epi32(r, 2);
+
+		/* Error y actualizacion de coeficientes */
+		q31_t e = DSP_REF_LmsOutput(sum, pRef[n], S->postShift, &pOut[n]);
+		pErr[n] = (q15_t)e;
+		energy += (q31_t)pErr[n] * pErr[n];
+		q15_t alpha = (q15_t)((e * mu) >> 15);
+
+		if(alpha == INT16_MIN)
+		{
+			_mm256_storeu_si256((__m256i *)&pCoeffs[tail], c1);
+			_mm256_storeu_si256((__m256i *)&pCoeffs[0], c0);
+			for(uint16_t k = 0; k < numTaps; k++)
+			{
+				pCoeffs[k] = DSP_REF_LmsUpdate(pCoeffs[k], alpha, px[k]);
+			}
+			c0 = _mm256_loadu_si256((const __m256i *)&pCoeffs[0]);
+			c1 = _mm256_andnot_si256(tailMask, _mm256_loadu_si256((const __m256i *)&pCoeffs[tail]));
+			continue;
+		}
+
+		__m256i a = _mm256_set1_epi16(alpha);
+		c0 = DSP_SIMD_Update(c0, x0, a);
+		c1 = _mm256_andnot_si256(tailMask, DSP_SIMD_Update(c1, x1, a));
+	}
+
+	/* Primero el bloque solapado, para que c0 pise los carriles repetidos */
+	_mm256_storeu_si256((__m256i *)&pCoeffs[tail], c1);
+	_mm256_storeu_si256((__m256i *)&pCoeffs[0], c0);
+	return energy;
+}
+
+/* Producto escalar exacto de numTaps >= 16 muestras */
+static inline q63_t DSP_SIMD_Dot(const q15_t *px, const q15_t *pCoeffs, uint32_t numTaps, __m256i tailMask)
+{
+	uint32_t tail = numTaps - 16U;
+	__m256i acc = _mm256_setzero_si256();
+	__m256i ovf = _mm256_setzero_si256();
+
+	for(uint32_t v = 0; v < numTaps / 16U; v++)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i *)&px[16U * v]);
+		__m256i b = _mm256_loadu_si256((const __m256i *)&pCoeffs[16U * v]);
+		acc = DSP_SIMD_AccMadd(acc, &ovf, x, b);
+	}
+	if((numTaps % 16U) != 0U)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i *)&px[tail]);
+		__m256i b = _mm256_andnot_si256(tailMask, _mm256_loadu_si256((const __m256i *)&pCoeffs[tail]));
+		acc = DSP_SIMD_AccMadd(acc, &ovf, x, b);
+	}
+	return DSP_SIMD_Reduce(acc, ovf);
+}
+
+/* LMS de numTaps >= 16 sobre la linea de retardo ya cargada con la trama. Devuelve la
+ * energia del error */
+static q63_t DSP_SIMD_LmsBlock(const arm_lms_instance_q15 *S, const q15_t *pState, const q15_t *pRef, q15_t *pOut,
+							   q15_t *pErr, uint32_t blockSize)
+{
+	uint16_t numTaps = S->numTaps;
+	q15_t *pCoeffs = S->pCoeffs;
+	q15_t mu = S->mu;
+	uint32_t numVec = numTaps / 16U;
+	uint32_t rem = numTaps % 16U;
+	uint32_t tail = numTaps - 16U;
+	__m256i tailMask = DSP_SIMD_TailMask(rem);
+	q63_t energy = 0;
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		const q15_t *px = &pState[n];
+
+		/* Salida del filtro adaptativo, error y actualizacion de coeficientes */
+		q31_t e = DSP_REF_LmsOutput(DSP_SIMD_Dot(px, pCoeffs, numTaps, tailMask), pRef[n], S->postShift, &pOut[n]);
+		pErr[n] = (q15_t)e;
+		energy += (q31_t)pErr[n] * pErr[n];
+		q15_t alpha = (q15_t)((e * mu) >> 15);
+
+		if(alpha == INT16_MIN)
+		{
+			for(uint16_t k = 0; k < numTaps; k++)
+			{
+				pCoeffs[k] = DSP_REF_LmsUpdate(pCoeffs[k], alpha, px[k]);
+			}
+			continue;
+		}
+
+		__m256i a = _mm256_set1_epi16(alpha);
+		for(uint32_t v = 0; v < numVec; v++)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i *)&px[16U * v]);
+			__m256i b = _mm256_loadu_si256((const __m256i *)&pCoeffs[16U * v]);
+			_mm256_storeu_si256((__m256i *)&pCoeffs[16U * v], DSP_SIMD_Update(b, x, a));
+		}
+		if(rem != 0U)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i *)&px[tail]);
+			__m256i b = _mm256_loadu_si256((const __m256i *)&pCoeffs[tail]);
+			__m256i nb = _mm256_blendv_epi8(DSP_SIMD_Update(b, x, a), b, tailMask);
+			_mm256_storeu_si256((__m256i *)&pCoeffs[tail], nb);
+		}
+	}
+	return energy;
+}
+
+void DSP_SIMD_LmsQ15(const arm_lms_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					 q15_t *pErr, uint32_t blockSize)
+{
+	uint16_t numTaps = S->numTaps;
+	q15_t *pState = S->pState;
+
+	if(numTaps < 16U)
+	{
+		DSP_REF_LmsQ15(S, pSrc, pRef, pOut, pErr, blockSize);
+		return;
+	}
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+	if((numTaps > 16U) && (numTaps <= 32U))
+	{
+		/* Sin planta pRef solo se lee */
+		DSP_SIMD_LmsQ15Reg(S, NULL, pState, (q15_t *)pRef, pOut, pErr, blockSize);
+	}
+	else
+	{
+		DSP_SIMD_LmsBlock(S, pState, pRef, pOut, pErr, blockSize);
+	}
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+}
+
+q63_t DSP_SIMD_IdentQ15(const arm_lms_instance_q15 *S, const q15_t *pPlant, const q15_t *pSrc, q15_t *pRef,
+						q15_t *pOut, q15_t *pErr, uint32_t blockSize)
+{
+	uint16_t numTaps = S->numTaps;
+	q15_t *pState = S->pState;
+	q63_t energy;
+
+	if(numTaps < 16U)
+	{
+		return DSP_REF_IdentQ15(S, pPlant, pSrc, pRef, pOut, pErr, blockSize);
+	}
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+	if((numTaps > 16U) && (numTaps <= 32U))
+	{
+		energy = DSP_SIMD_LmsQ15Reg(S, pPlant, pState, pRef, pOut, pErr, blockSize);
+	}
+	else
+	{
+		/* Con mas taps los coeficientes no entran en registros: primero la planta y
+		 * despues el LMS, sobre la misma linea de retardo */
+		__m256i tailMask = DSP_SIMD_TailMask(numTaps % 16U);
+		for(uint32_t n = 0; n < blockSize; n++)
+		{
+			pRef[n] = (q15_t)__SSAT((q31_t)(DSP_SIMD_Dot(&pState[n], pPlant, numTaps, tailMask) >> 15), 16);
+		}
+		energy = DSP_SIMD_LmsBlock(S, pState, pRef, pOut, pErr, blockSize);
+	}
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+	return energy;
+}
+
+q63_t DSP_SIMD_PowerQ15(const q15_t *pSrc, uint32_t blockSize)
+{
+	__m256i acc = _mm256_setzero_si256();
+	__m256i ovf = _mm256_setzero_si256();
+	uint32_t n = 0;
+
+	for(; n + 16U <= blockSize; n += 16U)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i *)&pSrc[n]);
+		acc = DSP_SIMD_AccMadd(acc, &ovf, x, x);
+	}
+	return DSP_SIMD_Reduce(acc, ovf) + DSP_REF_PowerQ15(&pSrc[n], blockSize - n);
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__) && (DSP_SIMD_NEON != 0U)
+
+/* SSAT16(coef + ((alpha * x) >> 15)) con productos de 32 bits */
+static inline int16x8_t DSP_SIMD_Update(int16x8_t b, int16x8_t x, int16x4_t a)
+{
+	int32x4_t lo = vaddw_s16(vshrq_n_s32(vmull_s16(vget_low_s16(x), a), 15), vget_low_s16(b));
+	int32x4_t hi = vaddw_s16(vshrq_n_s32(vmull_s16(vget_high_s16(x), a), 15), vget_high_s16(b));
+	return vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+}
+
+/* Producto escalar exacto de numTaps >= 8 muestras */
+static inline q63_t DSP_SIMD_Dot(const q15_t *px, const q15_t *pCoeffs, uint32_t numTaps, uint16x8_t tailMask)
+{
+	uint32_t tail = numTaps - 8U;
+	int64x2_t acc = vdupq_n_s64(0);
+
+	for(uint32_t v = 0; v < numTaps / 8U; v++)
+	{
+		int16x8_t x = vld1q_s16(&px[8U * v]);
+		int16x8_t b = vld1q_s16(&pCoeffs[8U * v]);
+		acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(x), vget_low_s16(b)));
+		acc = vpadalq_s32(acc, vmull_high_s16(x, b));
+	}
+	if((numTaps % 8U) != 0U)
+	{
+		int16x8_t x = vld1q_s16(&px[tail]);
+		int16x8_t b = vbicq_s16(vld1q_s16(&pCoeffs[tail]), vreinterpretq_s16_u16(tailMask));
+		acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(x), vget_low_s16(b)));
+		acc = vpadalq_s32(acc, vmull_high_s16(x, b));
+	}
+	return vaddvq_s64(acc);
+}
+
+/* Carriles [0, 8 - rem) del bloque solapado ya fueron procesados */
+static inline uint16x8_t DSP_SIMD_TailMask(uint32_t rem)
+{
+	static const int16_t ramp[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+	return vcltq_s16(vld1q_s16(ramp), vdupq_n_s16((int16_t)(8U - rem)));
+}
+
+/* Planta opcional (pPlant != NULL) y LMS de numTaps >= 8 sobre la linea de retardo ya
+ * cargada con la trama. Devuelve la energia del error */
+static q63_t DSP_SIMD_LmsBlock(const arm_lms_instance_q15 *S, const q15_t *pPlant, const q15_t *pState,
+							   q15_t *pRef, q15_t *pOut, q15_t *pErr, uint32_t blockSize)
+{
+	uint16_t numTaps = S->numTaps;
+	q15_t *pCoeffs = S->pCoeffs;
+	q15_t mu = S->mu;
+	uint32_t numVec = numTaps / 8U;
+	uint32_t rem = numTaps % 8U;
+	uint32_t tail = numTaps - 8U;
+	uint16x8_t tailMask = DSP_SIMD_TailMask(rem);
+	q63_t energy = 0;
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		const q15_t *px = &pState[n];
+
+		if(pPlant != NULL)
+		{
+			pRef[n] = (q15_t)__SSAT((q31_t)(DSP_SIMD_Dot(px, pPlant, numTaps, tailMask) >> 15), 16);
+		}
+
+		/* Salida del filtro adaptativo, error y actualizacion de coeficientes */
+		q31_t e = DSP_REF_LmsOutput(DSP_SIMD_Dot(px, pCoeffs, numTaps, tailMask), pRef[n], S->postShift, &pOut[n]);
+		pErr[n] = (q15_t)e;
+		energy += (q31_t)pErr[n] * pErr[n];
+		q15_t alpha = (q15_t)((e * mu) >> 15);
+
+		int16x4_t a = vdup_n_s16(alpha);
+		for(uint32_t v = 0; v < numVec; v++)
+		{
+			int16x8_t x = vld1q_s16(&px[8U * v]);
+			int16x8_t b = vld1q_s16(&pCoeffs[8U * v]);
+			vst1q_s16(&pCoeffs[8U * v], DSP_SIMD_Update(b, x, a));
+		}
+		if(rem != 0U)
+		{
+			int16x8_t x = vld1q_s16(&px[tail]);
+			int16x8_t b = vld1q_s16(&pCoeffs[tail]);
+			vst1q_s16(&pCoeffs[tail], vbslq_s16(tailMask, b, DSP_SIMD_Update(b, x, a)));
+		}
+	}
+	return energy;
+}
+
+void DSP_SIMD_LmsQ15(const arm_lms_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					 q15_t *pErr, uint32_t blockSize)
+{
+	uint16_t numTaps = S->numTaps;
+	q15_t *pState = S->pState;
+
+	if(numTaps < 8U)
+	{
+		DSP_REF_LmsQ15(S, pSrc, pRef, pOut, pErr, blockSize);
+		return;
+	}
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+	/* Sin planta pRef solo se lee */
+	DSP_SIMD_LmsBlock(S, NULL, pState, (q15_t *)pRef, pOut, pErr, blockSize);
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+}
+
+q63_t DSP_SIMD_IdentQ15(const arm_lms_instance_q15 *S, const q15_t *pPlant, const q15_t *pSrc, q15_t *pRef,
+						q15_t *pOut, q15_t *pErr, uint32_t blockSize)
+{
+	uint16_t numTaps = S->numTaps;
+	q15_t *pState = S->pState;
+
+	if(numTaps < 8U)
+	{
+		return DSP_REF_IdentQ15(S, pPlant, pSrc, pRef, pOut, pErr, blockSize);
+	}
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+	q63_t energy = DSP_SIMD_LmsBlock(S, pPlant, pState, pRef, pOut, pErr, blockSize);
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+	return energy;
+}
+
+q63_t DSP_SIMD_PowerQ15(const q15_t *pSrc, uint32_t blockSize)
+{
+	int64x2_t acc = vdupq_n_s64(0);
+	uint32_t n = 0;
+
+	for(; n + 8U <= blockSize; n += 8U)
+	{
+		int16x8_t x = vld1q_s16(&pSrc[n]);
+		acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(x), vget_low_s16(x)));
+		acc = vpadalq_s32(acc, vmull_high_s16(x, x));
+	}
+	return vaddvq_s64(acc) + DSP_REF_PowerQ15(&pSrc[n], blockSize - n);
+}
+
+#else
+
+void DSP_SIMD_LmsQ15(const arm_lms_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					 q15_t *pErr, uint32_t blockSize)
+{
+	DSP_REF_LmsQ15(S, pSrc, pRef, pOut, pErr, blockSize);
+}
+
+q63_t DSP_SIMD_IdentQ15(const arm_lms_instance_q15 *S, const q15_t *pPlant, const q15_t *pSrc, q15_t *pRef,
+						q15_t *pOut, q15_t *pErr, uint32_t blockSize)
+{
+	return DSP_REF_IdentQ15(S, pPlant, pSrc, pRef, pOut, pErr, blockSize);
+}
+
+q63_t DSP_SIMD_PowerQ15(const q15_t *pSrc, uint32_t blockSize)
+{
+	return DSP_REF_PowerQ15(pSrc, blockSize);
+}
+
+#endif
@@ -0,0 +1,49 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Version vectorizada (AVX2 en x86-64, NEON en ARM64) del LMS q15 y de arm_power_q15
+	para el host. El resultado es identico bit a bit al de dsp_ref.c (y por lo tanto al
+	de la biblioteca del Cortex-M4). Si el compilador no habilita AVX2 (-mavx2 o
+	-march=native) ni NEON, se usa directamente el kernel de referencia.
+
+	La version NEON todavia no se corrio en un ARM64, por lo que solo se compila con
+	-DDSP_SIMD_NEON=1; antes de habilitarla por defecto hay que pasar
+	host/dsp_conformance.c en un ARM64 (o con qemu-aarch64).
+ */
+
+#ifndef DSP_SIMD_H_
+#define DSP_SIMD_H_
+
+#include "arm_math.h"
+
+#ifndef DSP_SIMD_NEON
+#define DSP_SIMD_NEON (0U)
+#endif
+
+#if defined(__AVX2__)
+#define DSP_SIMD_ISA "avx2"
+#elif defined(__ARM_NEON) && defined(__aarch64__) && (DSP_SIMD_NEON != 0U)
+#define DSP_SIMD_ISA "neon"
+#else
+#define DSP_SIMD_ISA "escalar"
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Equivalente a arm_lms_q15 */
+void DSP_SIMD_LmsQ15(const arm_lms_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					 q15_t *pErr, uint32_t blockSize);
+
+/* Equivalente a DSP_REF_IdentQ15 (planta y LMS fusionados). Devuelve la energia del error */
+q63_t DSP_SIMD_IdentQ15(const arm_lms_instance_q15 *S, const q15_t *pPlant, const q15_t *pSrc, q15_t *pRef,
+						q15_t *pOut, q15_t *pErr, uint32_t blockSize);
+
+/* Equivalente a arm_power_q15 */
+q63_t DSP_SIMD_PowerQ15(const q15_t *pSrc, uint32_t blockSize);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* DSP_SIMD_H_ */
@@ -0,0 +1,136 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    FDAF overlap-save (ver fdaf.h).
+	Los espectros estan en el formato empaquetado de arm_rfft_fast_f32: las posiciones
+	0 y 1 tienen los bins reales 0 y N, y luego pares Re/Im.
+ */
+
+#include "fdaf.h"
+
+/* dst = a .* b (o conj(a) .* b), espectros empaquetados de fftLen puntos reales */
+static void FDAF_CmplxMult(const float32_t *a, const float32_t *b, float32_t *dst, uint32_t fftLen, bool conjA)
+{
+	float32_t sign = conjA ? -1.0f : 1.0f;
+
+	dst[0] = a[0] * b[0];
+	dst[1] = a[1] * b[1];
+	for(uint32_t k = 2U; k < fftLen; k += 2U)
+	{
+		float32_t ar = a[k], ai = sign * a[k + 1U];
+		float32_t br = b[k], bi = b[k + 1U];
+		dst[k] = ar * br - ai * bi;
+		dst[k + 1U] = ar * bi + ai * br;
+	}
+}
+
+/* Conversion a q15 con saturacion (antes de convertir a entero, para no desbordar) */
+static inline q15_t FDAF_ToQ15(float32_t value)
+{
+	value *= 32768.0f;
+	if(value >= 32767.0f)
+	{
+		return INT16_MAX;
+	}
+	if(value <= -32768.0f)
+	{
+		return INT16_MIN;
+	}
+	return (q15_t)value;
+}
+
+arm_status FDAF_Init(fdaf_instance_f32 *S, uint16_t numTaps, float32_t *pBuffer, q15_t mu)
+{
+	uint32_t fftLen = 2U * numTaps;
+
+	if((numTaps < 16U) || ((numTaps & (numTaps - 1U)) != 0U))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	arm_status status = arm_rfft_fast_init_f32(&S->fft, (uint16_t)fftLen);
+	if(status != ARM_MATH_SUCCESS)
+	{
+		return status;
+	}
+
+	S->numTaps = numTaps;
+	/* El gradiente del bloque suma N muestras: se promedia para que mu tenga el limite de
+	 * estabilidad del LMS muestra a muestra (ver fdaf.h) */
+	S->mu = (float32_t)mu / (32768.0f * (float32_t)numTaps);
+	S->pW = &pBuffer[0];
+	S->pIn = &pBuffer[fftLen];
+	S->pX = &pBuffer[2U * fftLen];
+	S->pA = &pBuffer[3U * fftLen];
+	S->pB = &pBuffer[4U * fftLen];
+
+	/* Coeficientes y entradas anteriores en cero */
+	memset(pBuffer, 0, 2U * fftLen * sizeof(float32_t));
+
+	return ARM_MATH_SUCCESS;
+}
+
+void FDAF_Process(fdaf_instance_f32 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr,
+				  uint32_t blockSize)
+{
+	uint32_t numTaps = S->numTaps;
+	uint32_t fftLen = 2U * numTaps;
+	float32_t *pIn = S->pIn;
+	float32_t *pX = S->pX;
+	float32_t *pA = S->pA;
+	float32_t *pB = S->pB;
+
+	for(uint32_t start = 0; start < blockSize; start += numTaps)
+	{
+		/* Ventana de entrada: bloque anterior seguido del nuevo */
+		memcpy(pIn, &pIn[numTaps], numTaps * sizeof(float32_t));
+		for(uint32_t n = 0; n < numTaps; n++)
+		{
+			pIn[numTaps + n] = (float32_t)pSrc[start + n] / 32768.0f;
+		}
+
+		/* arm_rfft_fast_f32 modifica la entrada, por eso se trabaja sobre una copia */
+		memcpy(pA, pIn, fftLen * sizeof(float32_t));
+		arm_rfft_fast_f32(&S->fft, pA, pX, 0U);
+
+		/* Salida del filtro adaptativo: ultimas N muestras de la convolucion circular */
+		FDAF_CmplxMult(pX, S->pW, pA, fftLen, false);
+		arm_rfft_fast_f32(&S->fft, pA, pB, 1U);
+
+		memset(pA, 0, numTaps * sizeof(float32_t));
+		for(uint32_t n = 0; n < numTaps; n++)
+		{
+			q15_t y = FDAF_ToQ15(pB[numTaps + n]);
+			q31_t e = (q31_t)pRef[start + n] - y;
+
+			pOut[start + n] = y;
+			pErr[start + n] = (q15_t)__SSAT(e, 16);
+			pA[numTaps + n] = (float32_t)e / 32768.0f;
+		}
+
+		/* Gradiente restringido: primeras N muestras de la correlacion */
+		arm_rfft_fast_f32(&S->fft, pA, pB, 0U);
+		FDAF_CmplxMult(pX, pB, pA, fftLen, true);
+		arm_rfft_fast_f32(&S->fft, pA, pB, 1U);
+		memset(&pB[numTaps], 0, numTaps * sizeof(float32_t));
+		arm_rfft_fast_f32(&S->fft, pB, pA, 0U);
+
+		for(uint32_t k = 0; k < fftLen; k++)
+		{
+			S->pW[k] += S->mu * pA[k];
+		}
+	}
+}
+
+void FDAF_GetCoeffsQ15(fdaf_instance_f32 *S, q15_t *pCoeffs)
+{
+	uint32_t numTaps = S->numTaps;
+	uint32_t fftLen = 2U * numTaps;
+
+	memcpy(S->pA, S->pW, fftLen * sizeof(float32_t));
+	arm_rfft_fast_f32(&S->fft, S->pA, S->pB, 1U);
+
+	for(uint32_t k = 0; k < numTaps; k++)
+	{
+		pCoeffs[k] = FDAF_ToQ15(S->pB[numTaps - 1U - k]);
+	}
+}
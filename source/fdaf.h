@@ -0,0 +1,64 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Filtro adaptativo en frecuencia (FDAF, fast block LMS con overlap-save) para
+	plantas largas. Con N coeficientes se procesan bloques de N muestras usando FFT
+	reales de 2N puntos (arm_rfft_fast_f32), por lo que el costo por muestra es
+	O(log N) en lugar del O(N) del LMS en el tiempo:
+		X = FFT([x_anterior, x_nuevo])          y = ultimas N de IFFT(X .* W)
+		E = FFT([0, e])                          phi = primeras N de IFFT(conj(X) .* E)
+		W += mu * FFT([phi, 0])                  (gradiente restringido)
+	Es el mismo algoritmo que el LMS por bloques con L = N (lms_block.h). Se trabaja en
+	punto flotante (el M4F tiene FPU) con las muestras q15 escaladas a [-1, 1) y el
+	gradiente del bloque se divide por N, de modo que el limite de estabilidad en mu es
+	el de arm_lms_q15: un mu que funciona con el LMS no diverge aca. A cambio hay una
+	actualizacion cada N muestras y, con el mismo mu, la convergencia lleva unas N veces
+	mas muestras que con el LMS (con 256 taps y mu 30000 el LMS converge en la trama 224 y
+	el FDAF no en 3000). Sin dividir por N el mu estable es N veces menor (con 256 taps el
+	FDAF divergia con mu 3000) y se converge igual de lento. No se normaliza por la
+	potencia de cada bin para poder seguir observando el efecto de mu y de la potencia de
+	la señal, igual que con el LMS.
+	numTaps debe ser potencia de 2 entre 16 y 2048 y blockSize multiplo de numTaps.
+ */
+
+#ifndef FDAF_H_
+#define FDAF_H_
+
+#include "arm_math.h"
+#include <stdbool.h>
+
+/* Floats que necesita el buffer de trabajo para numTaps coeficientes */
+#define FDAF_BUFFER_LEN(numTaps) (10U * (numTaps))
+
+/* Instancia del FDAF */
+typedef struct _fdaf_instance_f32
+{
+	uint16_t numTaps;				/* N: coeficientes y muestras por bloque */
+	float32_t mu;
+	arm_rfft_fast_instance_f32 fft;	/* FFT real de 2N puntos */
+	float32_t *pW;					/* Espectro de los coeficientes (2N) */
+	float32_t *pIn;					/* Ultimas 2N muestras de entrada */
+	float32_t *pX;					/* Espectro de la entrada del bloque actual (2N) */
+	float32_t *pA;					/* Auxiliares (2N cada uno) */
+	float32_t *pB;
+} fdaf_instance_f32;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* pBuffer debe tener FDAF_BUFFER_LEN(numTaps) floats. mu en q15, como en arm_lms_init_q15 */
+arm_status FDAF_Init(fdaf_instance_f32 *S, uint16_t numTaps, float32_t *pBuffer, q15_t mu);
+
+/* Misma interfaz que arm_lms_q15. blockSize debe ser multiplo de numTaps */
+void FDAF_Process(fdaf_instance_f32 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr,
+				  uint32_t blockSize);
+
+/* Coeficientes en el tiempo, en q15 y en el mismo orden que usa CMSIS para el FIR
+ * (invertidos en el tiempo), para compararlos con los de la planta */
+void FDAF_GetCoeffsQ15(fdaf_instance_f32 *S, q15_t *pCoeffs);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* FDAF_H_ */
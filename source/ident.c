@@ -0,0 +1,355 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Motor de identificacion de planta independiente del hardware (ver ident.h).
+ */
+
+#include "ident.h"
+#include "prof.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+const q15_t g_identDefaultPlant[IDENT_DEFAULT_NUMTAPS] = {
+	5,		10,		20,		40,		80,	  160,	320,	640,	1320,	2640,
+	5280, 10560,	21120, 21120, 21120, 21120, 21120, 21120, 10560, 	5280,
+	2640, 	1320, 	640,	320, 	160, 	80, 	40, 	20, 	10, 	5};
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+void IDENT_GetDefaultConfig(ident_config_t *config)
+{
+	config->numTaps = IDENT_DEFAULT_NUMTAPS;
+	config->blockSize = 100U;
+	config->postShift = 0U;
+	config->plantCoeffs = g_identDefaultPlant;
+	config->io = NULL;
+	config->algorithm = kIDENT_AlgLms;
+	config->lmsRule = kLMS_RULE_Standard;
+	config->lmsLeak = 1;
+	config->subBlockSize = 0U;
+	config->fdafBuffer = NULL;
+	config->rlsBuffer = NULL;
+	config->rlsLambda = 0.999f;
+	config->rlsDelta = 0.001f;
+	config->apaBuffer = NULL;
+	config->apaOrder = 4U;
+	config->apaDelta = 0.0001f;
+	config->seed = 1U;
+	config->fusedKernel = (IDENT_FUSED_KERNEL != 0U);
+	config->variableMu = false;
+	VSS_GetDefaultConfig(&config->vss);
+}
+
+/* El FDAF necesita buffer, numTaps potencia de 2 (FFT de 2 * numTaps <= 4096 puntos)
+ * y tramas formadas por bloques enteros de numTaps muestras */
+static bool IDENT_FdafSupported(const ident_config_t *config)
+{
+	return (config->fdafBuffer != NULL) && (config->numTaps >= 16U) && (config->numTaps <= 2048U) &&
+		   ((config->numTaps & (config->numTaps - 1U)) == 0U) && ((config->blockSize % config->numTaps) == 0U);
+}
+
+arm_status IDENT_Init(ident_handle_t *handle, const ident_config_t *config)
+{
+	if((config->numTaps == 0U) || (config->numTaps > IDENT_MAX_TAPS) || (config->blockSize == 0U) ||
+	   (config->blockSize > IDENT_MAX_BLOCKSIZE) || (config->io == NULL) || (config->lmsRule >= kLMS_RULE_NumRules) ||
+	   (config->lmsLeak < 0))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	handle->numTaps = config->numTaps;
+	handle->blockSize = config->blockSize;
+	handle->postShift = config->postShift;
+	handle->src = config->io->src;
+	handle->ref = config->io->ref;
+	handle->out = config->io->out;
+	handle->err = config->io->err;
+	handle->algorithm = config->algorithm;
+	handle->lmsRule = config->lmsRule;
+	handle->lmsLeak = config->lmsLeak;
+	handle->variableMu = config->variableMu;
+	handle->vssConfig = config->vss;
+	handle->subBlockSize = config->subBlockSize;
+	handle->fdafBuffer = config->fdafBuffer;
+	handle->rlsBuffer = config->rlsBuffer;
+	handle->rlsLambda = config->rlsLambda;
+	handle->rlsDelta = config->rlsDelta;
+	handle->apaBuffer = config->apaBuffer;
+	handle->apaOrder = config->apaOrder;
+	handle->apaDelta = config->apaDelta;
+
+	/* Seleccion del algoritmo segun el largo de la planta */
+	if(handle->algorithm == kIDENT_AlgAuto)
+	{
+#if (IDENT_FDAF_MIN_TAPS != 0U)
+		handle->algorithm = ((config->numTaps >= IDENT_FDAF_MIN_TAPS) && IDENT_FdafSupported(config)) ?
+								kIDENT_AlgFdaf : kIDENT_AlgLms;
+#else
+		handle->algorithm = kIDENT_AlgLms;
+#endif
+	}
+	else if((handle->algorithm == kIDENT_AlgFdaf) && !IDENT_FdafSupported(config))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+	else if(((handle->algorithm == kIDENT_AlgRls) || (handle->algorithm == kIDENT_AlgRlsQ31)) &&
+			(config->rlsBuffer == NULL))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+	else if((handle->algorithm == kIDENT_AlgApa) &&
+			((config->apaBuffer == NULL) || (config->apaOrder == 0U) || (config->apaOrder > APA_MAX_ORDER)))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	/* El paso variable cambia el mu de la instancia entre tramas */
+	if(handle->variableMu && (((handle->algorithm != kIDENT_AlgLms) && (handle->algorithm != kIDENT_AlgBlockLms)) ||
+							  (VSS_CheckConfig(&config->vss) != ARM_MATH_SUCCESS)))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	/* Planta y LMS leen la misma señal: con el kernel fusionado se usa una sola linea de
+	 * retardo y una sola pasada por trama. Los kernels fusionados solo tienen la regla
+	 * del LMS estandar, con los coeficientes en q15 */
+	handle->fusedKernel = config->fusedKernel && (handle->algorithm == kIDENT_AlgLms) &&
+						  (handle->lmsRule == kLMS_RULE_Standard) && !handle->variableMu;
+#if (IDENT_SEPARATE_PLANT == 0U)
+	if(!handle->fusedKernel)
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+#endif
+
+	for(uint16_t i = 0; i < config->numTaps; i++)
+	{
+		handle->plantCoeffs[i] = config->plantCoeffs[i];
+		handle->lmsCoeffs[i] = 0;
+	}
+
+	PRNG_Init(&handle->prng, config->seed);
+
+#if (IDENT_SEPARATE_PLANT != 0U)
+	/* Filtro FIR (planta) */
+	arm_status status = arm_fir_init_q15(&handle->fir, handle->numTaps, handle->plantCoeffs,
+										 handle->firState, handle->blockSize);
+	if(status != ARM_MATH_SUCCESS)
+	{
+		return status;
+	}
+#endif
+
+	/* Filtro LMS. El mu definitivo se carga en IDENT_Restart() */
+	IDENT_Restart(handle, 0);
+
+	return ARM_MATH_SUCCESS;
+}
+
+void IDENT_Seed(ident_handle_t *handle, uint32_t seed)
+{
+	PRNG_Init(&handle->prng, seed);
+}
+
+void IDENT_Restart(ident_handle_t *handle, q15_t mu)
+{
+	if(handle->variableMu)
+	{
+		VSS_Init(&handle->vss, &handle->vssConfig, mu);
+		mu = VSS_GetMu(&handle->vss);
+	}
+
+	/* Se resetea el valor de los coficientes del filtro LMS*/
+	for(uint16_t i = 0; i < handle->numTaps; i++)
+	{
+		handle->lmsCoeffs[i] = 0;
+		handle->leakResidual[i] = 0;
+		handle->lmsCoeffsQ31[i] = 0;
+	}
+
+	/* Se inicializa el filtro adaptativo para una nueva deteccion de planta */
+	switch(handle->algorithm)
+	{
+		case kIDENT_AlgFdaf:
+			FDAF_Init(&handle->fdaf, handle->numTaps, handle->fdafBuffer, mu);
+			break;
+		case kIDENT_AlgRls:
+			RLS_InitF32(&handle->rls, handle->numTaps, handle->lmsState, handle->rlsBuffer, handle->rlsLambda,
+						handle->rlsDelta, handle->blockSize);
+			break;
+		case kIDENT_AlgRlsQ31:
+			RLS_InitQ31(&handle->rlsQ31, handle->numTaps, handle->lmsState, handle->rlsBuffer, handle->rlsLambda,
+						handle->rlsDelta, handle->blockSize);
+			break;
+		case kIDENT_AlgApa:
+			APA_Init(&handle->apa, handle->numTaps, handle->apaOrder, handle->apaBuffer, mu, handle->apaDelta,
+					 handle->blockSize);
+			break;
+		case kIDENT_AlgBlockLms:
+			LMS_BLOCK_Init(&handle->blms, handle->numTaps, handle->lmsCoeffs, handle->lmsState, handle->grad,
+						   mu, handle->blockSize, handle->subBlockSize, handle->postShift);
+			break;
+		case kIDENT_AlgLms:
+		default:
+			arm_lms_init_q15(&handle->lms, handle->numTaps, handle->lmsCoeffs, handle->lmsState,
+							 mu, handle->blockSize, handle->postShift);
+			break;
+	}
+}
+
+void IDENT_Resume(ident_handle_t *handle, q15_t mu)
+{
+	if(handle->variableMu)
+	{
+		VSS_Init(&handle->vss, &handle->vssConfig, mu);
+		mu = VSS_GetMu(&handle->vss);
+	}
+
+	switch(handle->algorithm)
+	{
+		case kIDENT_AlgBlockLms:
+			handle->blms.mu = mu;
+			break;
+		case kIDENT_AlgLms:
+			handle->lms.mu = mu;
+			/* Los coeficientes pueden venir de un checkpoint: se parte de ellos en q31 */
+			for(uint16_t i = 0; i < handle->numTaps; i++)
+			{
+				handle->lmsCoeffsQ31[i] = (q31_t)handle->lmsCoeffs[i] << 16;
+			}
+			break;
+		default:
+			IDENT_Restart(handle, mu);
+			break;
+	}
+}
+
+/* Planta, filtro adaptativo y MSE de la trama que esta en handle->src. Con externalRef
+ * la salida de la planta ya esta en handle->ref y no se calcula */
+static q31_t IDENT_Process(ident_handle_t *handle, bool externalRef)
+{
+	uint32_t blockSize = handle->blockSize;
+	bool fused = handle->fusedKernel && !externalRef;
+
+#if (IDENT_SEPARATE_PLANT != 0U)
+	/* Con el kernel fusionado la planta se calcula (y se mide) junto con el LMS */
+	if(!handle->fusedKernel && !externalRef)
+	{
+		PROF_BEGIN(kPROF_Plant);
+		arm_fir_q15(&handle->fir, handle->src, handle->ref, blockSize);
+		PROF_END(kPROF_Plant);
+	}
+#endif
+
+	/* Energia del error de la trama. Los kernels fusionados la acumulan mientras
+	 * calculan el error, sin volver a recorrer handle->err */
+	q63_t energy = 0;
+	bool haveEnergy = false;
+
+	PROF_BEGIN(kPROF_Adapt);
+	switch(handle->algorithm)
+	{
+		case kIDENT_AlgFdaf:
+			FDAF_Process(&handle->fdaf, handle->src, handle->ref, handle->out, handle->err, blockSize);
+			/* Se mantienen los coeficientes en el tiempo para la trama de salida */
+			FDAF_GetCoeffsQ15(&handle->fdaf, handle->lmsCoeffs);
+			break;
+		case kIDENT_AlgRls:
+			RLS_ProcessF32(&handle->rls, handle->src, handle->ref, handle->out, handle->err, blockSize);
+			RLS_GetCoeffsF32(&handle->rls, handle->lmsCoeffs);
+			break;
+		case kIDENT_AlgRlsQ31:
+			RLS_ProcessQ31(&handle->rlsQ31, handle->src, handle->ref, handle->out, handle->err, blockSize);
+			RLS_GetCoeffsQ31(&handle->rlsQ31, handle->lmsCoeffs);
+			break;
+		case kIDENT_AlgApa:
+			APA_Process(&handle->apa, handle->src, handle->ref, handle->out, handle->err, blockSize);
+			APA_GetCoeffsQ15(&handle->apa, handle->lmsCoeffs);
+			break;
+		case kIDENT_AlgBlockLms:
+			LMS_BLOCK_Process(&handle->blms, handle->src, handle->ref, handle->out, handle->err, blockSize);
+			break;
+		case kIDENT_AlgLms:
+		default:
+			/* Con paso variable mu baja despues de converger y en q15 el paso se anularia */
+			if(handle->variableMu && (handle->lmsRule == kLMS_RULE_Standard))
+			{
+				energy = LMS_RULE_ProcessQ31Coeffs(&handle->lms, handle->lmsCoeffsQ31, handle->src, handle->ref,
+												   handle->out, handle->err, blockSize);
+				haveEnergy = true;
+			}
+			else if(handle->lmsRule != kLMS_RULE_Standard)
+			{
+				energy = LMS_RULE_ProcessQ15(&handle->lms, handle->lmsRule, handle->lmsLeak, handle->leakResidual,
+											 handle->src, handle->ref, handle->out, handle->err, blockSize);
+				haveEnergy = true;
+			}
+			else if(fused)
+			{
+				energy = DSP_SIMD_IdentQ15(&handle->lms, handle->plantCoeffs, handle->src, handle->ref,
+										   handle->out, handle->err, blockSize);
+				haveEnergy = true;
+			}
+			else
+			{
+				arm_lms_q15(&handle->lms, handle->src, handle->ref, handle->out, handle->err, blockSize);
+			}
+			break;
+	}
+	PROF_END(kPROF_Adapt);
+
+	/* Se computa el MSE de la trama. La energia se acumula en 64 bits: en 32 bits
+	 * desbordaba con errores grandes (100 muestras de 2^15 suman 100 * 2^30) */
+	PROF_BEGIN(kPROF_Mse);
+	if(!haveEnergy)
+	{
+		arm_power_q15(handle->err, blockSize, &energy);
+	}
+	q31_t mse = (q31_t)(energy / (q63_t)blockSize);
+
+	/* mu de la trama siguiente */
+	if(handle->variableMu)
+	{
+		q15_t mu = VSS_Update(&handle->vss, mse);
+		handle->lms.mu = mu;
+		handle->blms.mu = mu;
+	}
+	PROF_END(kPROF_Mse);
+
+	return mse;
+}
+
+q31_t IDENT_ProcessFrame(ident_handle_t *handle, q15_t signalPower)
+{
+	/* Se construye la señal aleatoria. Se usan los 11 bits mas significativos
+	 * de cada valor (como rand() >> 20) para que sea una señal pequeña y no
+	 * sature el calculo del filtro.
+	 * Recordar que la amplitud de señal de entrada y mu tienen una
+	 * relacion de compromiso para la velocidad de convergencia del
+	 * algoritmo. Si mu es muy grande o la señal de entrada es muy
+	 * grande, el algoritmo puede diverger.
+	 */
+	PROF_BEGIN(kPROF_Input);
+	PRNG_FillQ15(&handle->prng, handle->src, 11U, signalPower, handle->blockSize);
+	PROF_END(kPROF_Input);
+
+	return IDENT_Process(handle, false);
+}
+
+q31_t IDENT_ProcessBlock(ident_handle_t *handle, const q15_t *pSrc, const q15_t *pRef)
+{
+	/* Las muestras se copian porque los kernels de CMSIS no reciben punteros const y el
+	 * bloque se devuelve al productor apenas termina la trama */
+	PROF_BEGIN(kPROF_Input);
+	memcpy(handle->src, pSrc, handle->blockSize * sizeof(q15_t));
+	if(pRef != NULL)
+	{
+		memcpy(handle->ref, pRef, handle->blockSize * sizeof(q15_t));
+	}
+	PROF_END(kPROF_Input);
+
+	return IDENT_Process(handle, pRef != NULL);
+}
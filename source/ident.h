@@ -0,0 +1,230 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Motor de identificacion de planta independiente del hardware.
+	Agrupa el lazo que antes estaba en main(): generacion de la señal aleatoria (prng.h),
+	planta FIR, filtro adaptativo LMS y calculo del MSE de cada trama. No depende
+	de la placa (board, GPIO, UART), por lo que se compila tanto para el K64F como
+	para un host Linux (ver host/ident_host.c), donde las funciones de CMSIS-DSP
+	las provee source/arm_math_port.c.
+
+	Los buffers se dimensionan en tiempo de compilacion con IDENT_MAX_TAPS e
+	IDENT_MAX_BLOCKSIZE (por defecto, los valores del firmware). En tiempo de
+	ejecucion se puede usar cualquier numTaps/blockSize menor o igual a esos maximos.
+
+	Los bloques de entrada y salida de cada trama (ident_io_t) estan fuera del handle, que
+	guarda los coeficientes y las lineas de retardo, para poder ubicarlos en otra region
+	de RAM: en el K64F el handle va en SRAM_L y los bloques en SRAM_U (ver mem_plan.h).
+ */
+
+#ifndef IDENT_H_
+#define IDENT_H_
+
+#include "arm_math.h"
+#include "lms_block.h"
+#include "fdaf.h"
+#include "rls.h"
+#include "apa.h"
+#include "prng.h"
+#include "lms_rule.h"
+#include "vss.h"
+#include "dsp_simd.h"
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+#ifndef IDENT_MAX_TAPS
+#define IDENT_MAX_TAPS (30U)
+#endif
+
+#ifndef IDENT_MAX_BLOCKSIZE
+#define IDENT_MAX_BLOCKSIZE (100U)
+#endif
+
+/* Con kIDENT_AlgAuto se usa el FDAF a partir de esta cantidad de taps (0 = nunca). Debe
+ * salir de comparar el costo por muestra del LMS y del FDAF en cada destino, y el FDAF
+ * ademas converge mas lento con el mismo mu (ver fdaf.h). En el host el FDAF cuesta de 2.5
+ * a 3.5 veces mas que el LMS en todo su rango (de 128 a 2048 taps con tramas de numTaps
+ * muestras: 204 contra 66 ns por muestra con 128 taps y 1967 contra 618 con 2048,
+ * planta incluida), por lo que no hay cruce. En la placa todavia no se midio: la etapa
+ * adapt del perfil (prof.h) da los ciclos de cada uno para fijarlo con
+ * -DIDENT_FDAF_MIN_TAPS=... */
+#ifndef IDENT_FDAF_MIN_TAPS
+#define IDENT_FDAF_MIN_TAPS (0U)
+#endif
+
+/* Con 0 la planta solo se calcula con el kernel fusionado, sobre la linea de retardo del
+ * LMS: el handle no reserva firState ni la instancia de arm_fir_q15, (IDENT_MAX_TAPS +
+ * IDENT_MAX_BLOCKSIZE - 1) * 2 + 12 bytes menos (270 bytes con 30 taps y tramas de 100),
+ * e IDENT_Init() rechaza las configuraciones que no se pueden fusionar (otro algoritmo,
+ * otra regla, variableMu o fusedKernel en falso). Con 1 (por defecto) estan los dos
+ * caminos y firState solo se usa sin el kernel fusionado */
+#ifndef IDENT_SEPARATE_PLANT
+#define IDENT_SEPARATE_PLANT (1U)
+#endif
+
+/* Valor por defecto de fusedKernel. En el firmware el kernel fusionado es el de
+ * dsp_ref.c en lugar de arm_fir_q15 y arm_lms_q15, y todavia no se midio en la placa,
+ * por lo que ahi queda desactivado salvo que no se compile la planta por separado */
+#ifndef IDENT_FUSED_KERNEL
+#if defined(ARM_MATH_DSP) && (IDENT_SEPARATE_PLANT != 0U)
+#define IDENT_FUSED_KERNEL (0U)
+#else
+#define IDENT_FUSED_KERNEL (1U)
+#endif
+#endif
+
+/* Largo de la planta por defecto (g_identDefaultPlant) */
+#define IDENT_DEFAULT_NUMTAPS (30U)
+
+/* Algoritmo de adaptacion */
+typedef enum _ident_algorithm
+{
+	kIDENT_AlgLms = 0U,		/* arm_lms_q15: actualizacion muestra a muestra */
+	kIDENT_AlgBlockLms,		/* LMS por bloques: una actualizacion cada subBlockSize muestras */
+	kIDENT_AlgFdaf,			/* LMS por bloques en frecuencia (overlap-save), para plantas largas */
+	kIDENT_AlgRls,			/* RLS en punto flotante */
+	kIDENT_AlgRlsQ31,		/* RLS en punto fijo */
+	kIDENT_AlgApa,			/* Proyeccion afin de orden apaOrder */
+	kIDENT_AlgAuto,			/* FDAF si IDENT_FDAF_MIN_TAPS no es 0, numTaps >= IDENT_FDAF_MIN_TAPS y
+							 * es posible, si no LMS */
+} ident_algorithm_t;
+
+/* Bloques de entrada y salida de una trama */
+typedef struct _ident_io
+{
+	q15_t src[IDENT_MAX_BLOCKSIZE];	/* Entrada de planta y filtro */
+	q15_t ref[IDENT_MAX_BLOCKSIZE];	/* Salida de la planta */
+	q15_t out[IDENT_MAX_BLOCKSIZE];	/* Salida del filtro adaptativo */
+	q15_t err[IDENT_MAX_BLOCKSIZE];	/* Error */
+} ident_io_t;
+
+/* Configuracion del motor de identificacion */
+typedef struct _ident_config
+{
+	uint16_t numTaps;			/* Cantidad de coeficientes de planta y filtro adaptativo */
+	uint32_t blockSize;			/* Muestras por trama */
+	uint32_t postShift;			/* Post shift del filtro LMS */
+	const q15_t *plantCoeffs;	/* Respuesta al impulso de la planta (numTaps valores) */
+	ident_io_t *io;				/* Bloques de entrada y salida de la trama */
+	ident_algorithm_t algorithm;
+	lms_rule_t lmsRule;			/* Solo kIDENT_AlgLms: regla de actualizacion (lms_rule.h) */
+	q15_t lmsLeak;				/* Solo kLMS_RULE_Leaky: fuga por trama en q15, 0 a 32767 */
+	uint32_t subBlockSize;		/* Solo kIDENT_AlgBlockLms. 0 = una actualizacion por trama */
+	float32_t *fdafBuffer;		/* FDAF_BUFFER_LEN(numTaps) floats, o NULL si no se usa el FDAF */
+	void *rlsBuffer;			/* RLS_BUFFER_SIZE(numTaps) bytes, o NULL si no se usa el RLS */
+	float32_t rlsLambda;		/* Factor de olvido del RLS */
+	float32_t rlsDelta;			/* P inicial = I / rlsDelta */
+	void *apaBuffer;			/* APA_BUFFER_SIZE(numTaps, blockSize) bytes, o NULL si no se usa el APA */
+	uint16_t apaOrder;			/* Orden K de la proyeccion, 1 a APA_MAX_ORDER */
+	float32_t apaDelta;			/* Regularizacion de la matriz de Gram */
+	uint32_t seed;				/* Semilla del generador de la señal de entrada */
+	bool fusedKernel;			/* Con kIDENT_AlgLms, planta y LMS en una pasada sobre una linea de retardo */
+	bool variableMu;			/* Solo LMS y LMS por bloques: mu se adapta en cada trama (vss.h). El
+								 * LMS estandar acumula entonces los coeficientes en q31 */
+	vss_config_t vss;
+} ident_config_t;
+
+/* Estado del motor de identificacion */
+typedef struct _ident_handle
+{
+#if (IDENT_SEPARATE_PLANT != 0U)
+	arm_fir_instance_q15 fir;	/* Planta sin el kernel fusionado */
+#endif
+	arm_lms_instance_q15 lms;	/* Filtro adaptativo */
+	lms_block_instance_q15 blms;
+	fdaf_instance_f32 fdaf;
+	rls_instance_f32 rls;
+	rls_instance_q31 rlsQ31;
+	apa_instance_f32 apa;
+	prng_instance_t prng;		/* Generador de la señal de entrada */
+	float32_t *fdafBuffer;
+	void *rlsBuffer;
+	float32_t rlsLambda;
+	float32_t rlsDelta;
+	void *apaBuffer;
+	uint16_t apaOrder;
+	float32_t apaDelta;
+	ident_algorithm_t algorithm;
+	lms_rule_t lmsRule;
+	q15_t lmsLeak;
+	uint32_t subBlockSize;
+	uint16_t numTaps;
+	uint32_t blockSize;
+	uint32_t postShift;
+	bool fusedKernel;			/* La planta usa la linea de retardo del LMS (lmsState) y no firState.
+								 * Solo con kLMS_RULE_Standard y sin variableMu */
+	bool variableMu;
+	vss_config_t vssConfig;
+	vss_instance_t vss;			/* mu de la trama siguiente con variableMu */
+
+	q15_t plantCoeffs[IDENT_MAX_TAPS];
+	q15_t lmsCoeffs[IDENT_MAX_TAPS];
+#if (IDENT_SEPARATE_PLANT != 0U)
+	q15_t firState[IDENT_MAX_TAPS + IDENT_MAX_BLOCKSIZE - 1U];
+#endif
+	q15_t lmsState[IDENT_MAX_TAPS + IDENT_MAX_BLOCKSIZE - 1U];
+	q63_t grad[IDENT_MAX_TAPS];	/* Gradiente acumulado del LMS por bloques */
+	q31_t leakResidual[IDENT_MAX_TAPS];	/* Fuga pendiente de cada tap con kLMS_RULE_Leaky */
+	q31_t lmsCoeffsQ31[IDENT_MAX_TAPS];	/* Coeficientes del LMS en q31 con variableMu */
+
+	/* Buffers auxiliares para computar algoritmo LMS (en config->io) */
+	q15_t *src;
+	q15_t *ref;
+	q15_t *out;
+	q15_t *err;
+} ident_handle_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Planta de 30 coeficientes usada por el firmware */
+extern const q15_t g_identDefaultPlant[IDENT_DEFAULT_NUMTAPS];
+
+/* Carga la configuracion del firmware: 30 taps, tramas de 100 muestras, postShift 0, LMS.
+ * io queda en NULL y debe indicarse */
+void IDENT_GetDefaultConfig(ident_config_t *config);
+
+/* Inicializa la planta y el filtro adaptativo. Devuelve ARM_MATH_ARGUMENT_ERROR si
+ * numTaps o blockSize son 0 o superan los maximos de compilacion, si falta io, si la regla
+ * del LMS no existe o lmsLeak es negativo, si se pide variableMu con un algoritmo que no
+ * sea LMS o LMS por bloques o con un vss invalido (VSS_CheckConfig), si se pide el FDAF
+ * y no se cumplen sus condiciones (ver fdaf.h) o si se pide el RLS o el APA sin buffer
+ * (o con un orden fuera de rango). kIDENT_AlgAuto se resuelve aca. */
+arm_status IDENT_Init(ident_handle_t *handle, const ident_config_t *config);
+
+/* Reinicia el generador de la señal de entrada con otra semilla */
+void IDENT_Seed(ident_handle_t *handle, uint32_t seed);
+
+/* Pone a cero los coeficientes del filtro adaptativo y lo reinicia con el mu indicado
+ * (con variableMu, el mu inicial).
+ * El generador de la señal de entrada continua su secuencia. Con fusedKernel la linea
+ * de retardo es compartida, por lo que la planta tambien arranca sin historia */
+void IDENT_Restart(ident_handle_t *handle, q15_t mu);
+
+/* Como IDENT_Restart() pero conserva los coeficientes y las lineas de retardo, para
+ * arrancar en caliente desde la solucion anterior o un checkpoint (ident_ckpt.h). Solo
+ * cambia el mu; con FDAF, RLS y APA equivale a IDENT_Restart() */
+void IDENT_Resume(ident_handle_t *handle, q15_t mu);
+
+/* Procesa una trama de blockSize muestras y devuelve el MSE de la trama (energia del
+ * error en 64 bits dividida por blockSize, siempre entre 0 y 2^30) */
+q31_t IDENT_ProcessFrame(ident_handle_t *handle, q15_t signalPower);
+
+/* Como IDENT_ProcessFrame() pero con blockSize muestras de entrada adquiridas (pSrc, por
+ * ejemplo de adc_stream.h) en lugar de la señal generada. Si pRef no es NULL es la salida
+ * medida de la planta y se identifica esa planta real; si es NULL la salida se calcula
+ * con plantCoeffs como siempre. Con pRef no se usa el kernel fusionado (la planta no se
+ * calcula). El generador de la señal de entrada no avanza */
+q31_t IDENT_ProcessBlock(ident_handle_t *handle, const q15_t *pSrc, const q15_t *pRef);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* IDENT_H_ */
@@ -0,0 +1,199 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Checkpoint del motor de identificacion (ver ident_ckpt.h).
+ */
+
+#include "ident_ckpt.h"
+#include "telemetry.h"
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+static inline uint8_t *IDENT_CKPT_PutU16(uint8_t *p, uint16_t value)
+{
+	p[0] = (uint8_t)(value & 0x0FFU);
+	p[1] = (uint8_t)(value >> 8);
+	return p + 2;
+}
+
+static inline uint8_t *IDENT_CKPT_PutU32(uint8_t *p, uint32_t value)
+{
+	p = IDENT_CKPT_PutU16(p, (uint16_t)(value & 0x0FFFFU));
+	return IDENT_CKPT_PutU16(p, (uint16_t)(value >> 16));
+}
+
+static inline uint16_t IDENT_CKPT_GetU16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline uint32_t IDENT_CKPT_GetU32(const uint8_t *p)
+{
+	return IDENT_CKPT_GetU16(p) | ((uint32_t)IDENT_CKPT_GetU16(&p[2]) << 16);
+}
+
+static uint8_t *IDENT_CKPT_PutQ15s(uint8_t *p, const q15_t *values, uint32_t count)
+{
+	for(uint32_t i = 0; i < count; i++)
+	{
+		p = IDENT_CKPT_PutU16(p, (uint16_t)values[i]);
+	}
+	return p;
+}
+
+static const uint8_t *IDENT_CKPT_GetQ15s(const uint8_t *p, q15_t *values, uint32_t count)
+{
+	for(uint32_t i = 0; i < count; i++)
+	{
+		values[i] = (q15_t)IDENT_CKPT_GetU16(p);
+		p += 2;
+	}
+	return p;
+}
+
+/* CRC de la planta con los coeficientes en little-endian, como en el bloque */
+static uint16_t IDENT_CKPT_PlantCrc(const ident_handle_t *handle)
+{
+	uint16_t crc = 0xFFFFU;
+
+	for(uint16_t i = 0; i < handle->numTaps; i++)
+	{
+		uint8_t value[2];
+		IDENT_CKPT_PutU16(value, (uint16_t)handle->plantCoeffs[i]);
+		crc = TELEMETRY_Crc16(crc, value, sizeof(value));
+	}
+	return crc;
+}
+
+/* Algoritmos cuyo estado esta completo en lmsCoeffs y lmsState */
+static inline bool IDENT_CKPT_Supported(ident_algorithm_t algorithm)
+{
+	return (algorithm == kIDENT_AlgLms) || (algorithm == kIDENT_AlgBlockLms);
+}
+
+uint32_t IDENT_CKPT_Save(const ident_handle_t *handle, const ident_ckpt_info_t *info, uint8_t *pDst,
+						 uint32_t size)
+{
+	uint32_t numTaps = handle->numTaps;
+	uint32_t history = numTaps - 1U;
+	bool plantHistory = !handle->fusedKernel;
+	uint32_t total = IDENT_CKPT_SIZE(numTaps) - (plantHistory ? 0U : (2U * history));
+
+	if(!IDENT_CKPT_Supported(handle->algorithm) || (size < total))
+	{
+		return 0U;
+	}
+
+	uint8_t *p = pDst;
+	*p++ = 'I';
+	*p++ = 'K';
+	*p++ = (uint8_t)IDENT_CKPT_VERSION;
+	*p++ = (uint8_t)handle->algorithm;
+	p = IDENT_CKPT_PutU16(p, handle->numTaps);
+	p = IDENT_CKPT_PutU16(p, (uint16_t)handle->blockSize);
+	*p++ = plantHistory ? 1U : 0U;
+	*p++ = (uint8_t)handle->postShift;
+	p = IDENT_CKPT_PutU16(p, (uint16_t)info->mu);
+	p = IDENT_CKPT_PutU16(p, (uint16_t)info->signalPower);
+	p = IDENT_CKPT_PutU32(p, info->frames);
+	p = IDENT_CKPT_PutU32(p, (uint32_t)info->mse);
+	p = IDENT_CKPT_PutU16(p, IDENT_CKPT_PlantCrc(handle));
+
+	/* Entre tramas la historia de cada linea de retardo esta al principio del buffer
+	 * (formato de CMSIS) */
+	p = IDENT_CKPT_PutQ15s(p, handle->lmsCoeffs, numTaps);
+	p = IDENT_CKPT_PutQ15s(p, handle->lmsState, history);
+#if (IDENT_SEPARATE_PLANT != 0U)
+	if(plantHistory)
+	{
+		p = IDENT_CKPT_PutQ15s(p, handle->firState, history);
+	}
+#endif
+	for(uint32_t k = 0; k < 4U; k++)
+	{
+		for(uint32_t lane = 0; lane < PRNG_LANES; lane++)
+		{
+			p = IDENT_CKPT_PutU32(p, handle->prng.s[k][lane]);
+		}
+	}
+
+	p = IDENT_CKPT_PutU16(p, TELEMETRY_Crc16(0xFFFFU, pDst, (uint32_t)(p - pDst)));
+	return (uint32_t)(p - pDst);
+}
+
+arm_status IDENT_CKPT_Load(ident_handle_t *handle, const uint8_t *pSrc, uint32_t size, ident_ckpt_info_t *info)
+{
+	if(size < IDENT_CKPT_HEADER_SIZE)
+	{
+		return ARM_MATH_LENGTH_ERROR;
+	}
+	if((pSrc[0] != 'I') || (pSrc[1] != 'K') || (pSrc[2] != IDENT_CKPT_VERSION))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	uint32_t numTaps = IDENT_CKPT_GetU16(&pSrc[4]);
+	uint32_t history = numTaps - 1U;
+	bool plantHistory = ((pSrc[8] & 1U) != 0U);
+	uint32_t total = IDENT_CKPT_SIZE(numTaps) - (plantHistory ? 0U : (2U * history));
+
+	if((numTaps == 0U) || (size < total))
+	{
+		return ARM_MATH_LENGTH_ERROR;
+	}
+	if(TELEMETRY_Crc16(0xFFFFU, pSrc, total - 2U) != IDENT_CKPT_GetU16(&pSrc[total - 2U]))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+	if(numTaps != handle->numTaps)
+	{
+		return ARM_MATH_SIZE_MISMATCH;
+	}
+	if(!IDENT_CKPT_Supported((ident_algorithm_t)pSrc[3]) || !IDENT_CKPT_Supported(handle->algorithm) ||
+	   (IDENT_CKPT_GetU16(&pSrc[22]) != IDENT_CKPT_PlantCrc(handle)))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+
+	if(info != NULL)
+	{
+		info->mu = (q15_t)IDENT_CKPT_GetU16(&pSrc[10]);
+		info->signalPower = (q15_t)IDENT_CKPT_GetU16(&pSrc[12]);
+		info->frames = IDENT_CKPT_GetU32(&pSrc[14]);
+		info->mse = (q31_t)IDENT_CKPT_GetU32(&pSrc[18]);
+	}
+
+	const uint8_t *p = &pSrc[IDENT_CKPT_HEADER_SIZE];
+	p = IDENT_CKPT_GetQ15s(p, handle->lmsCoeffs, numTaps);
+	p = IDENT_CKPT_GetQ15s(p, handle->lmsState, history);
+
+	/* Planta y LMS leen la misma entrada: si el bloque viene del kernel fusionado la
+	 * historia de la planta es la del LMS */
+#if (IDENT_SEPARATE_PLANT != 0U)
+	if(plantHistory)
+	{
+		p = IDENT_CKPT_GetQ15s(p, handle->firState, history);
+	}
+	else
+	{
+		memcpy(handle->firState, handle->lmsState, history * sizeof(q15_t));
+	}
+#else
+	/* Sin planta separada la historia de la planta es la del LMS */
+	if(plantHistory)
+	{
+		p += 2U * history;
+	}
+#endif
+	for(uint32_t k = 0; k < 4U; k++)
+	{
+		for(uint32_t lane = 0; lane < PRNG_LANES; lane++)
+		{
+			handle->prng.s[k][lane] = IDENT_CKPT_GetU32(p);
+			p += 4;
+		}
+	}
+
+	return ARM_MATH_SUCCESS;
+}
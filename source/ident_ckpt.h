@@ -0,0 +1,87 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Checkpoint del motor de identificacion para arrancar en caliente. Guarda en un
+	bloque de bytes compacto los coeficientes del filtro adaptativo, la historia de la
+	linea de retardo (las ultimas numTaps - 1 muestras de entrada) y el estado del
+	generador de la señal de entrada, de modo que una nueva deteccion de planta puede
+	seguir desde la ultima solucion en lugar de volver a converger desde cero.
+
+	El bloque no tiene punteros ni relleno (enteros little-endian, como la telemetria) y
+	termina con un CRC-16/CCITT (TELEMETRY_Crc16), por lo que se puede guardar tal cual
+	en RAM, en flash o en un archivo del host. Formato de la version 1:
+		Byte    | Dato
+		0..1    | 'I' 'K'
+		2       | IDENT_CKPT_VERSION
+		3       | Algoritmo (ident_algorithm_t)
+		4..5    | numTaps
+		6..7    | blockSize
+		8       | Flags: bit 0, con historia propia de la planta (sin kernel fusionado)
+		9       | postShift
+		10..11  | mu de la corrida
+		12..13  | signal_power de la corrida
+		14..17  | Tramas procesadas
+		18..21  | MSE de referencia (ident_ckpt_info_t)
+		22..23  | CRC-16 de los coeficientes de la planta
+		24..    | numTaps coeficientes, numTaps - 1 muestras de historia del LMS,
+		        | numTaps - 1 de la planta (si bit 0), estado del PRNG y CRC-16 de todo lo anterior
+
+	Solo el LMS muestra a muestra y el LMS por bloques guardan todo su estado en el
+	handle; con el resto de los algoritmos (FDAF, RLS, APA) el estado esta en sus
+	buffers de trabajo y el checkpoint no esta soportado.
+ */
+
+#ifndef IDENT_CKPT_H_
+#define IDENT_CKPT_H_
+
+#include "ident.h"
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+#define IDENT_CKPT_VERSION (1U)
+
+/* Bytes de cabecera y tamaño maximo del bloque para numTaps coeficientes */
+#define IDENT_CKPT_HEADER_SIZE (24U)
+#define IDENT_CKPT_SIZE(numTaps) \
+	(IDENT_CKPT_HEADER_SIZE + (2U * (uint32_t)(numTaps)) + (4U * ((uint32_t)(numTaps) - 1U)) + \
+	 (uint32_t)sizeof(prng_instance_t) + 2U)
+#define IDENT_CKPT_MAX_SIZE IDENT_CKPT_SIZE(IDENT_MAX_TAPS)
+
+/* Datos de la corrida que se guardan junto con el estado */
+typedef struct _ident_ckpt_info
+{
+	q15_t mu;
+	q15_t signalPower;
+	uint32_t frames;	/* Tramas procesadas hasta el checkpoint */
+	q31_t mse;			/* MSE al guardarlo (informativo) */
+} ident_ckpt_info_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Guarda el estado del handle en pDst. Devuelve los bytes escritos, o 0 si el algoritmo
+ * no esta soportado o no alcanzan los size bytes. Se llama entre tramas */
+uint32_t IDENT_CKPT_Save(const ident_handle_t *handle, const ident_ckpt_info_t *info, uint8_t *pDst,
+						 uint32_t size);
+
+/* Restaura coeficientes, lineas de retardo y generador desde un bloque de size bytes.
+ * El mu del filtro no cambia: despues se llama a IDENT_Resume(). Si info no es NULL se
+ * copian ahi los datos de la corrida. Devuelve:
+ *  - ARM_MATH_LENGTH_ERROR si el bloque es mas corto que lo que indica su cabecera,
+ *  - ARM_MATH_ARGUMENT_ERROR si no es un checkpoint valido (marca, version o CRC), si es
+ *    de otra planta o si el algoritmo no esta soportado,
+ *  - ARM_MATH_SIZE_MISMATCH si numTaps no coincide con el del handle.
+ * Con error el handle no se modifica. LMS y LMS por bloques comparten el formato */
+arm_status IDENT_CKPT_Load(ident_handle_t *handle, const uint8_t *pSrc, uint32_t size, ident_ckpt_info_t *info);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* IDENT_CKPT_H_ */
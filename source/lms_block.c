@@ -0,0 +1,77 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    LMS por bloques en q15 (ver lms_block.h).
+	Los dos lazos internos recorren los taps con coeficientes (o alpha) fijos, sin
+	dependencia entre iteraciones, por lo que el compilador los vectoriza.
+ */
+
+#include "lms_block.h"
+#include "dsp_ref.h"
+
+void LMS_BLOCK_Init(lms_block_instance_q15 *S, uint16_t numTaps, q15_t *pCoeffs, q15_t *pState, q63_t *pGrad,
+					q15_t mu, uint32_t blockSize, uint32_t subBlockSize, uint32_t postShift)
+{
+	S->numTaps = numTaps;
+	S->pCoeffs = pCoeffs;
+	S->pState = pState;
+	S->pGrad = pGrad;
+	S->mu = mu;
+	S->postShift = postShift;
+	S->subBlockSize = ((subBlockSize == 0U) || (subBlockSize > blockSize)) ? blockSize : subBlockSize;
+
+	memset(pState, 0, (numTaps + (blockSize - 1U)) * sizeof(q15_t));
+}
+
+void LMS_BLOCK_Process(const lms_block_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					   q15_t *pErr, uint32_t blockSize)
+{
+	q15_t *pState = S->pState;
+	q15_t *pCoeffs = S->pCoeffs;
+	q63_t *pGrad = S->pGrad;
+	uint16_t numTaps = S->numTaps;
+	q15_t mu = S->mu;
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+
+	for(uint32_t start = 0; start < blockSize; start += S->subBlockSize)
+	{
+		uint32_t end = start + S->subBlockSize;
+		if(end > blockSize)
+		{
+			end = blockSize;
+		}
+
+		memset(pGrad, 0, numTaps * sizeof(q63_t));
+
+		for(uint32_t n = start; n < end; n++)
+		{
+			const q15_t *px = &pState[n];
+
+			/* Salida con los coeficientes del sub-bloque */
+			q63_t acc = 0;
+			for(uint16_t k = 0; k < numTaps; k++)
+			{
+				acc += (q31_t)px[k] * pCoeffs[k];
+			}
+
+			q31_t e = DSP_REF_LmsOutput(acc, pRef[n], S->postShift, &pOut[n]);
+			pErr[n] = (q15_t)e;
+			q31_t alpha = (q15_t)((e * mu) >> 15);
+
+			/* Se acumula el gradiente */
+			for(uint16_t k = 0; k < numTaps; k++)
+			{
+				pGrad[k] += alpha * px[k];
+			}
+		}
+
+		/* Una sola actualizacion por sub-bloque */
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			q63_t coef = (q63_t)pCoeffs[k] + (pGrad[k] >> 15);
+			pCoeffs[k] = (q15_t)((coef > INT16_MAX) ? INT16_MAX : ((coef < INT16_MIN) ? INT16_MIN : coef));
+		}
+	}
+
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+}
@@ -0,0 +1,49 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    LMS por bloques (block LMS) en q15.
+	A diferencia de arm_lms_q15, que actualiza los numTaps coeficientes despues de cada
+	muestra, aca los coeficientes quedan fijos durante un sub-bloque de L muestras:
+		y[n]  = w . x(n)                        (producto matriz-vector X * w)
+		e[n]  = ref[n] - y[n]
+		g[k]  = sum_n alpha[n] * x[n - k]       (producto X^T * alpha)
+		w[k] += g[k] >> 15                       (una sola actualizacion por sub-bloque)
+	con alpha[n] = (e[n] * mu) >> 15. Salida, error y alpha se redondean igual que en
+	arm_lms_q15 (ver dsp_ref.h). Como se suman las L actualizaciones, el paso efectivo
+	por muestra es el mismo que en el LMS muestra a muestra y las curvas de MSE son
+	comparables; el limite de estabilidad en mu es mas estricto cuanto mayor es L.
+ */
+
+#ifndef LMS_BLOCK_H_
+#define LMS_BLOCK_H_
+
+#include "arm_math.h"
+
+/* Instancia del LMS por bloques */
+typedef struct _lms_block_instance_q15
+{
+	uint16_t numTaps;
+	q15_t *pState;			/* numTaps + blockSize - 1 muestras, mismo formato que CMSIS */
+	q15_t *pCoeffs;			/* numTaps coeficientes */
+	q63_t *pGrad;			/* numTaps acumuladores del gradiente */
+	q15_t mu;
+	uint32_t postShift;
+	uint32_t subBlockSize;	/* L: muestras por actualizacion */
+} lms_block_instance_q15;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* subBlockSize = 0 equivale a una actualizacion por trama (L = blockSize) */
+void LMS_BLOCK_Init(lms_block_instance_q15 *S, uint16_t numTaps, q15_t *pCoeffs, q15_t *pState, q63_t *pGrad,
+					q15_t mu, uint32_t blockSize, uint32_t subBlockSize, uint32_t postShift);
+
+/* Misma interfaz que arm_lms_q15 */
+void LMS_BLOCK_Process(const lms_block_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					   q15_t *pErr, uint32_t blockSize);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* LMS_BLOCK_H_ */
@@ -0,0 +1,243 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    LMS q15 multicanal (ver lms_multi.h).
+	Con bloques de LMS_MULTI_GROUP canales (AVX2) se recorren los grupos y, para cada
+	grupo, las muestras de la trama:
+	 - Producto escalar: _mm256_madd_epi16 con los coeficientes de los canales pares (o
+	   impares) y ceros en los otros carriles da el producto exacto de 32 bits de ocho
+	   canales, sin ensanchar las muestras. Para no acumular en 64 bits, cada producto p
+	   se separa en p >> 16 y p & 0xFFFF, que se suman en 32 bits sin desborde para
+	   cualquier numTaps < 2^16; la suma de 64 bits es (alto << 16) + bajo, igual a la
+	   de dsp_ref.c.
+	 - Salida, error y alpha: (q31_t)(acc >> (15 - postShift)) es, con aritmetica de 32
+	   bits modulo 2^32, (alto << (1 + postShift)) + (bajo >> (15 - postShift)), por lo
+	   que toda la etapa se hace en carriles de 32 bits (e * mu entra en 32 bits) y se
+	   arma un solo vector de 16 alphas, sin pasar por escalares.
+	 - Actualizacion: (alpha * x) >> 15 con mulhi/mullo de 16 bits y suma con
+	   saturacion, con un alpha distinto por carril. El unico caso que no entra en 16
+	   bits (alpha = x = -32768, donde el resultado debe ser SSAT16(coef + 32768)) se
+	   corrige por carril solo si algun canal del grupo tiene alpha = -32768.
+	Los carriles de relleno del ultimo grupo tienen linea de retardo y coeficientes en
+	cero y alpha = 0, por lo que no cambian.
+ */
+
+#include "lms_multi.h"
+#include "dsp_ref.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*******************************************************************************
+ * Kernels
+ ******************************************************************************/
+
+#if defined(__AVX2__)
+
+/* Suma el producto p de cada carril a los acumuladores alto y bajo */
+static inline void LMS_MULTI_Acc(__m256i p, __m256i *hi, __m256i *lo, __m256i lowMask)
+{
+	*hi = _mm256_add_epi32(*hi, _mm256_srai_epi32(p, 16));
+	*lo = _mm256_add_epi32(*lo, _mm256_and_si256(p, lowMask));
+}
+
+/* Canales pares (carriles bajos) e impares (altos) de cada par de 16 bits en 32 bits */
+static inline __m256i LMS_MULTI_Even(__m256i v)
+{
+	return _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+}
+
+static inline __m256i LMS_MULTI_Odd(__m256i v)
+{
+	return _mm256_srai_epi32(v, 16);
+}
+
+/* Vuelve a intercalar los 16 bits bajos de pares e impares */
+static inline __m256i LMS_MULTI_Interleave(__m256i even, __m256i odd)
+{
+	return _mm256_blend_epi16(even, _mm256_slli_epi32(odd, 16), 0xAA);
+}
+
+/* Salida saturada (32 bits) de un acumulador alto/bajo, como DSP_REF_LmsOutput */
+static inline __m256i LMS_MULTI_Output(__m256i hi, __m256i lo, __m128i hiShift, __m128i loShift)
+{
+	__m256i y = _mm256_add_epi32(_mm256_sll_epi32(hi, hiShift), _mm256_srl_epi32(lo, loShift));
+	y = _mm256_max_epi32(y, _mm256_set1_epi32(INT16_MIN));
+	return _mm256_min_epi32(y, _mm256_set1_epi32(INT16_MAX));
+}
+
+/* Grupo de canales [c0, c0 + width), con su bloque de linea de retardo y coeficientes */
+static void LMS_MULTI_GroupAvx2(const lms_multi_instance_q15 *S, q15_t *pState, q15_t *pCoeffs, const q15_t *pSrc,
+								const q15_t *pRef, q15_t *pOut, q15_t *pErr, uint32_t blockSize, uint32_t c0,
+								uint32_t width)
+{
+	uint32_t numChannels = S->numChannels;
+	uint16_t numTaps = S->numTaps;
+	q15_t mu = S->mu;
+	q15_t ref[LMS_MULTI_GROUP] = {0};
+	q15_t out[LMS_MULTI_GROUP];
+	q15_t err[LMS_MULTI_GROUP];
+	__m128i hiShift = _mm_cvtsi32_si128((int)(1U + S->postShift));
+	__m128i loShift = _mm_cvtsi32_si128((int)(15U - S->postShift));
+	__m256i muVec = _mm256_set1_epi32(mu);
+	__m256i lowMask = _mm256_set1_epi32(0xFFFF);
+	__m256i minValue = _mm256_set1_epi16(INT16_MIN);
+	__m256i half = _mm256_set1_epi16(16384);
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		memcpy(&pState[(numTaps - 1U + n) * LMS_MULTI_GROUP], &pSrc[n * numChannels + c0], width * sizeof(q15_t));
+	}
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		const q15_t *px = &pState[n * LMS_MULTI_GROUP];
+
+		/* Salida del filtro adaptativo: canales pares e impares por separado */
+		__m256i hiEven = _mm256_setzero_si256();
+		__m256i loEven = _mm256_setzero_si256();
+		__m256i hiOdd = _mm256_setzero_si256();
+		__m256i loOdd = _mm256_setzero_si256();
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i *)&px[k * LMS_MULTI_GROUP]);
+			__m256i w = _mm256_loadu_si256((const __m256i *)&pCoeffs[k * LMS_MULTI_GROUP]);
+			LMS_MULTI_Acc(_mm256_madd_epi16(x, _mm256_and_si256(w, lowMask)), &hiEven, &loEven, lowMask);
+			LMS_MULTI_Acc(_mm256_madd_epi16(x, _mm256_andnot_si256(lowMask, w)), &hiOdd, &loOdd, lowMask);
+		}
+		/* Error y alpha de cada canal. En el ultimo grupo la referencia de los carriles
+		 * de relleno queda en cero */
+		uint32_t i = n * numChannels + c0;
+		memcpy(ref, &pRef[i], width * sizeof(q15_t));
+		__m256i r = _mm256_loadu_si256((const __m256i *)ref);
+		__m256i yEven = LMS_MULTI_Output(hiEven, loEven, hiShift, loShift);
+		__m256i yOdd = LMS_MULTI_Output(hiOdd, loOdd, hiShift, loShift);
+		__m256i eEven = _mm256_sub_epi32(LMS_MULTI_Even(r), yEven);
+		__m256i eOdd = _mm256_sub_epi32(LMS_MULTI_Odd(r), yOdd);
+		__m256i aEven = _mm256_srai_epi32(_mm256_mullo_epi32(eEven, muVec), 15);
+		__m256i aOdd = _mm256_srai_epi32(_mm256_mullo_epi32(eOdd, muVec), 15);
+		_mm256_storeu_si256((__m256i *)out, LMS_MULTI_Interleave(yEven, yOdd));
+		_mm256_storeu_si256((__m256i *)err, LMS_MULTI_Interleave(eEven, eOdd));
+		memcpy(&pOut[i], out, width * sizeof(q15_t));
+		memcpy(&pErr[i], err, width * sizeof(q15_t));
+
+		/* Actualizacion de coeficientes, un alpha por carril */
+		__m256i a = LMS_MULTI_Interleave(aEven, aOdd);
+		__m256i aMin = _mm256_cmpeq_epi16(a, minValue);
+		int fix = !_mm256_testz_si256(aMin, aMin);
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i *)&px[k * LMS_MULTI_GROUP]);
+			__m256i w = _mm256_loadu_si256((const __m256i *)&pCoeffs[k * LMS_MULTI_GROUP]);
+			__m256i hi = _mm256_mulhi_epi16(x, a);
+			__m256i lo = _mm256_mullo_epi16(x, a);
+			__m256i t = _mm256_or_si256(_mm256_slli_epi16(hi, 1), _mm256_srli_epi16(lo, 15));
+			__m256i nw = _mm256_adds_epi16(w, t);
+			if(fix)
+			{
+				__m256i m = _mm256_and_si256(aMin, _mm256_cmpeq_epi16(x, minValue));
+				nw = _mm256_blendv_epi8(nw, _mm256_adds_epi16(_mm256_adds_epi16(w, half), half), m);
+			}
+			_mm256_storeu_si256((__m256i *)&pCoeffs[k * LMS_MULTI_GROUP], nw);
+		}
+	}
+
+	memmove(pState, &pState[blockSize * LMS_MULTI_GROUP], (numTaps - 1U) * LMS_MULTI_GROUP * sizeof(q15_t));
+}
+
+#endif
+
+/* Canal c con arm_lms_q15 sobre su propia linea de retardo (groupSize = 1) */
+static void LMS_MULTI_Channel(const lms_multi_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+							  q15_t *pErr, uint32_t blockSize, uint32_t c)
+{
+	uint32_t numChannels = S->numChannels;
+	uint16_t numTaps = S->numTaps;
+	q15_t *src = S->pScratch;
+	q15_t *ref = &src[blockSize];
+	q15_t *out = &ref[blockSize];
+	q15_t *err = &out[blockSize];
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		src[n] = pSrc[n * numChannels + c];
+		ref[n] = pRef[n * numChannels + c];
+	}
+
+	arm_lms_instance_q15 lms = {numTaps, &S->pState[c * (numTaps + blockSize - 1U)], &S->pCoeffs[c * numTaps], S->mu,
+								S->postShift};
+	arm_lms_q15(&lms, src, ref, out, err, blockSize);
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		pOut[n * numChannels + c] = out[n];
+		pErr[n * numChannels + c] = err[n];
+	}
+}
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+void LMS_MULTI_Init(lms_multi_instance_q15 *S, uint16_t numTaps, uint16_t numChannels, q15_t *pCoeffs,
+					q15_t *pState, q15_t *pScratch, q15_t mu, uint32_t blockSize, uint32_t postShift)
+{
+	S->numTaps = numTaps;
+	S->numChannels = numChannels;
+	S->groupSize = (numChannels >= LMS_MULTI_GROUP) ? LMS_MULTI_GROUP : 1U;
+	S->pCoeffs = pCoeffs;
+	S->pState = pState;
+	S->pScratch = pScratch;
+	S->mu = mu;
+	S->postShift = postShift;
+
+	memset(pState, 0, LMS_MULTI_STATE_LEN(numTaps, blockSize, numChannels) * sizeof(q15_t));
+	memset(pCoeffs, 0, LMS_MULTI_COEFFS_LEN(numTaps, numChannels) * sizeof(q15_t));
+}
+
+void LMS_MULTI_Process(const lms_multi_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					   q15_t *pErr, uint32_t blockSize)
+{
+	uint32_t numChannels = S->numChannels;
+
+	if(S->groupSize == 1U)
+	{
+		for(uint32_t c = 0; c < numChannels; c++)
+		{
+			LMS_MULTI_Channel(S, pSrc, pRef, pOut, pErr, blockSize, c);
+		}
+		return;
+	}
+
+#if defined(__AVX2__)
+	uint32_t stateLen = S->numTaps + blockSize - 1U;
+	for(uint32_t c0 = 0; c0 < numChannels; c0 += LMS_MULTI_GROUP)
+	{
+		uint32_t width = numChannels - c0;
+		LMS_MULTI_GroupAvx2(S, &S->pState[c0 * stateLen], &S->pCoeffs[c0 * S->numTaps], pSrc, pRef, pOut, pErr,
+							blockSize, c0, (width < LMS_MULTI_GROUP) ? width : LMS_MULTI_GROUP);
+	}
+#endif
+}
+
+void LMS_MULTI_GetCoeffs(const lms_multi_instance_q15 *S, uint16_t channel, q15_t *pDst)
+{
+	uint32_t g = S->groupSize;
+	const q15_t *pCoeffs = &S->pCoeffs[(channel / g) * g * S->numTaps + (channel % g)];
+
+	for(uint16_t k = 0; k < S->numTaps; k++)
+	{
+		pDst[k] = pCoeffs[k * g];
+	}
+}
+
+void LMS_MULTI_SetCoeffs(const lms_multi_instance_q15 *S, uint16_t channel, const q15_t *pSrc)
+{
+	uint32_t g = S->groupSize;
+	q15_t *pCoeffs = &S->pCoeffs[(channel / g) * g * S->numTaps + (channel % g)];
+
+	for(uint16_t k = 0; k < S->numTaps; k++)
+	{
+		pCoeffs[k * g] = pSrc[k];
+	}
+}
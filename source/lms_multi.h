@@ -0,0 +1,87 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    LMS q15 de numChannels canales independientes (una planta por canal de sensor)
+	procesados juntos. Cada canal es un arm_lms_q15 con su propia entrada, referencia
+	y coeficientes, y el resultado es identico bit a bit al de correr un arm_lms_q15
+	por canal (ver dsp_ref.h); todos comparten numTaps, mu y postShift.
+
+	Las tramas de entrada y salida estan intercaladas por canal: la muestra n del canal
+	c esta en [n * numChannels + c]. La linea de retardo y los coeficientes se guardan
+	como estructura de arreglos en bloques de groupSize canales: dentro de un bloque,
+	para cada muestra (o tap) estan los groupSize canales contiguos, asi cada carril del
+	vector procesa un canal y el producto escalar y la actualizacion de un grupo se
+	hacen con las mismas operaciones que los de un solo canal, sin reducciones
+	horizontales. Los bloques son contiguos, por lo que la franja de un grupo queda en
+	cache durante toda la trama sin importar la cantidad de canales.
+	groupSize es LMS_MULTI_GROUP con AVX2 y al menos LMS_MULTI_GROUP canales. Si no, es 1
+	(cada canal con su linea de retardo, en el formato de arm_lms_q15) y cada canal se
+	procesa con arm_lms_q15, que en el Cortex-M4 ya usa __SMLALD sobre pares de taps y
+	en el host vectoriza sobre los taps.
+ */
+
+#ifndef LMS_MULTI_H_
+#define LMS_MULTI_H_
+
+#include "arm_math.h"
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+/* Canales que se procesan juntos: un registro AVX2 de q15. Sin AVX2 cada canal se
+ * procesa por separado y no hay relleno */
+#if defined(__AVX2__)
+#define LMS_MULTI_GROUP (16U)
+#else
+#define LMS_MULTI_GROUP (1U)
+#endif
+
+/* Canales redondeados a grupos completos */
+#define LMS_MULTI_PADDED(numChannels) \
+	((((uint32_t)(numChannels) + LMS_MULTI_GROUP - 1U) / LMS_MULTI_GROUP) * LMS_MULTI_GROUP)
+
+/* Largo en q15_t de la linea de retardo, de los coeficientes y del buffer de trabajo */
+#define LMS_MULTI_STATE_LEN(numTaps, blockSize, numChannels) \
+	(((uint32_t)(numTaps) + (blockSize) - 1U) * LMS_MULTI_PADDED(numChannels))
+#define LMS_MULTI_COEFFS_LEN(numTaps, numChannels) ((uint32_t)(numTaps) * LMS_MULTI_PADDED(numChannels))
+#define LMS_MULTI_SCRATCH_LEN(blockSize) (4U * (uint32_t)(blockSize))
+
+/* Instancia del LMS multicanal */
+typedef struct _lms_multi_instance_q15
+{
+	uint16_t numTaps;
+	uint16_t numChannels;
+	uint16_t groupSize;		/* Canales por bloque: LMS_MULTI_GROUP o 1 */
+	q15_t *pState;			/* LMS_MULTI_STATE_LEN muestras */
+	q15_t *pCoeffs;			/* LMS_MULTI_COEFFS_LEN coeficientes */
+	q15_t *pScratch;		/* LMS_MULTI_SCRATCH_LEN muestras (trama de un canal) */
+	q15_t mu;
+	uint32_t postShift;
+} lms_multi_instance_q15;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Pone en cero la linea de retardo y los coeficientes */
+void LMS_MULTI_Init(lms_multi_instance_q15 *S, uint16_t numTaps, uint16_t numChannels, q15_t *pCoeffs,
+					q15_t *pState, q15_t *pScratch, q15_t mu, uint32_t blockSize, uint32_t postShift);
+
+/* Procesa blockSize muestras de cada canal. pSrc, pRef, pOut y pErr tienen
+ * blockSize * numChannels valores intercalados por canal */
+void LMS_MULTI_Process(const lms_multi_instance_q15 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut,
+					   q15_t *pErr, uint32_t blockSize);
+
+/* Coeficientes de un canal, en el orden de arm_lms_q15 */
+void LMS_MULTI_GetCoeffs(const lms_multi_instance_q15 *S, uint16_t channel, q15_t *pDst);
+void LMS_MULTI_SetCoeffs(const lms_multi_instance_q15 *S, uint16_t channel, const q15_t *pSrc);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* LMS_MULTI_H_ */
@@ -0,0 +1,265 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Variantes de la regla de actualizacion del LMS q15 (ver lms_rule.h).
+	La regla se elige una vez por trama y cada una tiene su propio lazo de muestras, que
+	solo calcula lo que la regla usa (sign-error no calcula e * mu y sign-sign no hace
+	ningun producto en la actualizacion). Los lazos de taps no tienen dependencia entre
+	iteraciones, para que el compilador los vectorice. La salida usa __SMLALD en el
+	Cortex-M4, como arm_lms_q15.
+	LMS_RULE_ProcessQ31Coeffs es el LMS estandar con los coeficientes acumulados en q31.
+ */
+
+#include "lms_rule.h"
+#include "dsp_ref.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+/* En el orden de lms_rule_t */
+static const char *const s_ruleNames[kLMS_RULE_NumRules] = {"lms", "leaky", "signerr", "signdata", "signsign"};
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+static inline q31_t LMS_RULE_Sign(q31_t value)
+{
+	return (value > 0) - (value < 0);
+}
+
+/* step * sgn(x) sin multiplicar ni saltos: se invierte el signo de step con la mascara
+ * de signo de x y se anula si x es 0 */
+static inline q31_t LMS_RULE_SignStep(q31_t x, q31_t step)
+{
+	q31_t negative = x >> 31;
+	return ((step ^ negative) - negative) & -(q31_t)(x != 0);
+}
+
+static inline q15_t LMS_RULE_Sat(q31_t value)
+{
+	return (q15_t)__SSAT(value, 16);
+}
+
+/* Producto escalar de la salida. En el Cortex-M4 de a dos taps con __SMLALD, como
+ * arm_lms_q15 de la biblioteca; en el host un lazo simple que el compilador vectoriza.
+ * La suma en 64 bits es exacta, asi que el orden no cambia el resultado */
+static inline q63_t LMS_RULE_Dot(const q15_t *px, const q15_t *pCoeffs, uint16_t numTaps)
+{
+	q63_t acc = 0;
+	uint16_t k = 0;
+
+#if defined(ARM_MATH_DSP)
+	for(; k + 1U < numTaps; k += 2U)
+	{
+		acc = (q63_t)__SMLALD((uint32_t)read_q15x2((q15_t *)&px[k]), (uint32_t)read_q15x2((q15_t *)&pCoeffs[k]),
+							  (uint64_t)acc);
+	}
+#endif
+	for(; k < numTaps; k++)
+	{
+		acc += (q31_t)px[k] * pCoeffs[k];
+	}
+	return acc;
+}
+
+/* Salida, error guardado y energia de una muestra, como arm_lms_q15. Devuelve el error de
+ * 32 bits */
+static inline q31_t LMS_RULE_Error(const arm_lms_instance_q15 *S, const q15_t *px, q15_t ref, q15_t *pOut,
+								   q15_t *pErr, q63_t *pEnergy)
+{
+	q31_t e = DSP_REF_LmsOutput(LMS_RULE_Dot(px, S->pCoeffs, S->numTaps), ref, S->postShift, pOut);
+	*pErr = (q15_t)e;
+	*pEnergy += (q31_t)*pErr * *pErr;
+	return e;
+}
+
+q63_t LMS_RULE_ProcessQ15(const arm_lms_instance_q15 *S, lms_rule_t rule, q15_t leak, q31_t *pLeakResidual,
+						  const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr, uint32_t blockSize)
+{
+	q15_t *pState = S->pState;
+	q15_t *pCoeffs = S->pCoeffs;
+	uint16_t numTaps = S->numTaps;
+	q15_t mu = S->mu;
+	q63_t energy = 0;
+
+	/* Valor medio de la trama, que se resta antes de tomar sgn(x) */
+	q31_t center = 0;
+	if((rule == kLMS_RULE_SignData) || (rule == kLMS_RULE_SignSign))
+	{
+		q31_t sum = 0;
+		for(uint32_t n = 0; n < blockSize; n++)
+		{
+			sum += pSrc[n];
+		}
+		center = sum / (q31_t)blockSize;
+	}
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+
+	/* Error medio de la trama con los coeficientes del principio: media de la referencia
+	 * menos la de la salida. Cada tap ve una ventana distinta de la linea de retardo (los
+	 * ultimos tambien leen la trama anterior), por lo que su media se toma por separado
+	 * con una suma deslizante */
+	q31_t errCenter = 0;
+	if(rule == kLMS_RULE_SignSign)
+	{
+		q31_t sumRef = 0;
+		q31_t window = 0;
+		q63_t sumOut = 0;
+		for(uint32_t n = 0; n < blockSize; n++)
+		{
+			sumRef += pRef[n];
+			window += pState[n];
+		}
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			sumOut += (q63_t)pCoeffs[k] * window;
+			window += pState[k + blockSize] - pState[k];
+		}
+		errCenter = (q31_t)(((q63_t)sumRef - (sumOut >> (15U - S->postShift))) / (q63_t)blockSize);
+	}
+
+	/* Un lazo de muestras por regla, y en cada uno solo lo que la regla necesita */
+	switch(rule)
+	{
+		case kLMS_RULE_SignError:
+			/* Es el LMS con alpha = sgn(e) * mu: no hace falta el producto e * mu */
+			for(uint32_t n = 0; n < blockSize; n++)
+			{
+				const q15_t *px = &pState[n];
+				q31_t e = LMS_RULE_Error(S, px, pRef[n], &pOut[n], &pErr[n], &energy);
+				q15_t step = (q15_t)(LMS_RULE_Sign(e) * mu);
+
+				for(uint16_t k = 0; k < numTaps; k++)
+				{
+					pCoeffs[k] = DSP_REF_LmsUpdate(pCoeffs[k], step, px[k]);
+				}
+			}
+			break;
+		case kLMS_RULE_SignData:
+			/* Sin productos por tap: cada coeficiente suma o resta alpha */
+			for(uint32_t n = 0; n < blockSize; n++)
+			{
+				const q15_t *px = &pState[n];
+				q31_t e = LMS_RULE_Error(S, px, pRef[n], &pOut[n], &pErr[n], &energy);
+				q31_t alpha = (q15_t)((e * mu) >> 15);
+
+				for(uint16_t k = 0; k < numTaps; k++)
+				{
+					pCoeffs[k] = LMS_RULE_Sat(pCoeffs[k] + LMS_RULE_SignStep(px[k] - center, alpha));
+				}
+			}
+			break;
+		case kLMS_RULE_SignSign:
+			/* Sin productos por tap ni por muestra: cada coeficiente suma o resta mu */
+			for(uint32_t n = 0; n < blockSize; n++)
+			{
+				const q15_t *px = &pState[n];
+				q31_t e = LMS_RULE_Error(S, px, pRef[n], &pOut[n], &pErr[n], &energy);
+				q31_t sign = LMS_RULE_Sign(e - errCenter);
+
+				/* Con error nulo no hay actualizacion */
+				if(sign == 0)
+				{
+					continue;
+				}
+				q31_t step = (sign > 0) ? mu : -(q31_t)mu;
+				for(uint16_t k = 0; k < numTaps; k++)
+				{
+					pCoeffs[k] = LMS_RULE_Sat(pCoeffs[k] + LMS_RULE_SignStep(px[k] - center, step));
+				}
+			}
+			break;
+		case kLMS_RULE_Standard:
+		case kLMS_RULE_Leaky:
+		default:
+			for(uint32_t n = 0; n < blockSize; n++)
+			{
+				const q15_t *px = &pState[n];
+				q31_t e = LMS_RULE_Error(S, px, pRef[n], &pOut[n], &pErr[n], &energy);
+				q15_t alpha = (q15_t)((e * mu) >> 15);
+
+				for(uint16_t k = 0; k < numTaps; k++)
+				{
+					pCoeffs[k] = DSP_REF_LmsUpdate(pCoeffs[k], alpha, px[k]);
+				}
+			}
+			break;
+	}
+
+	/* Sign-sign resta la media de la entrada y la del error, por lo que la actualizacion por
+	 * muestra no corrige la suma de los coeficientes. Una vez por trama todos los taps suman
+	 * o restan mu segun el signo del error medio (el de la suma, si center es positivo) */
+	if(rule == kLMS_RULE_SignSign)
+	{
+		q31_t step = LMS_RULE_SignStep(center, LMS_RULE_SignStep(errCenter, mu));
+		if(step != 0)
+		{
+			for(uint16_t k = 0; k < numTaps; k++)
+			{
+				pCoeffs[k] = LMS_RULE_Sat(pCoeffs[k] + step);
+			}
+		}
+	}
+
+	/* Fuga, una vez por trama. El resto conserva el signo de la fuga pendiente (division
+	 * truncada hacia cero), asi los coeficientes positivos y negativos decaen igual */
+	if(rule == kLMS_RULE_Leaky)
+	{
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			q31_t pending = pLeakResidual[k] + (q31_t)pCoeffs[k] * leak;
+			q31_t step = pending / 32768;
+			pLeakResidual[k] = pending - step * 32768;
+			pCoeffs[k] = LMS_RULE_Sat((q31_t)pCoeffs[k] - step);
+		}
+	}
+
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+
+	return energy;
+}
+
+/* Satura a q31, como __SSAT(value, 32) */
+static inline q31_t LMS_RULE_SatQ31(q63_t value)
+{
+	return (q31_t)((value > INT32_MAX) ? INT32_MAX : ((value < INT32_MIN) ? INT32_MIN : value));
+}
+
+q63_t LMS_RULE_ProcessQ31Coeffs(const arm_lms_instance_q15 *S, q31_t *pCoeffsQ31, const q15_t *pSrc,
+								const q15_t *pRef, q15_t *pOut, q15_t *pErr, uint32_t blockSize)
+{
+	q15_t *pState = S->pState;
+	q15_t *pCoeffs = S->pCoeffs;
+	uint16_t numTaps = S->numTaps;
+	q15_t mu = S->mu;
+	q63_t energy = 0;
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		const q15_t *px = &pState[n];
+		q31_t e = LMS_RULE_Error(S, px, pRef[n], &pOut[n], &pErr[n], &energy);
+
+		/* Sin el >> 15 de alpha: |e| < 2^16 y |mu| <= 2^15, el producto entra en 32 bits */
+		q31_t alpha = e * mu;
+
+		/* e * mu * x / 2^30 es el paso en LSB de q15; en q31 son 16 bits mas */
+		for(uint16_t k = 0; k < numTaps; k++)
+		{
+			pCoeffsQ31[k] = LMS_RULE_SatQ31((q63_t)pCoeffsQ31[k] + (((q63_t)alpha * px[k]) >> 14));
+			pCoeffs[k] = (q15_t)(pCoeffsQ31[k] >> 16);
+		}
+	}
+
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+
+	return energy;
+}
+
+const char *LMS_RULE_GetName(lms_rule_t rule)
+{
+	return (rule < kLMS_RULE_NumRules) ? s_ruleNames[rule] : "?";
+}
@@ -0,0 +1,81 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Variantes de la regla de actualizacion del LMS q15. La salida y el error se calculan
+	igual que en arm_lms_q15 (ver dsp_ref.h) y solo cambia como se actualiza cada
+	coeficiente w[k] con la muestra x[k] de la linea de retardo:
+	 - kLMS_RULE_Standard:  w += (alpha * x) >> 15, alpha = (e * mu) >> 15 (arm_lms_q15)
+	 - kLMS_RULE_Leaky:     el LMS y, al final de cada trama, w -= w * leak / 32768
+	   La fuga lleva a cero los coeficientes que la señal no excita, a cambio de un sesgo
+	   proporcional a leak. Se aplica una vez por trama porque por muestra la fuga minima
+	   en q15 (1/32768) ya es demasiado grande. w * leak / 32768 suele ser menor a un LSB
+	   (con leak = 1, siempre), por lo que la parte fraccionaria de cada tap se acumula en
+	   pLeakResidual (en unidades de 2^-15 LSB) y el coeficiente baja un LSB cada vez que
+	   se completa uno: w decae en promedio exactamente con w * leak / 32768 por trama.
+	 - kLMS_RULE_SignError: w += (sgn(e) * mu * x) >> 15
+	   No se calcula alpha; el paso no depende de la amplitud del error.
+	 - kLMS_RULE_SignData:  w += sgn(x - media) * alpha
+	 - kLMS_RULE_SignSign:  w += sgn(e - media del error) * sgn(x - media) * mu
+	   Sin productos en la actualizacion: cada coeficiente se mueve mu LSB por muestra.
+	   Ademas, una vez por trama, todos suman sgn(media del error) * mu.
+	La señal del generador es uniforme en [0, 2^11) (como rand() >> 20), por lo que
+	sgn(x) seria siempre 1 y todos los coeficientes se moverian igual. Por eso se toma el
+	signo de x menos el valor medio de la trama y, en sign-sign, el del error menos su
+	media en la trama (media de la referencia menos la de la salida con los coeficientes
+	del principio de la trama, con la media de la ventana que ve cada tap), que si no
+	domina el signo del error. Sin la media ninguno de los dos corrige la suma de los
+	coeficientes, y de eso se encarga el paso por trama de sign-sign.
+	Todas las sumas saturan a 16 bits, como en arm_lms_q15. Con sgn(0) = 0 un error nulo
+	no mueve los coeficientes.
+
+	El mismo mu da pasos muy distintos segun la regla. Con la planta de 30 taps y
+	signal_power 1 convergen en 5000 tramas, aproximadamente, el LMS con mu de 2000 a
+	25000, sign-error de 32 a 2000, sign-data de 64 a 8000 y sign-sign de 1 a 8.
+
+	Las instancias y el buffer de estado son los de CMSIS (arm_lms_init_q15), por lo que se
+	puede cambiar de regla o volver a arm_lms_q15 entre tramas.
+ */
+
+#ifndef LMS_RULE_H_
+#define LMS_RULE_H_
+
+#include "arm_math.h"
+
+/* Regla de actualizacion */
+typedef enum _lms_rule
+{
+	kLMS_RULE_Standard = 0U,
+	kLMS_RULE_Leaky,
+	kLMS_RULE_SignError,
+	kLMS_RULE_SignData,
+	kLMS_RULE_SignSign,
+	kLMS_RULE_NumRules,
+} lms_rule_t;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Misma interfaz que arm_lms_q15 con la regla rule y, solo con kLMS_RULE_Leaky, la fuga
+ * leak (q15, 0 a 32767) y el resto de la fuga de cada tap pLeakResidual (numTaps
+ * valores, en cero al inicializar el filtro). Devuelve la energia del error de la trama
+ * (igual que arm_power_q15 sobre pErr) */
+q63_t LMS_RULE_ProcessQ15(const arm_lms_instance_q15 *S, lms_rule_t rule, q15_t leak, q31_t *pLeakResidual,
+						  const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr, uint32_t blockSize);
+
+/* LMS estandar con los coeficientes acumulados en q31 (pCoeffsQ31, numTaps valores). En
+ * arm_lms_q15 el paso de cada tap, (((e * mu) >> 15) * x) >> 15, se trunca dos veces a
+ * q15 y con mu chico se anula: los coeficientes se frenan lejos del optimo aunque el
+ * error no sea nulo. Aca el paso e * mu * x se suma con 16 bits fraccionarios mas y
+ * S->pCoeffs recibe la parte entera para la salida, por lo que un mu chico sigue
+ * moviendo los coeficientes (ver vss.h). Al inicializar el filtro pCoeffsQ31[k] debe ser
+ * S->pCoeffs[k] << 16. Devuelve la energia del error de la trama */
+q63_t LMS_RULE_ProcessQ31Coeffs(const arm_lms_instance_q15 *S, q31_t *pCoeffsQ31, const q15_t *pSrc,
+								const q15_t *pRef, q15_t *pOut, q15_t *pErr, uint32_t blockSize);
+
+const char *LMS_RULE_GetName(lms_rule_t rule);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* LMS_RULE_H_ */
@@ -0,0 +1,67 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Reporte del plan de memoria (ver mem_plan.h).
+ */
+
+#include "mem_plan.h"
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+/* En el orden de mem_plan_region_t */
+static const char *const s_regionNames[kMEM_PLAN_NumRegions + 1U] = {"SRAM_L", "SRAM_U", "-"};
+
+static const uint32_t s_regionSizes[kMEM_PLAN_NumRegions] = {MEM_PLAN_SRAM_L_SIZE, MEM_PLAN_SRAM_U_SIZE};
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+mem_plan_region_t MEM_PLAN_RegionOf(const void *address)
+{
+	uintptr_t a = (uintptr_t)address;
+
+	if((a >= MEM_PLAN_SRAM_L_BASE) && (a - MEM_PLAN_SRAM_L_BASE < MEM_PLAN_SRAM_L_SIZE))
+	{
+		return kMEM_PLAN_SramL;
+	}
+	if((a >= MEM_PLAN_SRAM_U_BASE) && (a - MEM_PLAN_SRAM_U_BASE < MEM_PLAN_SRAM_U_SIZE))
+	{
+		return kMEM_PLAN_SramU;
+	}
+	return kMEM_PLAN_Other;
+}
+
+const char *MEM_PLAN_GetName(mem_plan_region_t region)
+{
+	return (region <= kMEM_PLAN_Other) ? s_regionNames[region] : "?";
+}
+
+uint32_t MEM_PLAN_Report(const mem_plan_entry_t *entries, uint32_t count, mem_plan_printf_t print)
+{
+	uint32_t totals[kMEM_PLAN_NumRegions] = {0};
+	uint32_t misplaced = 0;
+
+	print("buffer           region   direccion     bytes\r\n");
+	for(uint32_t i = 0; i < count; i++)
+	{
+		const mem_plan_entry_t *entry = &entries[i];
+		mem_plan_region_t actual = MEM_PLAN_RegionOf(entry->address);
+
+		/* En el host no hay regiones: solo se cuentan los tamaños */
+		bool wrong = (actual != kMEM_PLAN_Other) && (actual != entry->region);
+		misplaced += wrong ? 1U : 0U;
+		totals[entry->region] += entry->size;
+		print("%-16s %-8s 0x%08lx %8lu%s\r\n", entry->name, MEM_PLAN_GetName(entry->region),
+			  (unsigned long)(uintptr_t)entry->address, (unsigned long)entry->size,
+			  wrong ? " (fuera de la region)" : "");
+	}
+	for(uint32_t r = 0; r < kMEM_PLAN_NumRegions; r++)
+	{
+		print("%-8s %lu de %lu bytes (%lu %%)\r\n", s_regionNames[r], (unsigned long)totals[r],
+			  (unsigned long)s_regionSizes[r], (unsigned long)(100U * totals[r] / s_regionSizes[r]));
+	}
+	return misplaced;
+}
@@ -0,0 +1,86 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Plan de memoria estatico. Todos los buffers del lazo de identificacion son variables
+	estaticas cuyo tamaño se conoce al compilar (a partir de NUMTAPS, BLOCKSIZE y
+	NUMFRAMES), por lo que la RAM usada no depende de la pila y un tamaño que no entra
+	falla al compilar en lugar de pisar memoria en ejecucion.
+
+	La RAM del K64F son dos bloques contiguos en distintos buses:
+		SRAM_L  0x1FFF0000, 64 KB, bus de codigo (I-code/D-code)
+		SRAM_U  0x20000000, 192 KB, bus de sistema
+	Con MEM_PLAN_SRAM_L / MEM_PLAN_SRAM_U cada buffer se ubica en una region (secciones
+	.bss.$SRAM_LOWER y .bss.$SRAM_UPPER del linker administrado de MCUXpresso, con las
+	regiones definidas en el proyecto). Ninguna variable puede cruzar 0x20000000: un
+	acceso que cruza el limite entre los dos bloques genera una falla de bus, y al ubicar
+	cada buffer en una region el linker no lo permite.
+
+	Al arrancar, MEM_PLAN_Report() imprime el mapa de memoria: direccion, tamaño y region
+	de cada buffer del plan, si esta donde se planeo y el total por region.
+	En el host las macros no ubican nada y el reporte muestra solo los tamaños.
+ */
+
+#ifndef MEM_PLAN_H_
+#define MEM_PLAN_H_
+
+#include "arm_math.h"
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+#define MEM_PLAN_SRAM_L_BASE (0x1FFF0000U)
+#define MEM_PLAN_SRAM_L_SIZE (0x10000U)
+#define MEM_PLAN_SRAM_U_BASE (0x20000000U)
+#define MEM_PLAN_SRAM_U_SIZE (0x30000U)
+
+#if defined(__arm__) && !defined(DSP_PORT_FORCE)
+#define MEM_PLAN_SRAM_L __attribute__((section(".bss.$SRAM_LOWER"), aligned(8)))
+#define MEM_PLAN_SRAM_U __attribute__((section(".bss.$SRAM_UPPER"), aligned(8)))
+#else
+#define MEM_PLAN_SRAM_L
+#define MEM_PLAN_SRAM_U
+#endif
+
+/* Region de RAM */
+typedef enum _mem_plan_region
+{
+	kMEM_PLAN_SramL = 0U,
+	kMEM_PLAN_SramU,
+	kMEM_PLAN_NumRegions,
+	kMEM_PLAN_Other = kMEM_PLAN_NumRegions,	/* Fuera de la RAM del K64F (host) */
+} mem_plan_region_t;
+
+/* Un buffer del plan */
+typedef struct _mem_plan_entry
+{
+	const char *name;
+	const void *address;
+	uint32_t size;
+	mem_plan_region_t region;	/* Region planeada */
+} mem_plan_entry_t;
+
+/* Funcion de impresion (PRINTF en el firmware, printf en el host) */
+typedef int (*mem_plan_printf_t)(const char *format, ...);
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Region en la que esta la direccion */
+mem_plan_region_t MEM_PLAN_RegionOf(const void *address);
+
+const char *MEM_PLAN_GetName(mem_plan_region_t region);
+
+/* Imprime el mapa de memoria de count buffers y el total por region. Devuelve la
+ * cantidad de buffers que no estan en la region planeada (0 en el host) */
+uint32_t MEM_PLAN_Report(const mem_plan_entry_t *entries, uint32_t count, mem_plan_printf_t print);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* MEM_PLAN_H_ */
@@ -0,0 +1,159 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    xoshiro128+ intercalado (ver prng.h). Por cada paso de un generador:
+		r = s0 + s3          t = s1 << 9
+		s2 ^= s0   s3 ^= s1   s1 ^= s2   s0 ^= s3   s2 ^= t   s3 = rotl(s3, 11)
+ */
+
+#include "prng.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+static uint64_t PRNG_SplitMix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+void PRNG_Init(prng_instance_t *S, uint64_t seed)
+{
+	uint64_t x = seed;
+
+	for(uint32_t lane = 0; lane < PRNG_LANES; lane++)
+	{
+		uint64_t a = PRNG_SplitMix64(&x);
+		uint64_t b = PRNG_SplitMix64(&x);
+		S->s[0][lane] = (uint32_t)a;
+		S->s[1][lane] = (uint32_t)(a >> 32);
+		S->s[2][lane] = (uint32_t)b;
+		S->s[3][lane] = (uint32_t)(b >> 32);
+
+		/* xoshiro no admite el estado nulo */
+		if((a | b) == 0U)
+		{
+			S->s[0][lane] = 1U;
+		}
+	}
+}
+
+/* Genera un grupo de PRNG_LANES valores */
+static inline void PRNG_Step(prng_instance_t *S, uint32_t *pDst)
+{
+#if defined(__AVX2__)
+	__m256i s0 = _mm256_loadu_si256((const __m256i *)S->s[0]);
+	__m256i s1 = _mm256_loadu_si256((const __m256i *)S->s[1]);
+	__m256i s2 = _mm256_loadu_si256((const __m256i *)S->s[2]);
+	__m256i s3 = _mm256_loadu_si256((const __m256i *)S->s[3]);
+
+	_mm256_storeu_si256((__m256i *)pDst, _mm256_add_epi32(s0, s3));
+
+	__m256i t = _mm256_slli_epi32(s1, 9);
+	s2 = _mm256_xor_si256(s2, s0);
+	s3 = _mm256_xor_si256(s3, s1);
+	s1 = _mm256_xor_si256(s1, s2);
+	s0 = _mm256_xor_si256(s0, s3);
+	s2 = _mm256_xor_si256(s2, t);
+	s3 = _mm256_or_si256(_mm256_slli_epi32(s3, 11), _mm256_srli_epi32(s3, 21));
+
+	_mm256_storeu_si256((__m256i *)S->s[0], s0);
+	_mm256_storeu_si256((__m256i *)S->s[1], s1);
+	_mm256_storeu_si256((__m256i *)S->s[2], s2);
+	_mm256_storeu_si256((__m256i *)S->s[3], s3);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	for(uint32_t h = 0; h < PRNG_LANES; h += 4U)
+	{
+		uint32x4_t s0 = vld1q_u32(&S->s[0][h]);
+		uint32x4_t s1 = vld1q_u32(&S->s[1][h]);
+		uint32x4_t s2 = vld1q_u32(&S->s[2][h]);
+		uint32x4_t s3 = vld1q_u32(&S->s[3][h]);
+
+		vst1q_u32(&pDst[h], vaddq_u32(s0, s3));
+
+		uint32x4_t t = vshlq_n_u32(s1, 9);
+		s2 = veorq_u32(s2, s0);
+		s3 = veorq_u32(s3, s1);
+		s1 = veorq_u32(s1, s2);
+		s0 = veorq_u32(s0, s3);
+		s2 = veorq_u32(s2, t);
+		s3 = vsriq_n_u32(vshlq_n_u32(s3, 11), s3, 21);
+
+		vst1q_u32(&S->s[0][h], s0);
+		vst1q_u32(&S->s[1][h], s1);
+		vst1q_u32(&S->s[2][h], s2);
+		vst1q_u32(&S->s[3][h], s3);
+	}
+#else
+	for(uint32_t lane = 0; lane < PRNG_LANES; lane++)
+	{
+		uint32_t s0 = S->s[0][lane];
+		uint32_t s1 = S->s[1][lane];
+		uint32_t s2 = S->s[2][lane];
+		uint32_t s3 = S->s[3][lane];
+
+		pDst[lane] = s0 + s3;
+
+		uint32_t t = s1 << 9;
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = (s3 << 11) | (s3 >> 21);
+
+		S->s[0][lane] = s0;
+		S->s[1][lane] = s1;
+		S->s[2][lane] = s2;
+		S->s[3][lane] = s3;
+	}
+#endif
+}
+
+void PRNG_FillU32(prng_instance_t *S, uint32_t *pDst, uint32_t count)
+{
+	uint32_t j = 0;
+
+	for(; j + PRNG_LANES <= count; j += PRNG_LANES)
+	{
+		PRNG_Step(S, &pDst[j]);
+	}
+	if(j < count)
+	{
+		uint32_t tmp[PRNG_LANES];
+		PRNG_Step(S, tmp);
+		memcpy(&pDst[j], tmp, (count - j) * sizeof(uint32_t));
+	}
+}
+
+void PRNG_FillQ15(prng_instance_t *S, q15_t *pDst, uint32_t bits, q15_t scale, uint32_t count)
+{
+	uint32_t shift = 32U - bits;
+	uint32_t r[PRNG_LANES];
+
+	for(uint32_t j = 0; j < count; j += PRNG_LANES)
+	{
+		PRNG_Step(S, r);
+		uint32_t n = ((count - j) < PRNG_LANES) ? (count - j) : PRNG_LANES;
+
+#if defined(__AVX2__)
+		if(n == PRNG_LANES)
+		{
+			/* u < 2^15, por lo que el pack con saturacion es exacto y el producto de 16
+			 * bits se trunca igual que la conversion a q15_t */
+			__m256i u = _mm256_srli_epi32(_mm256_loadu_si256((const __m256i *)r), (int)shift);
+			__m128i u16 = _mm_packs_epi32(_mm256_castsi256_si128(u), _mm256_extracti128_si256(u, 1));
+			_mm_storeu_si128((__m128i *)&pDst[j], _mm_mullo_epi16(u16, _mm_set1_epi16(scale)));
+			continue;
+		}
+#endif
+		for(uint32_t k = 0; k < n; k++)
+		{
+			pDst[j + k] = (q15_t)((int32_t)(r[k] >> shift) * scale);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Generador pseudoaleatorio por bloques para la señal de entrada, en reemplazo de
+	rand(). Son PRNG_LANES generadores xoshiro128+ intercalados: la muestra j de cada
+	grupo de PRNG_LANES sale del generador j. Asi el mismo estado se avanza con un
+	lazo escalar en el Cortex-M4 (solo sumas, xor y shifts de 32 bits) o con una
+	instruccion por operacion en AVX2/NEON en el host, y ambos dan la misma secuencia
+	bit a bit para la misma semilla.
+
+	El estado es propio de cada instancia (no hay estado global como en rand()), por
+	lo que varios motores de identificacion pueden correr en paralelo con secuencias
+	independientes y reproducibles.
+
+	Cada llamada consume grupos enteros de PRNG_LANES valores: si count no es multiplo
+	de PRNG_LANES se descarta el resto del ultimo grupo.
+ */
+
+#ifndef PRNG_H_
+#define PRNG_H_
+
+#include "arm_math.h"
+
+/* Generadores intercalados (un registro AVX2 de 32 bits por lane) */
+#define PRNG_LANES (8U)
+
+#if defined(__AVX2__)
+#define PRNG_ISA "avx2"
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define PRNG_ISA "neon"
+#else
+#define PRNG_ISA "escalar"
+#endif
+
+/* Estado de los generadores: s[k][lane] es la palabra k del generador lane */
+typedef struct _prng_instance
+{
+	uint32_t s[4][PRNG_LANES];
+} prng_instance_t;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Inicializa los generadores a partir de una semilla (splitmix64 por lane) */
+void PRNG_Init(prng_instance_t *S, uint64_t seed);
+
+/* count valores uniformes de 32 bits */
+void PRNG_FillU32(prng_instance_t *S, uint32_t *pDst, uint32_t count);
+
+/* count muestras pDst[j] = (q15_t)(u * scale), con u uniforme en [0, 2^bits) tomado de
+ * los bits altos de cada valor. bits entre 1 y 15. Con bits = 11 reproduce la
+ * estadistica de (q15_t)(rand() >> 20) * scale */
+void PRNG_FillQ15(prng_instance_t *S, q15_t *pDst, uint32_t bits, q15_t scale, uint32_t count);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* PRNG_H_ */
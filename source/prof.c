@@ -0,0 +1,80 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Estadisticas de ciclos por etapa (ver prof.h).
+ */
+
+#include "prof.h"
+
+#if !(defined(__arm__) && !defined(DSP_PORT_FORCE))
+#include <time.h>
+#endif
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+PROF_THREAD_LOCAL prof_stats_t g_profStats[kPROF_NumScopes];
+
+/* En el orden de prof_scope_t */
+static const char *const s_profNames[kPROF_NumScopes] = {"input", "plant", "adapt", "mse", "output", "frame"};
+
+/* En 64 bits: el rdtsc de un host pasa de 2^32 ticks por segundo a partir de 4.3 GHz */
+static uint64_t s_ticksPerSecond;
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+#if !(defined(__arm__) && !defined(DSP_PORT_FORCE))
+static uint64_t PROF_NowNs(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000U + (uint64_t)t.tv_nsec;
+}
+#endif
+
+void PROF_Init(void)
+{
+#if defined(__arm__) && !defined(DSP_PORT_FORCE)
+	/* Habilita el DWT y su contador de ciclos */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0U;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	s_ticksPerSecond = SystemCoreClock;
+#elif defined(__x86_64__) || defined(__i386__)
+	/* Frecuencia de rdtsc contra clock_gettime durante 10 ms */
+	uint64_t t0 = PROF_NowNs();
+	uint64_t c0 = __rdtsc();
+	uint64_t t1;
+	do
+	{
+		t1 = PROF_NowNs();
+	} while(t1 - t0 < 10000000U);
+	uint64_t c1 = __rdtsc();
+	s_ticksPerSecond = (c1 - c0) * 1000000000U / (t1 - t0);
+#else
+	s_ticksPerSecond = 1000000000U;
+#endif
+
+	PROF_Reset();
+}
+
+void PROF_Reset(void)
+{
+	memset(g_profStats, 0, sizeof(g_profStats));
+	for(uint32_t i = 0; i < kPROF_NumScopes; i++)
+	{
+		g_profStats[i].min = UINT32_MAX;
+	}
+}
+
+uint64_t PROF_TicksPerSecond(void)
+{
+	return s_ticksPerSecond;
+}
+
+const char *PROF_GetName(prof_scope_t scope)
+{
+	return (scope < kPROF_NumScopes) ? s_profNames[scope] : "?";
+}
@@ -0,0 +1,126 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Medicion de ciclos por etapa del lazo de tramas. En el Cortex-M4 se usa el contador
+	de ciclos del DWT (DWT->CYCCNT, un ciclo de reloj por tick). En el host se usa rdtsc
+	en x86 y clock_gettime (nanosegundos) en el resto.
+
+	Cada etapa (prof_scope_t) acumula cantidad de mediciones, minimo, maximo, suma (para
+	la media) y un histograma logaritmico: el bin b cuenta las mediciones de
+	[2^(b-1), 2^b) ticks (el bin 0 las de 0 ticks). Al terminar la corrida se envian con
+	TELEMETRY_SendProfile().
+
+	Se mide con:
+		PROF_BEGIN(kPROF_Plant);
+		arm_fir_q15(...);
+		PROF_END(kPROF_Plant);
+	Cada par cuesta dos lecturas del contador y unas 10 instrucciones. Con PROF_ENABLE
+	en 0 las macros no generan codigo.
+ */
+
+#ifndef PROF_H_
+#define PROF_H_
+
+#include "arm_math.h"
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE (1)
+#endif
+
+#define PROF_HIST_BINS (32U)
+
+#if defined(__arm__) && !defined(DSP_PORT_FORCE)
+#include "fsl_device_registers.h"
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/* Etapas medidas. Los nombres estan en prof.c, en el mismo orden */
+typedef enum _prof_scope
+{
+	kPROF_Input = 0U,		/* Señal de entrada (PRNG_FillQ15, o copia del bloque adquirido) */
+	kPROF_Plant,			/* Planta (arm_fir_q15) */
+	kPROF_Adapt,			/* Filtro adaptativo (arm_lms_q15 o el algoritmo elegido, y la planta
+							 * si se usa el kernel fusionado) */
+	kPROF_Mse,				/* MSE de la trama */
+	kPROF_Output,			/* Armado de la salida (telemetria o trama de salida) */
+	kPROF_Frame,			/* Trama completa */
+	kPROF_NumScopes,
+} prof_scope_t;
+
+typedef struct _prof_stats
+{
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t hist[PROF_HIST_BINS];
+} prof_stats_t;
+
+/* En el host cada hilo tiene sus estadisticas (ident_sweep corre un motor por hilo) */
+#if defined(__arm__) && !defined(DSP_PORT_FORCE)
+#define PROF_THREAD_LOCAL
+#else
+#define PROF_THREAD_LOCAL __thread
+#endif
+
+extern PROF_THREAD_LOCAL prof_stats_t g_profStats[kPROF_NumScopes];
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Habilita el contador (DWT en el Cortex-M4, calibracion de rdtsc en el host) y borra
+ * las estadisticas */
+void PROF_Init(void);
+
+void PROF_Reset(void);
+
+/* Ticks por segundo del contador */
+uint64_t PROF_TicksPerSecond(void);
+
+const char *PROF_GetName(prof_scope_t scope);
+
+#if defined(__cplusplus)
+}
+#endif
+
+static inline uint32_t PROF_Now(void)
+{
+#if defined(__arm__) && !defined(DSP_PORT_FORCE)
+	return DWT->CYCCNT;
+#elif defined(__x86_64__) || defined(__i386__)
+	return (uint32_t)__rdtsc();
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint32_t)((uint64_t)t.tv_sec * 1000000000U + (uint64_t)t.tv_nsec);
+#endif
+}
+
+static inline void PROF_Record(prof_scope_t scope, uint32_t ticks)
+{
+	prof_stats_t *stats = &g_profStats[scope];
+	uint32_t bin = 32U - __CLZ(ticks);
+
+	stats->count++;
+	stats->sum += ticks;
+	stats->min = (ticks < stats->min) ? ticks : stats->min;
+	stats->max = (ticks > stats->max) ? ticks : stats->max;
+	stats->hist[(bin < PROF_HIST_BINS) ? bin : (PROF_HIST_BINS - 1U)]++;
+}
+
+#if PROF_ENABLE
+#define PROF_BEGIN(scope) uint32_t prof_start_##scope = PROF_Now()
+#define PROF_END(scope) PROF_Record((scope), PROF_Now() - prof_start_##scope)
+#else
+#define PROF_BEGIN(scope)
+#define PROF_END(scope)
+#endif
+
+#endif /* PROF_H_ */
@@ -0,0 +1,320 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    RLS en punto flotante y en punto fijo (ver rls.h).
+	P es simetrica: se actualiza el triangulo superior y se copia al inferior, para que
+	los errores de redondeo no la vuelvan asimetrica.
+ */
+
+#include "rls.h"
+#include <math.h>
+
+/*******************************************************************************
+ * Auxiliares de punto fijo
+ ******************************************************************************/
+
+/* Cantidad de bits significativos de |v| */
+static inline int32_t RLS_BitLen(int64_t v)
+{
+	uint64_t a = (v < 0) ? (uint64_t)(-v) : (uint64_t)v;
+	return (a == 0U) ? 0 : (64 - __builtin_clzll(a));
+}
+
+/* v * 2^shift, saturando a 64 bits si shift > 0 */
+static inline int64_t RLS_Shift(int64_t v, int32_t shift)
+{
+	if(shift >= 0)
+	{
+		if(shift > 62)
+		{
+			shift = 62;
+		}
+		if(RLS_BitLen(v) + shift > 62)
+		{
+			return (v < 0) ? -INT64_MAX : INT64_MAX;
+		}
+		return v * ((int64_t)1 << shift);
+	}
+	return (shift < -63) ? ((v < 0) ? -1 : 0) : (v >> (-shift));
+}
+
+static inline q31_t RLS_Sat32(int64_t v)
+{
+	return (v > INT32_MAX) ? INT32_MAX : ((v < INT32_MIN) ? INT32_MIN : (q31_t)v);
+}
+
+static inline q15_t RLS_Sat16(int64_t v)
+{
+	return (v > INT16_MAX) ? INT16_MAX : ((v < INT16_MIN) ? INT16_MIN : (q15_t)v);
+}
+
+/* [-1, 1) -> q15 con saturacion, antes de convertir a entero para no desbordar */
+static inline q15_t RLS_FloatToQ15(float32_t v)
+{
+	v *= 32768.0f;
+	return (v >= 32767.0f) ? INT16_MAX : ((v <= -32768.0f) ? INT16_MIN : (q15_t)v);
+}
+
+/*******************************************************************************
+ * RLS f32
+ ******************************************************************************/
+
+void RLS_InitF32(rls_instance_f32 *S, uint16_t numTaps, q15_t *pState, void *pBuffer, float32_t lambda,
+				 float32_t delta, uint32_t blockSize)
+{
+	float32_t *pBuf = (float32_t *)pBuffer;
+
+	S->numTaps = numTaps;
+	S->pState = pState;
+	S->pP = pBuf;
+	S->pW = &pBuf[numTaps * numTaps];
+	S->pX = &S->pW[numTaps];
+	S->pU = &S->pX[numTaps];
+	S->lambda = lambda;
+
+	memset(pBuf, 0, RLS_BUFFER_SIZE(numTaps));
+	for(uint32_t i = 0; i < numTaps; i++)
+	{
+		S->pP[i * numTaps + i] = 1.0f / delta;
+	}
+	memset(pState, 0, (numTaps + (blockSize - 1U)) * sizeof(q15_t));
+}
+
+void RLS_ProcessF32(const rls_instance_f32 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr,
+					uint32_t blockSize)
+{
+	uint32_t numTaps = S->numTaps;
+	q15_t *pState = S->pState;
+	float32_t *pP = S->pP;
+	float32_t *pW = S->pW;
+	float32_t *pX = S->pX;
+	float32_t *pU = S->pU;
+	float32_t invLambda = 1.0f / S->lambda;
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		float32_t y = 0.0f;
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			pX[i] = (float32_t)pState[n + i] / 32768.0f;
+			y += pW[i] * pX[i];
+		}
+
+		/* u = P x, q = x' u */
+		float32_t q = 0.0f;
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			float32_t acc = 0.0f;
+			for(uint32_t j = 0; j < numTaps; j++)
+			{
+				acc += pP[i * numTaps + j] * pX[j];
+			}
+			pU[i] = acc;
+			q += pX[i] * acc;
+		}
+
+		/* Salida y error con el mismo redondeo que arm_lms_q15 */
+		q15_t yq = RLS_FloatToQ15(y);
+		q31_t e = (q31_t)pRef[n] - yq;
+		pOut[n] = yq;
+		pErr[n] = (q15_t)e;
+
+		float32_t g = 1.0f / (S->lambda + q);
+		float32_t ge = g * (float32_t)e / 32768.0f;
+
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			pW[i] += pU[i] * ge;
+		}
+
+		/* P = (P - k u') / lambda, con k = g u */
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			float32_t ki = g * pU[i];
+			for(uint32_t j = i; j < numTaps; j++)
+			{
+				float32_t p = (pP[i * numTaps + j] - ki * pU[j]) * invLambda;
+				pP[i * numTaps + j] = p;
+				pP[j * numTaps + i] = p;
+			}
+		}
+	}
+
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+}
+
+void RLS_GetCoeffsF32(const rls_instance_f32 *S, q15_t *pCoeffs)
+{
+	for(uint32_t i = 0; i < S->numTaps; i++)
+	{
+		pCoeffs[i] = RLS_FloatToQ15(S->pW[i]);
+	}
+}
+
+/*******************************************************************************
+ * RLS q31
+ ******************************************************************************/
+
+void RLS_InitQ31(rls_instance_q31 *S, uint16_t numTaps, q15_t *pState, void *pBuffer, float32_t lambda,
+				 float32_t delta, uint32_t blockSize)
+{
+	q31_t *pBuf = (q31_t *)pBuffer;
+
+	S->numTaps = numTaps;
+	S->pState = pState;
+	S->pAcc = (int64_t *)pBuffer;
+	pBuf += 2U * numTaps;
+	S->pP = pBuf;
+	S->pW = &pBuf[numTaps * numTaps];
+	S->pU = &S->pW[numTaps];
+	S->pK = &S->pU[numTaps];
+	S->lambda = (q31_t)(lambda * 1073741824.0f);
+	S->invLambda = (q31_t)(1073741824.0f / lambda);
+
+	/* P = I / delta: mantisa 2^29 en la diagonal */
+	S->pExp = (int32_t)lroundf(log2f(1.0f / delta)) - 29;
+	memset(pBuffer, 0, RLS_BUFFER_SIZE(numTaps));
+	for(uint32_t i = 0; i < numTaps; i++)
+	{
+		S->pP[i * numTaps + i] = (q31_t)1 << 29;
+	}
+	memset(pState, 0, (numTaps + (blockSize - 1U)) * sizeof(q15_t));
+}
+
+void RLS_ProcessQ31(rls_instance_q31 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr,
+					uint32_t blockSize)
+{
+	uint32_t numTaps = S->numTaps;
+	q15_t *pState = S->pState;
+	q31_t *pP = S->pP;
+	q31_t *pW = S->pW;
+	q31_t *pU = S->pU;
+	q31_t *pK = S->pK;
+	int64_t *acc = S->pAcc;
+
+	memcpy(&pState[numTaps - 1U], pSrc, blockSize * sizeof(q15_t));
+
+	for(uint32_t n = 0; n < blockSize; n++)
+	{
+		const q15_t *px = &pState[n];
+
+		/* y = w' x: Q1.30 * Q.15 = 2^-45, se pasa a q15 */
+		int64_t yacc = 0;
+		int64_t umax = 0;	/* OR de los |u|: tiene la misma cantidad de bits que el maximo */
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			yacc += (int64_t)pW[i] * px[i];
+
+			/* u = P x, |acc| < numTaps * 2^45 */
+			int64_t a = 0;
+			for(uint32_t j = 0; j < numTaps; j++)
+			{
+				a += (int64_t)pP[i * numTaps + j] * px[j];
+			}
+			acc[i] = a;
+			umax |= (a < 0) ? -a : a;
+		}
+
+		q15_t yq = RLS_Sat16(yacc >> 30);
+		q31_t e = (q31_t)pRef[n] - yq;
+		pOut[n] = yq;
+		pErr[n] = (q15_t)e;
+
+		if(umax == 0)
+		{
+			/* Sin excitacion: k = 0, solo se aplica el olvido */
+			for(uint32_t i = 0; i < numTaps * numTaps; i++)
+			{
+				pP[i] = RLS_Sat32(((int64_t)pP[i] * S->invLambda) >> 30);
+			}
+			continue;
+		}
+
+		/* Mantisas de u con |u| < 2^30, valor = pU * 2^uExp */
+		int32_t sh = RLS_BitLen(umax) - 30;
+		int32_t uExp = S->pExp - 15 + sh;
+		int64_t q = 0;
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			pU[i] = (q31_t)RLS_Shift(acc[i], -sh);
+			q += (int64_t)pU[i] * px[i];
+		}
+
+		/* denominador = lambda + x' u, con lambda = S->lambda * 2^-30 y x' u = q * 2^(uExp - 15) */
+		int32_t qExp = uExp - 15;
+		int64_t den;
+		int32_t denExp;
+		if(qExp > -30)
+		{
+			den = q + RLS_Shift(S->lambda, -30 - qExp);
+			denExp = qExp;
+		}
+		else
+		{
+			den = RLS_Shift(q, qExp + 30) + S->lambda;
+			denExp = -30;
+		}
+		int32_t sh2 = RLS_BitLen(den) - 30;
+		int64_t dm = RLS_Shift(den, -sh2);
+		denExp += sh2;
+
+		/* k = u / den = pK * 2^kExp, con una sola division */
+		int64_t recip = ((int64_t)1 << 61) / dm;
+		int32_t kExp = uExp - denExp - 30;
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			pK[i] = (q31_t)(((int64_t)pU[i] * recip) >> 31);
+		}
+
+		/* w += k e: (pK * 2^kExp) * (e * 2^-15) en unidades de 2^-30 */
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			int64_t dw = RLS_Shift((int64_t)pK[i] * e, kExp + 15);
+			pW[i] = RLS_Sat32((int64_t)pW[i] + dw);
+		}
+
+		/* P = (P - k u') / lambda, en unidades de 2^pExp */
+		int32_t tShift = kExp + uExp - S->pExp;
+		int64_t pmax = 0;
+		for(uint32_t i = 0; i < numTaps; i++)
+		{
+			for(uint32_t j = i; j < numTaps; j++)
+			{
+				/* |P - k u'| <= max|P| por ser semidefinida positiva; se acota por si
+				 * P esta mal condicionada, para no desbordar al dividir por lambda */
+				int64_t t = RLS_Shift((int64_t)pK[i] * pU[j], tShift);
+				int64_t d = (int64_t)pP[i * numTaps + j] - t;
+				d = (d > ((int64_t)1 << 32)) ? ((int64_t)1 << 32) : ((d < -((int64_t)1 << 32)) ? -((int64_t)1 << 32) : d);
+				int64_t p = (d * S->invLambda) >> 30;
+				q31_t pq = RLS_Sat32(p);
+				pP[i * numTaps + j] = pq;
+				pP[j * numTaps + i] = pq;
+				pmax |= (pq < 0) ? -(int64_t)pq : pq;
+			}
+		}
+
+		/* Se reajusta el exponente para que max|P| quede en [2^28, 2^30) */
+		int32_t len = RLS_BitLen(pmax);
+		if((len > 30) || ((len > 0) && (len < 29)))
+		{
+			int32_t adj = len - 30;
+			for(uint32_t i = 0; i < numTaps * numTaps; i++)
+			{
+				pP[i] = (q31_t)RLS_Shift(pP[i], -adj);
+			}
+			S->pExp += adj;
+		}
+	}
+
+	memmove(pState, &pState[blockSize], (numTaps - 1U) * sizeof(q15_t));
+}
+
+void RLS_GetCoeffsQ31(const rls_instance_q31 *S, q15_t *pCoeffs)
+{
+	for(uint32_t i = 0; i < S->numTaps; i++)
+	{
+		/* Q1.30 -> q15 */
+		pCoeffs[i] = RLS_Sat16(S->pW[i] >> 15);
+	}
+}
@@ -0,0 +1,85 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Identificacion por minimos cuadrados recursivos (RLS) con factor de olvido lambda,
+	como alternativa a arm_lms_q15. Por cada muestra:
+		u = P x                 k = u / (lambda + x' u)
+		e = ref - w' x          w = w + k e
+		P = (P - k u') / lambda
+	con P = I / delta al iniciar. El costo es O(N^2) por muestra, pero la convergencia
+	no depende de mu ni de la potencia de la señal de entrada.
+
+	Hay dos versiones con la misma interfaz que arm_lms_q15 (mismo formato del buffer
+	de estado y de los coeficientes, invertidos en el tiempo como en CMSIS):
+	 - f32: en punto flotante, con las muestras q15 escaladas a [-1, 1).
+	 - q31: en punto fijo. P se guarda en punto flotante por bloque (mantisas q31 con un
+	   exponente comun que se reajusta para que max|P| quede en [2^28, 2^30)), u y la
+	   ganancia k se normalizan en cada muestra y los coeficientes se guardan en Q1.30.
+	   Se usa una sola division (64 bits) por muestra.
+	La salida y el error se redondean como en arm_lms_q15: el error se guarda truncado a
+	16 bits y se usa sin saturar para actualizar w.
+ */
+
+#ifndef RLS_H_
+#define RLS_H_
+
+#include "arm_math.h"
+
+/* Bytes del buffer de trabajo (P, w y vectores auxiliares) para numTaps coeficientes */
+#define RLS_BUFFER_SIZE(numTaps) (((numTaps) * (numTaps) + 5U * (numTaps)) * 4U)
+
+/* Instancia del RLS en punto flotante */
+typedef struct _rls_instance_f32
+{
+	uint16_t numTaps;
+	q15_t *pState;			/* numTaps + blockSize - 1 muestras, mismo formato que CMSIS */
+	float32_t *pP;			/* Matriz P (numTaps x numTaps) */
+	float32_t *pW;			/* Coeficientes */
+	float32_t *pX;			/* Ventana de entrada de la muestra actual */
+	float32_t *pU;			/* u = P x */
+	float32_t lambda;
+} rls_instance_f32;
+
+/* Instancia del RLS en punto fijo */
+typedef struct _rls_instance_q31
+{
+	uint16_t numTaps;
+	q15_t *pState;
+	int64_t *pAcc;			/* Acumuladores de P x */
+	q31_t *pP;				/* Mantisas de P, valor = pP * 2^pExp */
+	q31_t *pW;				/* Coeficientes en Q1.30 */
+	q31_t *pU;				/* Mantisas de u */
+	q31_t *pK;				/* Mantisas de k */
+	int32_t pExp;
+	q31_t lambda;			/* lambda en Q1.30 */
+	q31_t invLambda;		/* 1 / lambda en Q1.30 */
+} rls_instance_q31;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* pBuffer debe tener RLS_BUFFER_SIZE(numTaps) bytes, alineado a 8 */
+void RLS_InitF32(rls_instance_f32 *S, uint16_t numTaps, q15_t *pState, void *pBuffer, float32_t lambda,
+				 float32_t delta, uint32_t blockSize);
+
+/* Misma interfaz que arm_lms_q15 */
+void RLS_ProcessF32(const rls_instance_f32 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr,
+					uint32_t blockSize);
+
+/* Coeficientes en q15, en el orden de CMSIS */
+void RLS_GetCoeffsF32(const rls_instance_f32 *S, q15_t *pCoeffs);
+
+/* lambda y delta solo se usan para calcular las constantes en punto fijo */
+void RLS_InitQ31(rls_instance_q31 *S, uint16_t numTaps, q15_t *pState, void *pBuffer, float32_t lambda,
+				 float32_t delta, uint32_t blockSize);
+
+void RLS_ProcessQ31(rls_instance_q31 *S, const q15_t *pSrc, const q15_t *pRef, q15_t *pOut, q15_t *pErr,
+					uint32_t blockSize);
+
+void RLS_GetCoeffsQ31(const rls_instance_q31 *S, q15_t *pCoeffs);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* RLS_H_ */
@@ -0,0 +1,472 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Cola de transmision de dos buffers y paquetes de telemetria (ver telemetry.h).
+ */
+
+#include "telemetry.h"
+#include "prof.h"
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+static inline uint8_t *TELEMETRY_PutU16(uint8_t *p, uint16_t value)
+{
+	p[0] = (uint8_t)(value & 0x0FFU);
+	p[1] = (uint8_t)(value >> 8);
+	return p + 2;
+}
+
+static inline uint8_t *TELEMETRY_PutU32(uint8_t *p, uint32_t value)
+{
+	p = TELEMETRY_PutU16(p, (uint16_t)(value & 0x0FFFFU));
+	return TELEMETRY_PutU16(p, (uint16_t)(value >> 16));
+}
+
+/* Tabla de a 4 bits del CRC-16/CCITT (polinomio 0x1021) */
+static const uint16_t s_crcTable[16] = {
+	0x0000U, 0x1021U, 0x2042U, 0x3063U, 0x4084U, 0x50A5U, 0x60C6U, 0x70E7U,
+	0x8108U, 0x9129U, 0xA14AU, 0xB16BU, 0xC18CU, 0xD1ADU, 0xE1CEU, 0xF1EFU,
+};
+
+/* Escritura de bits del MSB al LSB */
+typedef struct _telemetry_bits
+{
+	uint8_t *p;
+	uint32_t acc;
+	uint32_t count;				/* Bits validos en acc */
+} telemetry_bits_t;
+
+static inline void TELEMETRY_PutBits(telemetry_bits_t *bits, uint32_t value, uint32_t n)
+{
+	while(n > 0U)
+	{
+		uint32_t take = (n > 16U) ? 16U : n;
+		n -= take;
+		bits->acc = (bits->acc << take) | ((value >> n) & ((1UL << take) - 1U));
+		bits->count += take;
+		while(bits->count >= 8U)
+		{
+			bits->count -= 8U;
+			*bits->p++ = (uint8_t)(bits->acc >> bits->count);
+		}
+	}
+}
+
+static inline uint8_t *TELEMETRY_EndBits(telemetry_bits_t *bits)
+{
+	if(bits->count > 0U)
+	{
+		*bits->p++ = (uint8_t)(bits->acc << (8U - bits->count));
+	}
+	return bits->p;
+}
+
+/* Bits de u con Rice de parametro k */
+static inline uint32_t TELEMETRY_RiceCost(uint32_t u, uint32_t k)
+{
+	uint32_t q = u >> k;
+	return (q < TELEMETRY_RICE_ESCAPE) ? (q + 1U + k) : (TELEMETRY_RICE_ESCAPE + 16U);
+}
+
+static inline uint32_t TELEMETRY_ZigZag(int32_t d)
+{
+	return ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+}
+
+uint16_t TELEMETRY_Crc16(uint16_t crc, const uint8_t *data, uint32_t size)
+{
+	for(uint32_t i = 0; i < size; i++)
+	{
+		crc = (uint16_t)((crc << 4) ^ s_crcTable[((crc >> 12) ^ (data[i] >> 4)) & 0x0FU]);
+		crc = (uint16_t)((crc << 4) ^ s_crcTable[((crc >> 12) ^ data[i]) & 0x0FU]);
+	}
+	return crc;
+}
+
+uint16_t TELEMETRY_LogCode(q31_t mse, uint32_t fracBits)
+{
+	if(mse <= 0)
+	{
+		return 0U;
+	}
+
+	/* Parte entera: posicion del bit mas significativo */
+	uint32_t exponent = 31U - __CLZ((uint32_t)mse);
+
+	/* Parte fraccionaria bit a bit: se eleva al cuadrado la mantisa (en [1, 2) con 30
+	 * bits fraccionarios) y si pasa de 2 el bit es 1. Se calcula un bit de mas para
+	 * redondear */
+	uint64_t m = ((uint64_t)(uint32_t)mse << 30) >> exponent;
+	uint32_t frac = 0U;
+	for(uint32_t i = 0; i <= fracBits; i++)
+	{
+		m = (m * m) >> 30;
+		frac <<= 1;
+		if(m >= (1ULL << 31))
+		{
+			frac |= 1U;
+			m >>= 1;
+		}
+	}
+
+	return (uint16_t)(1U + (exponent << fracBits) + ((frac + 1U) >> 1));
+}
+
+void TELEMETRY_Init(telemetry_handle_t *handle, telemetry_send_t send, void *userData,
+					telemetry_mse_encoding_t mseEncoding)
+{
+	handle->send = send;
+	handle->userData = userData;
+	handle->txBusy = false;
+	handle->active = 0U;
+	handle->fill = 0U;
+	handle->mseEncoding = mseEncoding;
+	handle->mseFirst = 0U;
+	handle->mseCount = 0U;
+}
+
+void TELEMETRY_TxDone(telemetry_handle_t *handle)
+{
+	handle->txBusy = false;
+}
+
+void TELEMETRY_Flush(telemetry_handle_t *handle)
+{
+	if(handle->fill == 0U)
+	{
+		return;
+	}
+
+	/* Se espera a que se libere el otro buffer */
+	while(handle->txBusy)
+	{
+	}
+
+	uint8_t *data = handle->buffer[handle->active];
+	uint32_t size = handle->fill;
+
+	handle->txBusy = true;
+	handle->active ^= 1U;
+	handle->fill = 0U;
+	handle->send(handle->userData, data, size);
+}
+
+void TELEMETRY_Drain(telemetry_handle_t *handle)
+{
+	TELEMETRY_Flush(handle);
+	while(handle->txBusy)
+	{
+	}
+}
+
+void TELEMETRY_Write(telemetry_handle_t *handle, const uint8_t *data, uint32_t size)
+{
+	while(size > 0U)
+	{
+		uint32_t room = TELEMETRY_BUFFER_SIZE - handle->fill;
+		uint32_t n = (size < room) ? size : room;
+
+		memcpy(&handle->buffer[handle->active][handle->fill], data, n);
+		handle->fill += n;
+		data += n;
+		size -= n;
+
+		if(handle->fill == TELEMETRY_BUFFER_SIZE)
+		{
+			TELEMETRY_Flush(handle);
+		}
+	}
+}
+
+/* Cabecera del paquete. Devuelve el CRC parcial */
+static uint16_t TELEMETRY_BeginPacket(telemetry_handle_t *handle, uint8_t type, uint16_t size)
+{
+	uint8_t header[TELEMETRY_HEADER_SIZE];
+	uint8_t *p = header;
+
+	*p++ = TELEMETRY_SYNC0;
+	*p++ = TELEMETRY_SYNC1;
+	*p++ = TELEMETRY_VERSION;
+	*p++ = type;
+	TELEMETRY_PutU16(p, size);
+	TELEMETRY_Write(handle, header, TELEMETRY_HEADER_SIZE);
+	return TELEMETRY_Crc16(0xFFFFU, &header[2], TELEMETRY_HEADER_SIZE - 2U);
+}
+
+static void TELEMETRY_PutPayload(telemetry_handle_t *handle, uint16_t *crc, const uint8_t *data, uint32_t size)
+{
+	*crc = TELEMETRY_Crc16(*crc, data, size);
+	TELEMETRY_Write(handle, data, size);
+}
+
+static void TELEMETRY_EndPacket(telemetry_handle_t *handle, uint16_t crc)
+{
+	uint8_t tail[TELEMETRY_CRC_SIZE];
+
+	TELEMETRY_PutU16(tail, crc);
+	TELEMETRY_Write(handle, tail, TELEMETRY_CRC_SIZE);
+}
+
+static void TELEMETRY_PutQ15s(telemetry_handle_t *handle, uint16_t *crc, const q15_t *values, uint16_t count)
+{
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint8_t value[2];
+		TELEMETRY_PutU16(value, (uint16_t)values[i]);
+		TELEMETRY_PutPayload(handle, crc, value, sizeof(value));
+	}
+}
+
+void TELEMETRY_SendStart(telemetry_handle_t *handle, const q15_t *plantCoeffs, uint16_t numTaps, q15_t mu,
+						 q15_t signalPower, uint32_t numFrames, uint16_t blockSize)
+{
+	uint8_t header[14];
+	uint8_t *p = header;
+
+	/* Los MSE de la corrida anterior van antes del inicio de la nueva */
+	TELEMETRY_FlushMse(handle);
+
+	p = TELEMETRY_PutU16(p, numTaps);
+	p = TELEMETRY_PutU32(p, numFrames);
+	p = TELEMETRY_PutU16(p, (uint16_t)mu);
+	p = TELEMETRY_PutU16(p, (uint16_t)signalPower);
+	p = TELEMETRY_PutU16(p, blockSize);
+	*p++ = (uint8_t)handle->mseEncoding;
+	*p++ = (uint8_t)TELEMETRY_LOG_BITS;
+
+	uint16_t crc = TELEMETRY_BeginPacket(handle, 'S', (uint16_t)((p - header) + (numTaps * 2U)));
+	TELEMETRY_PutPayload(handle, &crc, header, (uint32_t)(p - header));
+	TELEMETRY_PutQ15s(handle, &crc, plantCoeffs, numTaps);
+	TELEMETRY_EndPacket(handle, crc);
+}
+
+void TELEMETRY_SendMse(telemetry_handle_t *handle, uint32_t frame, q31_t mse)
+{
+	if((handle->mseCount > 0U) && (frame != handle->mseFirst + handle->mseCount))
+	{
+		TELEMETRY_FlushMse(handle);
+	}
+	if(handle->mseCount == 0U)
+	{
+		handle->mseFirst = frame;
+	}
+
+	handle->mse[handle->mseCount++] = mse;
+	if(handle->mseCount == TELEMETRY_MSE_BLOCK)
+	{
+		TELEMETRY_FlushMse(handle);
+	}
+}
+
+/* Diferencias en zigzag varint */
+static uint8_t *TELEMETRY_EncodeDelta(uint8_t *p, const q31_t *mse, uint32_t count)
+{
+	q31_t prev = 0;
+
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint32_t u = TELEMETRY_ZigZag((int32_t)((uint32_t)mse[i] - (uint32_t)prev));
+		prev = mse[i];
+		while(u >= 0x80U)
+		{
+			*p++ = (uint8_t)(u | 0x80U);
+			u >>= 7;
+		}
+		*p++ = (uint8_t)u;
+	}
+	return p;
+}
+
+/* Diferencias del logaritmo con Rice, eligiendo k por grupo */
+static uint8_t *TELEMETRY_EncodeLog(uint8_t *p, const q31_t *mse, uint32_t count)
+{
+	telemetry_bits_t bits = {p, 0U, 0U};
+	uint32_t u[TELEMETRY_RICE_GROUP];
+	uint16_t prev = 0U;
+
+	for(uint32_t group = 0; group < count; group += TELEMETRY_RICE_GROUP)
+	{
+		uint32_t n = ((count - group) < TELEMETRY_RICE_GROUP) ? (count - group) : TELEMETRY_RICE_GROUP;
+
+		for(uint32_t i = 0; i < n; i++)
+		{
+			uint16_t code = TELEMETRY_LogCode(mse[group + i], TELEMETRY_LOG_BITS);
+			u[i] = TELEMETRY_ZigZag((int32_t)code - (int32_t)prev);
+			prev = code;
+		}
+
+		uint32_t bestK = 0U;
+		uint32_t bestCost = UINT32_MAX;
+		for(uint32_t k = 0; k < 15U; k++)
+		{
+			uint32_t cost = 0U;
+			for(uint32_t i = 0; i < n; i++)
+			{
+				cost += TELEMETRY_RiceCost(u[i], k);
+			}
+			if(cost < bestCost)
+			{
+				bestCost = cost;
+				bestK = k;
+			}
+		}
+
+		TELEMETRY_PutBits(&bits, bestK, 4U);
+		for(uint32_t i = 0; i < n; i++)
+		{
+			uint32_t q = u[i] >> bestK;
+			if(q < TELEMETRY_RICE_ESCAPE)
+			{
+				/* q unos y un cero */
+				TELEMETRY_PutBits(&bits, ((1UL << q) - 1U) << 1, q + 1U);
+				TELEMETRY_PutBits(&bits, u[i], bestK);
+			}
+			else
+			{
+				TELEMETRY_PutBits(&bits, (1UL << TELEMETRY_RICE_ESCAPE) - 1U, TELEMETRY_RICE_ESCAPE);
+				TELEMETRY_PutBits(&bits, u[i], 16U);
+			}
+		}
+	}
+	return TELEMETRY_EndBits(&bits);
+}
+
+void TELEMETRY_FlushMse(telemetry_handle_t *handle)
+{
+	if(handle->mseCount == 0U)
+	{
+		return;
+	}
+
+	uint8_t *payload = &handle->packet[TELEMETRY_HEADER_SIZE];
+	uint8_t *p = payload;
+
+	p = TELEMETRY_PutU32(p, handle->mseFirst);
+	p = TELEMETRY_PutU16(p, (uint16_t)handle->mseCount);
+	if(handle->mseEncoding == kTELEMETRY_MseLog)
+	{
+		p = TELEMETRY_EncodeLog(p, handle->mse, handle->mseCount);
+	}
+	else
+	{
+		p = TELEMETRY_EncodeDelta(p, handle->mse, handle->mseCount);
+	}
+	handle->mseCount = 0U;
+
+	/* El paquete se arma completo en handle->packet y se copia a la cola de una vez */
+	uint8_t *header = handle->packet;
+	header[0] = TELEMETRY_SYNC0;
+	header[1] = TELEMETRY_SYNC1;
+	header[2] = TELEMETRY_VERSION;
+	header[3] = 'M';
+	TELEMETRY_PutU16(&header[4], (uint16_t)(p - payload));
+	p = TELEMETRY_PutU16(p, TELEMETRY_Crc16(0xFFFFU, &header[2], (uint32_t)(p - &header[2])));
+	TELEMETRY_Write(handle, handle->packet, (uint32_t)(p - handle->packet));
+}
+
+void TELEMETRY_SendCoeffs(telemetry_handle_t *handle, uint32_t frame, const q15_t *coeffs, uint16_t numTaps)
+{
+	uint8_t header[6];
+	uint8_t *p = header;
+
+	p = TELEMETRY_PutU32(p, frame);
+	p = TELEMETRY_PutU16(p, numTaps);
+
+	uint16_t crc = TELEMETRY_BeginPacket(handle, 'C', (uint16_t)((p - header) + (numTaps * 2U)));
+	TELEMETRY_PutPayload(handle, &crc, header, (uint32_t)(p - header));
+	TELEMETRY_PutQ15s(handle, &crc, coeffs, numTaps);
+	TELEMETRY_EndPacket(handle, crc);
+}
+
+/* Rango de bins del histograma distintos de 0 */
+static void TELEMETRY_ProfileBins(const prof_stats_t *stats, uint32_t *first, uint32_t *count)
+{
+	uint32_t lo = 0U;
+	uint32_t hi = PROF_HIST_BINS;
+
+	while((lo < hi) && (stats->hist[lo] == 0U))
+	{
+		lo++;
+	}
+	while((hi > lo) && (stats->hist[hi - 1U] == 0U))
+	{
+		hi--;
+	}
+	*first = lo;
+	*count = hi - lo;
+}
+
+void TELEMETRY_SendProfile(telemetry_handle_t *handle)
+{
+	uint32_t size = 9U;
+	uint8_t numScopes = 0U;
+
+	/* Primero el largo del contenido */
+	for(uint32_t i = 0; i < kPROF_NumScopes; i++)
+	{
+		if(g_profStats[i].count > 0U)
+		{
+			uint32_t first, count;
+			TELEMETRY_ProfileBins(&g_profStats[i], &first, &count);
+			size += 1U + (uint32_t)strlen(PROF_GetName((prof_scope_t)i)) + 22U + count * 4U;
+			numScopes++;
+		}
+	}
+
+	uint8_t header[9];
+	uint64_t ticksPerSecond = PROF_TicksPerSecond();
+	TELEMETRY_PutU32(header, (uint32_t)ticksPerSecond);
+	TELEMETRY_PutU32(&header[4], (uint32_t)(ticksPerSecond >> 32));
+	header[8] = numScopes;
+	uint16_t crc = TELEMETRY_BeginPacket(handle, 'P', (uint16_t)size);
+	TELEMETRY_PutPayload(handle, &crc, header, sizeof(header));
+
+	for(uint32_t i = 0; i < kPROF_NumScopes; i++)
+	{
+		const prof_stats_t *stats = &g_profStats[i];
+		if(stats->count == 0U)
+		{
+			continue;
+		}
+
+		const char *name = PROF_GetName((prof_scope_t)i);
+		uint8_t length = (uint8_t)strlen(name);
+		TELEMETRY_PutPayload(handle, &crc, &length, 1U);
+		TELEMETRY_PutPayload(handle, &crc, (const uint8_t *)name, length);
+
+		uint8_t record[22];
+		uint8_t *p = record;
+		uint32_t first, count;
+		TELEMETRY_ProfileBins(stats, &first, &count);
+		p = TELEMETRY_PutU32(p, stats->count);
+		p = TELEMETRY_PutU32(p, stats->min);
+		p = TELEMETRY_PutU32(p, stats->max);
+		p = TELEMETRY_PutU32(p, (uint32_t)stats->sum);
+		p = TELEMETRY_PutU32(p, (uint32_t)(stats->sum >> 32));
+		*p++ = (uint8_t)first;
+		*p++ = (uint8_t)count;
+		TELEMETRY_PutPayload(handle, &crc, record, sizeof(record));
+
+		for(uint32_t b = first; b < first + count; b++)
+		{
+			uint8_t bin[4];
+			TELEMETRY_PutU32(bin, stats->hist[b]);
+			TELEMETRY_PutPayload(handle, &crc, bin, sizeof(bin));
+		}
+	}
+	TELEMETRY_EndPacket(handle, crc);
+}
+
+void TELEMETRY_SendEnd(telemetry_handle_t *handle, uint32_t numFrames)
+{
+	uint8_t record[4];
+
+	TELEMETRY_FlushMse(handle);
+
+	TELEMETRY_PutU32(record, numFrames);
+	uint16_t crc = TELEMETRY_BeginPacket(handle, 'E', sizeof(record));
+	TELEMETRY_PutPayload(handle, &crc, record, sizeof(record));
+	TELEMETRY_EndPacket(handle, crc);
+	TELEMETRY_Flush(handle);
+}
@@ -0,0 +1,164 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Telemetria por trama. En lugar de guardar el MSE de todas las tramas y enviarlo al
+	final de la corrida, cada trama se envia apenas se calcula, por lo que el host ve el
+	avance y la memoria usada no depende de la cantidad de tramas.
+
+	Los paquetes se escriben en una cola de dos buffers de TELEMETRY_BUFFER_SIZE bytes:
+	mientras uno se transmite, el otro se llena. Cuando el buffer que se llena no tiene
+	lugar, se espera a que termine la transmision del otro y se intercambian. El envio lo
+	hace una funcion del usuario (UART, archivo, pipe), que debe llamar a
+	TELEMETRY_TxDone() cuando termina (puede hacerlo antes de volver si es bloqueante, o
+	desde la interrupcion de fin de transmision).
+
+	Formato (version TELEMETRY_VERSION, little endian). Cada paquete es:
+		0xA5 0x5A, uint8 version, uint8 tipo, uint16 largo del contenido, contenido,
+		uint16 CRC-16/CCITT (polinomio 0x1021, valor inicial 0xFFFF) de version, tipo,
+		largo y contenido
+	Un paquete con CRC incorrecto se descarta y el receptor busca el siguiente 0xA5 0x5A.
+	Tipos:
+		'S' inicio de corrida: uint16 numTaps, uint32 numFrames, int16 mu,
+		    int16 signal_power, uint16 blockSize, uint8 codificacion del MSE,
+		    uint8 bits fraccionarios del logaritmo, numTaps coeficientes q15 de la planta
+		'M' MSE de hasta TELEMETRY_MSE_BLOCK tramas consecutivas: uint32 primera trama,
+		    uint16 cantidad, muestras codificadas (ver abajo)
+		'C' coeficientes del filtro adaptativo: uint32 trama, uint16 numTaps,
+		    numTaps coeficientes q15
+		'P' ciclos por etapa (prof.h): uint64 ticks por segundo, uint8 cantidad de etapas y
+		    por etapa: uint8 largo del nombre, nombre, uint32 mediciones, uint32 minimo,
+		    uint32 maximo, uint64 suma, uint8 primer bin y uint8 cantidad de bins del
+		    histograma, uint32 por bin (solo el rango de bins distintos de 0)
+		'E' fin de corrida: uint32 cantidad de tramas procesadas
+
+	Codificaciones del MSE (q31, sin saturar). Cada paquete 'M' se decodifica solo, la
+	diferencia del primer valor es contra 0:
+		kTELEMETRY_MseDelta: sin perdidas. Diferencia con la trama anterior en zigzag
+		    ((d << 1) ^ (d >> 31)) y varint (7 bits por byte, el bit 7 indica que sigue).
+		kTELEMETRY_MseLog: con perdidas. Se envia c = 0 si mse <= 0 y si no
+		    c = 1 + round(2^R * log2(mse)), con R = TELEMETRY_LOG_BITS. El error relativo
+		    es a lo sumo 2^(1/2^(R+1)) - 1: 9 % con R = 2, menos que la dispersion propia
+		    del MSE de una trama de 100 muestras. Las diferencias en zigzag se codifican
+		    con Rice en grupos de TELEMETRY_RICE_GROUP muestras: 4 bits con k y,
+		    por muestra, q = u >> k en unario (q unos y un cero) seguido de los k bits bajos
+		    de u. Si q >= 15 se envian 15 unos y u en 16 bits. Los bits se escriben del MSB
+		    al LSB de cada byte y el ultimo byte se completa con ceros.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include "arm_math.h"
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+/* Bytes de cada uno de los dos buffers de la cola */
+#ifndef TELEMETRY_BUFFER_SIZE
+#define TELEMETRY_BUFFER_SIZE (128U)
+#endif
+
+/* Tramas de MSE por paquete 'M'. Cuantas mas, menos peso tiene la cabecera, pero el host
+ * las recibe con mas retardo */
+#ifndef TELEMETRY_MSE_BLOCK
+#define TELEMETRY_MSE_BLOCK (256U)
+#endif
+
+/* Bits fraccionarios del logaritmo en kTELEMETRY_MseLog (0 a 8) */
+#ifndef TELEMETRY_LOG_BITS
+#define TELEMETRY_LOG_BITS (2U)
+#endif
+
+#define TELEMETRY_SYNC0 (0xA5U)
+#define TELEMETRY_SYNC1 (0x5AU)
+#define TELEMETRY_VERSION (2U)
+
+/* Sincronismo, version, tipo y largo */
+#define TELEMETRY_HEADER_SIZE (6U)
+#define TELEMETRY_CRC_SIZE (2U)
+
+#define TELEMETRY_RICE_GROUP (32U)
+#define TELEMETRY_RICE_ESCAPE (15U)
+
+/* Contenido mas largo de un paquete 'M' (delta: 5 bytes por muestra como maximo) */
+#define TELEMETRY_MSE_PAYLOAD_MAX (6U + (TELEMETRY_MSE_BLOCK * 5U))
+
+typedef enum _telemetry_mse_encoding
+{
+	kTELEMETRY_MseDelta = 0U,	/* Diferencias en zigzag varint, sin perdidas */
+	kTELEMETRY_MseLog = 1U,		/* Logaritmo cuantizado con Rice, con perdidas */
+} telemetry_mse_encoding_t;
+
+/* Inicia la transmision de size bytes de data. data no cambia hasta TELEMETRY_TxDone() */
+typedef void (*telemetry_send_t)(void *userData, const uint8_t *data, uint32_t size);
+
+/* Estado de la cola de transmision */
+typedef struct _telemetry_handle
+{
+	telemetry_send_t send;
+	void *userData;
+	volatile bool txBusy;		/* Hay un buffer en transmision */
+	uint8_t active;				/* Buffer que se esta llenando */
+	uint32_t fill;				/* Bytes cargados en el buffer activo */
+	uint8_t buffer[2][TELEMETRY_BUFFER_SIZE];
+
+	telemetry_mse_encoding_t mseEncoding;
+	uint32_t mseFirst;			/* Trama del primer MSE pendiente */
+	uint32_t mseCount;			/* MSE pendientes de enviar */
+	q31_t mse[TELEMETRY_MSE_BLOCK];
+	uint8_t packet[TELEMETRY_HEADER_SIZE + TELEMETRY_MSE_PAYLOAD_MAX + TELEMETRY_CRC_SIZE];
+} telemetry_handle_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void TELEMETRY_Init(telemetry_handle_t *handle, telemetry_send_t send, void *userData,
+					telemetry_mse_encoding_t mseEncoding);
+
+/* Lo llama el transporte al terminar de enviar el buffer */
+void TELEMETRY_TxDone(telemetry_handle_t *handle);
+
+/* Agrega bytes a la cola. Si no hay lugar espera a que se libere el otro buffer */
+void TELEMETRY_Write(telemetry_handle_t *handle, const uint8_t *data, uint32_t size);
+
+/* Envia lo que haya en el buffer activo (sin esperar a que termine la transmision) */
+void TELEMETRY_Flush(telemetry_handle_t *handle);
+
+/* Espera a que no quede nada pendiente en la cola */
+void TELEMETRY_Drain(telemetry_handle_t *handle);
+
+/* CRC-16/CCITT de size bytes, partiendo de crc (0xFFFF al inicio) */
+uint16_t TELEMETRY_Crc16(uint16_t crc, const uint8_t *data, uint32_t size);
+
+/* Codigo de kTELEMETRY_MseLog de un MSE */
+uint16_t TELEMETRY_LogCode(q31_t mse, uint32_t fracBits);
+
+void TELEMETRY_SendStart(telemetry_handle_t *handle, const q15_t *plantCoeffs, uint16_t numTaps, q15_t mu,
+						 q15_t signalPower, uint32_t numFrames, uint16_t blockSize);
+
+/* Guarda el MSE de la trama. Se envia un paquete cada TELEMETRY_MSE_BLOCK tramas, o
+ * antes si la trama no sigue a la anterior */
+void TELEMETRY_SendMse(telemetry_handle_t *handle, uint32_t frame, q31_t mse);
+
+/* Envia los MSE guardados */
+void TELEMETRY_FlushMse(telemetry_handle_t *handle);
+
+void TELEMETRY_SendCoeffs(telemetry_handle_t *handle, uint32_t frame, const q15_t *coeffs, uint16_t numTaps);
+
+/* Estadisticas de prof.h de las etapas con mediciones */
+void TELEMETRY_SendProfile(telemetry_handle_t *handle);
+
+/* Paquete de fin de corrida. Envia lo pendiente */
+void TELEMETRY_SendEnd(telemetry_handle_t *handle, uint32_t numFrames);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* TELEMETRY_H_ */
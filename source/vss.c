@@ -0,0 +1,49 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Paso variable de Kwong y Johnston por trama (ver vss.h).
+ */
+
+#include "vss.h"
+
+/*******************************************************************************
+ * Codigo
+ ******************************************************************************/
+
+void VSS_GetDefaultConfig(vss_config_t *config)
+{
+	config->muMin = 500;
+	config->muMax = 20000;
+	config->alpha = 32440;		/* 0.99 */
+	config->gamma = 1 << 9;		/* 1 / 128 */
+}
+
+arm_status VSS_CheckConfig(const vss_config_t *config)
+{
+	if((config->muMin < 0) || (config->muMin > config->muMax) || (config->alpha < 0) || (config->gamma < 0))
+	{
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+	return ARM_MATH_SUCCESS;
+}
+
+static q31_t VSS_Clip(const vss_instance_t *S, q63_t mu)
+{
+	q63_t muMin = (q63_t)S->config.muMin << VSS_FRAC_BITS;
+	q63_t muMax = (q63_t)S->config.muMax << VSS_FRAC_BITS;
+
+	return (q31_t)((mu < muMin) ? muMin : ((mu > muMax) ? muMax : mu));
+}
+
+void VSS_Init(vss_instance_t *S, const vss_config_t *config, q15_t muInit)
+{
+	S->config = *config;
+	S->mu = VSS_Clip(S, (q63_t)muInit << VSS_FRAC_BITS);
+}
+
+q15_t VSS_Update(vss_instance_t *S, q31_t mse)
+{
+	q63_t mu = (((q63_t)S->mu * S->config.alpha) >> 15) + (q63_t)mse * S->config.gamma;
+
+	S->mu = VSS_Clip(S, mu);
+	return VSS_GetMu(S);
+}
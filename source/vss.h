@@ -0,0 +1,80 @@
+/*  Autor: Santiago Raimondi.
+    @brief:
+    Paso variable (VSS, variable step size) para el LMS en punto fijo, segun la regla de
+	Kwong y Johnston aplicada una vez por trama sobre el MSE de la trama:
+		mu[k + 1] = alpha * mu[k] + gamma * mse[k],  recortado a [muMin, muMax]
+	Mientras el error es grande mu sube hasta muMax y el filtro converge como con un mu
+	grande; al llegar al piso el MSE cae, mu baja hasta el valor que sostiene ese MSE
+	(gamma * mse / (1 - alpha)) y el desajuste es el de un mu chico. Si la planta cambia el
+	error vuelve a subir y mu con el. Con los valores por defecto mu queda en unas 0.78
+	veces el MSE de regimen y llega a muMax recien con un MSE de 25600.
+	Un mu chico solo sirve si la actualizacion no se trunca: en arm_lms_q15 el paso de cada
+	tap se anula y los coeficientes se frenan, por eso con paso variable ident.c usa
+	LMS_RULE_ProcessQ31Coeffs (coeficientes en q31).
+	Se usa el MSE de la trama, que el motor ya calcula, por lo que el costo es una
+	multiplicacion y una suma por trama y los kernels del LMS no cambian. La regla de
+	Mathews (gradiente de mu, e[n] * e[n-1] * x[n-1]' * x[n]) necesitaria un segundo
+	producto escalar por muestra dentro del kernel.
+
+	mu se guarda con VSS_FRAC_BITS bits fraccionarios para que los pasos chicos de alpha
+	no se pierdan por redondeo; el mu que se usa es la parte entera (q15).
+ */
+
+#ifndef VSS_H_
+#define VSS_H_
+
+#include "arm_math.h"
+
+/*******************************************************************************
+ * Definiciones
+ ******************************************************************************/
+
+/* Bits fraccionarios de mu y de gamma */
+#define VSS_FRAC_BITS (16U)
+
+/* Configuracion del paso variable */
+typedef struct _vss_config
+{
+	q15_t muMin;
+	q15_t muMax;
+	q15_t alpha;		/* Olvido por trama, en q15 */
+	q31_t gamma;		/* Incremento de mu por unidad de MSE, con VSS_FRAC_BITS bits fraccionarios */
+} vss_config_t;
+
+/* Estado del paso variable */
+typedef struct _vss_instance
+{
+	vss_config_t config;
+	q31_t mu;			/* mu con VSS_FRAC_BITS bits fraccionarios */
+} vss_instance_t;
+
+/*******************************************************************************
+ * API
+ ******************************************************************************/
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void VSS_GetDefaultConfig(vss_config_t *config);
+
+/* Devuelve ARM_MATH_ARGUMENT_ERROR si muMin es negativo o mayor que muMax, o si alpha o
+ * gamma son negativos */
+arm_status VSS_CheckConfig(const vss_config_t *config);
+
+/* Reinicia con mu inicial muInit (recortado a [muMin, muMax]) */
+void VSS_Init(vss_instance_t *S, const vss_config_t *config, q15_t muInit);
+
+/* Agrega el MSE de una trama y devuelve el mu para la trama siguiente */
+q15_t VSS_Update(vss_instance_t *S, q31_t mse);
+
+static inline q15_t VSS_GetMu(const vss_instance_t *S)
+{
+	return (q15_t)(S->mu >> VSS_FRAC_BITS);
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* VSS_H_ */